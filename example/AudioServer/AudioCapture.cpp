@@ -12,6 +12,7 @@
 
 #include "AudioCapture.h"
 #include "OpusEncoder.h"
+#include "ThreadRegistry.h"
 #include <opus/opus.h>
 #include <iostream>
 
@@ -52,12 +53,23 @@ AudioCapture::AudioCapture()
 /**
 * @details
 *   - PCM 디바이스로부터 지정된 프레임 수만큼 오디오 데이터를 읽음
+*   - 읽기 전에 모자란 프레임 수(snd_pcm_avail)로 데이터가 다 모이는 시각을 계산하고,
+*     snd_pcm_readi가 그 시각보다 늦게 돌아온 시간을 capture 역할의 스케줄링 지연으로 기록
+*     (이미 다 모여 있어 기다리지 않은 읽기는 기록하지 않음, 버퍼에 쌓인 양은 지연이 아님)
 *   - 오버런 발생 시 자동으로 복구 시도
 *   - 오류 발생 시 오류 메시지 출력
 */
 int AudioCapture::read(short *buffer, int frames)
 {
+    const snd_pcm_sframes_t avail = snd_pcm_avail(pcm_handle);
+    const bool waits = avail >= 0 && avail < frames;
+    const int64_t readyNs = ThreadRegistry::NowNs() + (waits ? (int64_t)(frames - avail) * 1000000000LL / sample_rate : 0);
     int rc = snd_pcm_readi(pcm_handle, buffer, frames);
+    if (rc > 0 && waits)
+    {
+        const int64_t lateNs = ThreadRegistry::NowNs() - readyNs;
+        ThreadRegistry::GetInstance().RecordLatency(eThreadRole_Capture, lateNs > 0 ? lateNs : 0);
+    }
     if (rc == -EPIPE)
     {
         std::cerr << "오버런 발생" << std::endl;
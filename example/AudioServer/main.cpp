@@ -21,7 +21,15 @@
 #include "H264Encoder.h"
 #include "DataCapture.h"
 #include "Global.h"
+#include "ThreadRegistry.h"
 
+#include <atomic>
+#include <vector>
+#include <csignal>
+#include <pthread.h>
+
+static std::atomic<bool> sourceRunning{false}; ///< 오디오 스트리밍 스레드 실행 여부
+static std::thread sourceThread;               ///< 오디오 스트리밍 스레드
 
 /**
  * @brief Opus 오디오 스트리밍을 처리하는 함수
@@ -36,18 +44,23 @@
  * - 무한 루프로 오디오 캡처 및 인코딩
  * - 인코딩된 프레임을 DataCapture에 푸시
  * 
- * @note 이 함수는 detached 스레드로 실행되어 백그라운드에서 동작합니다.
+ * @note 이 함수는 별도 스레드(capture 역할)로 실행되어 백그라운드에서 동작하며, 서버가 종료되면 StopOpus가 멈춥니다.
+ *       인코더 스레드가 캡처를 선점하여 오버런이 생기면 RTSP_THREAD_POLICY로 capture 역할을 전용 코어/실시간 우선순위에 둡니다.
+ *       DataCapture가 프레임을 복사하므로 인코딩 버퍼는 하나를 재사용합니다.
  */
 void LoadOpus()
 {
-    std::thread([]()->void {
+    sourceRunning = true;
+    sourceThread = std::thread([]()->void {
+                     ThreadRegistry::GetInstance().Enter(eThreadRole_Capture, "opus-capture");
                      short pcmBuffer[OPUS_FRAME_SIZE * OPUS_CHANNELS];
+                     std::vector<unsigned char> encodedBuffer(MAX_PACKET_SIZE);
                      OpusEncoder opusEncoder;
                      DataCaptureFrame newFrame;
                      newFrame.timestamp = (unsigned int)GetRanNum(16);
                      AudioCapture audioCapture;
-                     while(1){
-                        newFrame.dataPtr = new unsigned char[MAX_PACKET_SIZE];
+                     while(sourceRunning){
+                        newFrame.dataPtr = encodedBuffer.data();
                          
                         int rc = audioCapture.read(pcmBuffer, OPUS_FRAME_SIZE);
                         if (rc != OPUS_FRAME_SIZE)
@@ -62,14 +75,26 @@ void LoadOpus()
                         if (bufferSize <= 0)
                         {
                             std::cerr << "Opus encoding error: " << bufferSize << std::endl;
-                            delete[] newFrame.dataPtr;
                             continue;
                         }
 
                         AudioCapture::getInstance().pushFrame(newFrame);
                      }
+                     ThreadRegistry::GetInstance().Leave();
                      return ;
-                 } ).detach();
+                 } );
+}
+
+/**
+ * @brief 오디오 스트리밍 스레드를 멈추는 함수
+ * @details 서버 종료 이벤트에서 호출되며, 스레드가 끝날 때까지 기다립니다. (최대 오디오 프레임 하나)
+ */
+void StopOpus()
+{
+    sourceRunning = false;
+    if (sourceThread.joinable()) {
+        sourceThread.join();
+    }
 }
 
 /**
@@ -82,19 +107,27 @@ void LoadOpus()
  * 1. RTSP 서버 프로토콜을 Opus로 설정
  * 2. 초기화 이벤트 핸들러로 LoadOpus 함수 등록
  * 3. 서버 스레드 시작
- * 4. 무한 루프로 서버 유지
+ * 4. SIGINT/SIGTERM을 받을 때까지 대기한 뒤 서버 종료
  */
 int main(int argc, char *argv[])
 {
+    // 서버 스레드들이 신호를 가로채지 않도록 시작 전에 막고, 메인 스레드에서만 기다림
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
     RTSPServer::getInstance().setProtocol(Protocol::PROTO_OPUS);
     RTSPServer::getInstance().onInitEvent = LoadOpus;
-    RTSPServer::getInstance().startServerThread();
-
-    while (1)
-    {
-        sleep(1);
+    RTSPServer::getInstance().onStopEvent = StopOpus;
+    if (RTSPServer::getInstance().startServerThread() != 0) {
+        return 1;
     }
-    
-        
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    std::cout << "Signal (" << signal << ") received. Shutting down..." << std::endl;
+    RTSPServer::getInstance().stop();
     return 0;
 }
\ No newline at end of file
@@ -2,6 +2,10 @@
 #include <iostream>
 #include <thread>
 #include "DataCapture.h"
+#include "NTPClock.h"
+#include "ThreadRegistry.h"
+#include "RTSPServer.h"
+#include "H264Encoder.h"
 /// C언어로 FFmpeg Library를 사용
 extern "C"
 {
@@ -52,18 +56,31 @@ void FFmpegEncoder::initFFmpeg(const std::string& filename, double fps) {
     codec_ctx->max_b_frames = 1;
     codec_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
 
-    // Enable multi-threading
-    codec_ctx->thread_count = std::thread::hardware_concurrency();
+    // Enable multi-threading (encode 역할에 CPU를 배정했으면 그 수만큼만 워커 생성)
+    size_t encodeCPUs = ThreadRegistry::GetInstance().GetCPUCount(eThreadRole_Encode);
+    codec_ctx->thread_count = encodeCPUs > 0 ? encodeCPUs : std::thread::hardware_concurrency();
     codec_ctx->thread_type = FF_THREAD_FRAME;
 
     // Set encoder options
     av_opt_set(codec_ctx->priv_data, "preset", "ultrafast", 0);
     av_opt_set(codec_ctx->priv_data, "tune", "zerolatency", 0);
-
-    if (avcodec_open2(codec_ctx, codec, NULL) < 0) {
+    // pict_type을 I로 지정한 프레임을 IDR로 인코딩 (키프레임 요청 처리용)
+    av_opt_set(codec_ctx->priv_data, "forced-idr", "1", 0);
+
+    // 인코더 워커 스레드는 avcodec_open2에서 만들어지므로 encode 역할로 등록하여 CPU/우선순위 적용
+    int openResult = 0;
+    ThreadRegistry::GetInstance().Adopt(eThreadRole_Encode, [&]() {
+        openResult = avcodec_open2(codec_ctx, codec, NULL);
+    });
+    if (openResult < 0) {
         throw std::runtime_error("Could not open codec");
     }
 
+    // SDP(b=AS, sprop-parameter-sets)에 알릴 비트레이트와 SPS/PPS
+    // extradata가 없는 인코더는 첫 키프레임 패킷에서 SPS/PPS를 읽음 (encode 참고)
+    RTSPServer::getInstance().setBitrate(static_cast<int>(codec_ctx->bit_rate / 1000));
+    publishParameterSets(codec_ctx->extradata, codec_ctx->extradata_size);
+
     fmt_ctx = avformat_alloc_context();
     if (!fmt_ctx) {
         throw std::runtime_error("Could not allocate format context");
@@ -142,6 +159,8 @@ void FFmpegEncoder::encode(const cv::Mat& inputFrame, double fps) {
 
     frame_index++;
 
+    // 대기 중인 키프레임 요청이 있으면 이번 프레임을 IDR로 강제
+    frame->pict_type = forceKeyframe.exchange(false) ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
 
     // 프레임을 인코더로 보냄
     int ret = avcodec_send_frame(codec_ctx, frame);
@@ -172,11 +191,14 @@ void FFmpegEncoder::encode(const cv::Mat& inputFrame, double fps) {
             // PTS를 사용하여 초 단위로 변환
             double seconds = packet->pts * av_q2d(stream->time_base);
             std::cout << "Time in seconds: " << seconds << std::endl;
-            // 실시간 timestamp 추가
-            auto now = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch());
-            std::cout << "timestamp :" << duration.count()*100 << std::endl;
-            newframe.timestamp = duration.count()*100; // 밀리초 단위 timestamp
+            // 실시간 timestamp 추가 (RTCP SR과 같은 NTPClock 기준의 90kHz RTP 타임스탬프)
+            NTPClock& clock = NTPClock::getInstance();
+            newframe.timestamp = clock.ToRTPTime(clock.GetMonotonicNs(), 90000);
+            std::cout << "timestamp :" << newframe.timestamp << std::endl;
+            newframe.keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+            if (newframe.keyframe) {
+                publishParameterSets(packet->data, packet->size);
+            }
 
             DataCapture::getInstance().pushFrame(newframe);
         }
@@ -185,6 +207,25 @@ void FFmpegEncoder::encode(const cv::Mat& inputFrame, double fps) {
 
 }
 
+/**
+ * @brief Annex-B 데이터에서 SPS/PPS를 찾아 서버에 알립니다.
+ * @details 슬라이스 앞까지만 확인하며, 값이 같으면 서버가 SDP를 다시 만들지 않으므로 키프레임마다 호출해도 됩니다.
+ */
+void FFmpegEncoder::publishParameterSets(const uint8_t* data, int size) {
+    std::string sps, pps;
+    if (data != nullptr && H264Encoder::find_parameter_sets(data, size, sps, pps)) {
+        RTSPServer::getInstance().setH264ParameterSets(sps, pps);
+    }
+}
+
+/**
+ * @brief 다음 프레임을 IDR로 인코딩하도록 요청합니다.
+ * @details 플래그만 설정하므로 여러 클라이언트의 요청이 동시에 들어와도 IDR은 한 번만 생성됩니다.
+ */
+void FFmpegEncoder::requestKeyframe() {
+    forceKeyframe = true;
+}
+
 /**
  * @brief FFmpeg library의 카메라 메모리를 해제합니다.
  * @details FFmpeg에 연결된 카메라모듈을 반환합니다.
@@ -1,6 +1,7 @@
 #ifndef FFMPEG_ENCODER_H
 #define FFMPEG_ENCODER_H
 #include <opencv2/core.hpp>
+#include <atomic>
 class AVStream;
 
 /**
@@ -27,6 +28,11 @@ public:
      * @details 카메라 모듈에서 YUVformat의 프레임을 읽어와 DataCapture로 프레임을 처리합니다.
      */
     void encode(const cv::Mat& inputFrame, double fps);
+    /**
+     * @brief 다음 프레임을 IDR로 인코딩하도록 요청합니다.
+     * @details 여러 번 호출되어도 다음 encode() 호출에서 한 번만 IDR을 생성합니다.
+     */
+    void requestKeyframe();
 
 private:
     /**
@@ -39,6 +45,12 @@ private:
      * @details AVCodec을 설정하고 ffmpeg library를 이용해 라즈베리파이 카메라모듈과 연결합니다.
      */
     void releaseFFmpeg();
+    /**
+     * @brief Annex-B 데이터에서 SPS/PPS를 찾아 서버에 알립니다.
+     * @param data 인코더 extradata 또는 키프레임 패킷
+     * @param size 데이터 크기
+     */
+    void publishParameterSets(const uint8_t* data, int size);
 
     // FFmpeg 관련 변수 선언
     struct AVCodecContext *codec_ctx = nullptr;
@@ -46,6 +58,7 @@ private:
     struct AVPacket *packet = nullptr;
     struct AVFrame *frame = nullptr;
     int frame_index = 0;
+    std::atomic<bool> forceKeyframe{false}; ///< 다음 프레임을 IDR로 강제할지 여부
     AVStream *stream = nullptr;
 
     int width;
@@ -16,6 +16,7 @@
 #include "RequestHandler.h"
 #include "Global.h"
 #include "DataCapture.h"
+#include "ThreadRegistry.h"
 
 #include <string>
 #include <thread>
@@ -25,6 +26,8 @@
 #include <fstream>
 #include <iomanip>
 #include <memory>
+#include <atomic>
+#include <pthread.h>
 #include <sys/mman.h> // mmap, munmap
 #include <opencv2/opencv.hpp>
 #include "libcamera/libcamera.h"
@@ -42,13 +45,17 @@ using namespace libcamera;
 using namespace std;
 static std::shared_ptr<libcamera::Camera> camera;
 FFmpegEncoder ffmpegEncoder("output.h264",640, 480, 30.0);
+static std::atomic<bool> cameraRunning{false}; ///< 카메라 캡처 스레드 실행 여부
+static std::thread captureThread;              ///< 카메라 캡처 스레드
 
 /**
  * @brief 카메라 frame을 처리하는 함수
  * @details 카메라 모듈의 frameBuffer에 접근해 yuv로 된 이미지를 가져와 mat형태로 변환하여 처리
+ *          libcamera 스레드에서 호출되므로 처음 호출될 때 그 스레드를 capture 역할로 등록 (색 변환도 이 스레드에서 실행)
  */
 static void requestComplete(Request *request)
 {
+    ThreadRegistry::GetInstance().Enter(eThreadRole_Capture, "camera-complete");
 	if (request->status() == Request::RequestCancelled)
 		return;
 
@@ -129,12 +136,15 @@ static void requestComplete(Request *request)
  *          1. Raspberry Pi5 의 모듈 카메라에 연결
  *          2. 카메라 캡처시 동작할 함수(requestComplete) 설정
  *          3. Thread에서 캡처 처리
+ *          4. 서버가 종료되면 카메라를 멈추고 해제 (stopCameraThread)
  */
 void cameraThread()
 {
-    std::thread([]() -> int
+    cameraRunning = true;
+    captureThread = std::thread([]() -> int
                 {
         //camera thread
+        ThreadRegistry::GetInstance().Enter(eThreadRole_Capture, "camera");
         static std::shared_ptr<libcamera::Camera> camera;
         std::unique_ptr<CameraManager> cm = std::make_unique<CameraManager>();
         cm->start();
@@ -157,7 +167,7 @@ void cameraThread()
         config->validate();
         std::cout << "Validated viewfinder configuration is: " << streamConfig.toString() << std::endl;
         camera->configure(config.get());
-        FrameBufferAllocator *allocator = new FrameBufferAllocator(camera);
+        std::unique_ptr<FrameBufferAllocator> allocator = std::make_unique<FrameBufferAllocator>(camera);
 
         for (StreamConfiguration &cfg : *config) {
             int ret = allocator->allocate(cfg.stream());
@@ -193,15 +203,36 @@ void cameraThread()
 
         camera->requestCompleted.connect(requestComplete);
         camera->start();
-        while(1) {
+        while(cameraRunning) {
             for (std::unique_ptr<Request> &request : requests){
+                if (!cameraRunning) break;
                 camera->queueRequest(request.get());
                 usleep(30*1000);
             }
         }
 
-        return 0; })
-        .detach();
+        // 진행 중인 요청을 취소하고 버퍼/카메라 해제
+        camera->stop();
+        camera->requestCompleted.disconnect(requestComplete);
+        requests.clear();
+        allocator.reset();
+        camera->release();
+        camera.reset();
+        cm->stop();
+        ThreadRegistry::GetInstance().Leave();
+        return 0; });
+}
+
+/**
+ * @brief 카메라 캡처 스레드를 멈추는 함수
+ * @details 서버 종료 이벤트에서 호출되며, 카메라가 해제될 때까지 기다립니다.
+ */
+void stopCameraThread()
+{
+    cameraRunning = false;
+    if (captureThread.joinable()) {
+        captureThread.join();
+    }
 }
 
 /**
@@ -213,17 +244,30 @@ void cameraThread()
  * @details RTSP 서버를 초기화하고 시작하는 주요 단계:
  * 1. RTSP 서버 프로토콜을 H264로 설정
  * 2. 초기화 이벤트 핸들러로 cameraThread 함수 등록
- * 3. 서버 스레드 시작
- * 4. 무한 루프로 서버 유지
+ * 3. 키프레임 요청 이벤트 핸들러로 FFmpegEncoder의 IDR 요청 등록
+ * 4. 서버 스레드 시작
+ * 5. SIGINT/SIGTERM을 받을 때까지 대기한 뒤 서버 종료
  */
 int main(int argc, char *argv[])
 {
+    // 서버/카메라 스레드들이 신호를 가로채지 않도록 시작 전에 막고, 메인 스레드에서만 기다림
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
 
     RTSPServer::getInstance().setProtocol(Protocol::PROTO_H264);
     RTSPServer::getInstance().onInitEvent = cameraThread;
-    RTSPServer::getInstance().startServerThread();
-
-    while(1){
-        sleep(1);
+    RTSPServer::getInstance().onStopEvent = stopCameraThread;
+    RTSPServer::getInstance().onKeyframeEvent = []() { ffmpegEncoder.requestKeyframe(); };
+    if (RTSPServer::getInstance().startServerThread() != 0) {
+        return 1;
     }
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    std::cout << "Signal (" << signal << ") received. Shutting down..." << std::endl;
+    RTSPServer::getInstance().stop();
+    return 0;
 }
\ No newline at end of file
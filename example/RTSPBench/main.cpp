@@ -0,0 +1,1041 @@
+/**
+ * @file main.cpp
+ * @brief RTSP 서버 성능 측정 도구의 메인 파일
+ * @details 같은 프로세스에서 RTSP 서버를 시작하고 루프백으로 부하를 주어 측정 결과를 출력하는 도구.
+ *          측정 항목마다 모드가 하나씩 있으며, 옵션은 name=value 형식으로 받습니다.
+ *          - connections: 연결 수립 속도(connections/sec)와 유휴 연결 하나당 메모리
+ *          - iobackend: RTP 일괄 전송 백엔드(sendmmsg, io_uring)별 전송 속도와 패킷당 시간
+ *          - senders: 송신 워커 수(1~N)별 프레임 하나를 모든 세션에 보내는 시간과 패킷당 송신 CPU 시간
+ *          - requests: 제어 연결의 요청 처리 속도(requests/sec), 응답 지연, 요청당 이벤트 루프 CPU 시간
+ *          - clock: NTP/RTP 시계 함수의 호출당 시간과 연속 호출로 구분되는 최소 시간 단위
+ *          - reconnect: 많은 세션이 한꺼번에 다시 연결할 때 모든 세션이 PLAY 될 때까지의 시간
+ *          - parser: RTSP 요청 파서의 처리 속도(requests/sec)와 요청당 힙 할당 수 (변경 전 istringstream 방식과 비교)
+ *          - sessions: 세션 ID 난수 생성 속도와 세션 테이블 조회 시간
+ *
+ *          서버 로그(std::cout)는 측정에 섞이지 않도록 버리고, 결과는 printf로 출력합니다.
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+#include "RTSPServer.h"
+#include "Global.h"
+#include "IOBackend.h"
+#include "SenderPool.h"
+#include "DataCapture.h"
+#include "NTPClock.h"
+#include "RTSPRequest.h"
+#include "ClientSession.h"
+#include "SessionTable.h"
+
+#include <new>
+#include <map>
+#include <random>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <iostream>
+#include <algorithm>
+#include <unistd.h>
+#include <dirent.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+using BenchOptions = std::map<std::string, std::string>; ///< name=value 옵션
+
+static std::atomic<uint64_t> allocationCount{0}; ///< 프로세스 전체의 operator new 호출 수 (parser 모드에서 사용)
+
+/**
+ * @brief 힙 할당 수를 세는 전역 operator new
+ */
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* pointer = std::malloc(size != 0 ? size : 1);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+// 인라인되면 GCC가 new로 받은 포인터를 free에 넘긴다고 경고(-Wmismatched-new-delete)하므로 인라인하지 않음
+__attribute__((noinline)) void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+/**
+ * @brief 정수 옵션을 읽는 함수
+ * @param options 명령행 옵션
+ * @param name 옵션 이름
+ * @param fallback 옵션이 없을 때 사용할 값
+ * @return long 옵션 값
+ */
+static long GetOption(const BenchOptions& options, const char* name, long fallback)
+{
+    auto it = options.find(name);
+    return it != options.end() ? std::strtol(it->second.c_str(), nullptr, 10) : fallback;
+}
+
+/**
+ * @brief 단조 시계 기준 현재 시각을 나노초로 반환하는 함수
+ */
+static int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief 프로세스의 상주 메모리 크기를 반환하는 함수
+ * @return long VmRSS (KiB, 읽지 못하면 -1)
+ */
+static long ReadRSSKb()
+{
+    FILE* file = std::fopen("/proc/self/status", "r");
+    if (file == nullptr) {
+        return -1;
+    }
+    char line[256];
+    long rss = -1;
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        if (std::strncmp(line, "VmRSS:", 6) == 0) {
+            rss = std::strtol(line + 6, nullptr, 10);
+            break;
+        }
+    }
+    std::fclose(file);
+    return rss;
+}
+
+/**
+ * @brief 열 수 있는 파일 디스크립터 수를 최대한 늘리는 함수
+ * @param needed 필요한 디스크립터 수
+ * @return bool 필요한 수만큼 열 수 있는지 여부
+ */
+static bool RaiseFileLimit(rlim_t needed)
+{
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        return false;
+    }
+    if (limit.rlim_cur < needed) {
+        limit.rlim_cur = std::min(needed, limit.rlim_max);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return limit.rlim_cur >= needed;
+}
+
+/**
+ * @brief 정렬된 표본에서 백분위 값을 반환하는 함수
+ * @param sorted 오름차순으로 정렬된 표본
+ * @param percent 백분위 (0~100)
+ */
+static double Percentile(const std::vector<double>& sorted, double percent)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = (size_t)(percent / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+/**
+ * @brief 루프백의 서버 RTSP 포트에 블로킹 TCP 연결을 여는 함수
+ * @return int 소켓 디스크립터 (-1: 실패)
+ */
+static int ConnectServer()
+{
+    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sockfd < 0) {
+        return -1;
+    }
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(g_serverRtpPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sockfd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(sockfd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return sockfd;
+}
+
+/**
+ * @brief 요청을 보내고 응답 헤더 끝까지 받는 함수
+ * @param sockfd 연결된 소켓
+ * @param request 보낼 요청
+ * @param response [out] 받은 응답 (헤더까지)
+ * @return bool 성공 여부
+ */
+static bool Exchange(int sockfd, const std::string& request, std::string& response)
+{
+    if (send(sockfd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) {
+        return false;
+    }
+    response.clear();
+    char buffer[4096];
+    while (response.find("\r\n\r\n") == std::string::npos) {
+        ssize_t receivedBytes = recv(sockfd, buffer, sizeof(buffer), 0);
+        if (receivedBytes <= 0) {
+            return false;
+        }
+        response.append(buffer, receivedBytes);
+    }
+    return true;
+}
+
+/**
+ * @brief 연결 수립 속도와 유휴 연결 하나당 메모리를 측정하는 함수
+ * @param options connections=연결 수(1000), listeners=리스닝 소켓 수(0: 코어 수)
+ * @return int 종료 코드
+ * @details 연결마다 OPTIONS 요청 하나를 주고받아 서버가 연결을 등록한 것을 확인한 뒤 다음 연결을 엽니다.
+ *          모든 연결을 유휴 상태로 유지한 채 늘어난 상주 메모리를 연결 수로 나눕니다.
+ *          (클라이언트 소켓도 같은 프로세스에 있지만 사용자 공간 메모리는 거의 쓰지 않음, 커널 소켓 버퍼는 포함되지 않음)
+ */
+static int BenchConnections(const BenchOptions& options)
+{
+    const long count = GetOption(options, "connections", 1000);
+    if (!RaiseFileLimit((rlim_t)count * 2 + 64)) {
+        std::cerr << "RLIMIT_NOFILE is too small for " << count << " connections" << std::endl;
+        return 1;
+    }
+    RTSPServer& server = RTSPServer::getInstance();
+    server.setListenerCount((int)GetOption(options, "listeners", 0));
+    if (server.startServerThread() != 0) {
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const long rssBefore = ReadRSSKb();
+    std::vector<int> sockets;
+    std::vector<double> latencyUs;
+    sockets.reserve(count);
+    latencyUs.reserve(count);
+    std::string response;
+    const int64_t startNs = NowNs();
+    for (long i = 0; i < count; i++) {
+        const int64_t connectNs = NowNs();
+        int sockfd = ConnectServer();
+        if (sockfd < 0 || !Exchange(sockfd, "OPTIONS rtsp://127.0.0.1/ RTSP/1.0\r\nCSeq: 1\r\n\r\n", response)) {
+            std::cerr << "connection " << i << " failed" << std::endl;
+            if (sockfd >= 0) close(sockfd);
+            break;
+        }
+        latencyUs.push_back((NowNs() - connectNs) / 1000.0);
+        sockets.push_back(sockfd);
+    }
+    const double elapsedSec = (NowNs() - startNs) / 1e9;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const long rssAfter = ReadRSSKb();
+    std::sort(latencyUs.begin(), latencyUs.end());
+
+    std::printf("connections: %zu in %.3f s (%.0f connections/sec)\n", sockets.size(), elapsedSec, sockets.size() / elapsedSec);
+    std::printf("connect + OPTIONS latency: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                Percentile(latencyUs, 50), Percentile(latencyUs, 99), Percentile(latencyUs, 100));
+    if (!sockets.empty() && rssBefore >= 0 && rssAfter >= 0) {
+        std::printf("RSS: %ld KiB -> %ld KiB (%.2f KiB per idle connection)\n",
+                    rssBefore, rssAfter, (double)(rssAfter - rssBefore) / sockets.size());
+    }
+
+    for (int sockfd : sockets) {
+        close(sockfd);
+    }
+    server.stop();
+    return sockets.size() == (size_t)count ? 0 : 1;
+}
+
+/**
+ * @brief RTP 일괄 전송 백엔드별 전송 속도를 측정하는 함수
+ * @param options packets=전송할 패킷 수(1000000), size=패킷 크기(1200), batch=한 번에 보낼 패킷 수(64)
+ * @return int 종료 코드
+ * @details 루프백의 수신 소켓으로 같은 메시지 배열을 반복 전송합니다. 수신 버퍼가 차서 버려지는 패킷도
+ *          송신 쪽 비용은 같으므로 받지 않습니다. io_uring을 쓸 수 없는 커널에서는 sendmmsg 결과만 출력합니다.
+ */
+static int BenchIOBackend(const BenchOptions& options)
+{
+    const long packets = GetOption(options, "packets", 1000000);
+    const size_t size = (size_t)GetOption(options, "size", 1200);
+    const unsigned batch = (unsigned)std::max(1L, GetOption(options, "batch", 64));
+
+    int sink = socket(AF_INET, SOCK_DGRAM, 0);
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    if (sink < 0 || sender < 0 || bind(sink, (sockaddr*)&addr, sizeof(addr)) != 0
+        || getsockname(sink, (sockaddr*)&addr, &addrLen) != 0) {
+        std::cerr << "fail to open UDP sockets" << std::endl;
+        return 1;
+    }
+
+    std::vector<char> payload(size, 0);
+    std::vector<iovec> iov(batch);
+    std::vector<mmsghdr> msgs(batch);
+    for (unsigned i = 0; i < batch; i++) {
+        iov[i].iov_base = payload.data();
+        iov[i].iov_len = payload.size();
+        std::memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = &addr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(addr);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    IOBackend& backend = IOBackend::GetInstance();
+    const IOBackendType types[] = {eIOBackend_Socket, eIOBackend_IoUring};
+    for (IOBackendType requested : types) {
+        if (backend.Init(requested) != requested) {
+            std::printf("%-9s not available\n", requested == eIOBackend_IoUring ? "io_uring" : "sendmmsg");
+            continue;
+        }
+        long sent = 0;
+        long failed = 0;
+        const int64_t startNs = NowNs();
+        while (sent + failed < packets) {
+            int result = backend.SendMessages(sender, msgs.data(), batch, MSG_DONTWAIT);
+            if (result < (int)batch) {
+                failed += batch - std::max(result, 0);
+            }
+            sent += std::max(result, 0);
+        }
+        const double elapsedSec = (NowNs() - startNs) / 1e9;
+        std::printf("%-9s %ld packets in %.3f s (%.0f packets/sec, %.0f ns/packet, %ld failed)\n",
+                    requested == eIOBackend_IoUring ? "io_uring" : "sendmmsg",
+                    sent, elapsedSec, sent / elapsedSec, elapsedSec * 1e9 / std::max(sent, 1L), failed);
+    }
+
+    close(sender);
+    close(sink);
+    return 0;
+}
+
+/**
+ * @brief 응답에서 Session 헤더의 세션 ID를 꺼내는 함수
+ * @return std::string 세션 ID (없으면 빈 문자열)
+ */
+static std::string ParseSessionID(const std::string& response)
+{
+    const size_t begin = response.find("Session: ");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    const size_t end = response.find_first_of(";\r", begin + 9);
+    return response.substr(begin + 9, end - (begin + 9));
+}
+
+/**
+ * @brief 루프백에 UDP 수신 소켓을 여는 함수
+ * @param port 바인딩할 포트
+ * @param timeoutMs 수신 대기 시간 (0: 무한)
+ * @return int 소켓 디스크립터 (-1: 실패)
+ */
+static int OpenSink(int port, int timeoutMs)
+{
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd < 0) {
+        return -1;
+    }
+    int bufferSize = 8 * 1024 * 1024;
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    timeval timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(sockfd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(sockfd);
+        return -1;
+    }
+    return sockfd;
+}
+
+/**
+ * @brief 패킷을 count개 받을 때까지 기다리는 함수
+ * @return long 받은 패킷 수 (시간 안에 다 오지 않으면 count보다 작음)
+ */
+static long ReceivePackets(int sockfd, long count)
+{
+    char buffer[2048];
+    long received = 0;
+    while (received < count && recv(sockfd, buffer, sizeof(buffer), 0) > 0) {
+        received++;
+    }
+    return received;
+}
+
+/**
+ * @brief 송신 워커 수에 따른 세션 송신 속도를 측정하는 함수
+ * @param options sessions=세션 수(64), frames=측정 프레임 수(200), size=프레임 크기(4000),
+ *                workers=최대 워커 수(4), port=수신 RTP 포트(40000)
+ * @return int 종료 코드
+ * @details 워커 수를 1부터 늘려 가며 서버를 다시 시작하고, UDP 세션들을 모두 루프백의 수신 소켓 하나로 PLAY 합니다.
+ *          키프레임을 하나씩 넣고 모든 세션의 패킷이 도착할 때까지의 시간(fan-out)을 잽니다.
+ *          워커가 코어 수보다 많으면 늘어나지 않으므로 코어 수 이하에서 비교합니다.
+ */
+static int BenchSenders(const BenchOptions& options)
+{
+    const long sessions = GetOption(options, "sessions", 64);
+    const long frames = GetOption(options, "frames", 200);
+    const size_t size = (size_t)std::max(16L, GetOption(options, "size", 4000));
+    const long maxWorkers = GetOption(options, "workers", 4);
+    const int port = (int)GetOption(options, "port", 40000) & ~1;
+    if (!RaiseFileLimit((rlim_t)sessions + 64)) {
+        std::cerr << "RLIMIT_NOFILE is too small for " << sessions << " sessions" << std::endl;
+        return 1;
+    }
+
+    int sink = OpenSink(port, 1000);
+    int rtcpSink = OpenSink(port + 1, 1);
+    if (sink < 0 || rtcpSink < 0) {
+        std::cerr << "fail to bind UDP port " << port << "-" << port + 1 << std::endl;
+        return 1;
+    }
+
+    // 모든 세션이 바로 보낼 수 있도록 키프레임(IDR NAL)만 넣음
+    std::vector<unsigned char> payload(size, 0xaa);
+    payload[0] = 0; payload[1] = 0; payload[2] = 0; payload[3] = 1; payload[4] = 0x65;
+
+    RTSPServer& server = RTSPServer::getInstance();
+    const std::string transport = "Transport: RTP/AVP;unicast;client_port=" + std::to_string(port) + "-" + std::to_string(port + 1) + "\r\n";
+    std::printf("%ld sessions, %zu-byte keyframes, %u online CPUs\n", sessions, size, std::thread::hardware_concurrency());
+    int result = 0;
+    for (long workers = 1; workers <= maxWorkers; workers++) {
+        SenderPool::GetInstance().Start((size_t)workers);
+        if (server.startServerThread() != 0) {
+            return 1;
+        }
+        std::vector<int> sockets;
+        std::string response;
+        for (long i = 0; i < sessions; i++) {
+            int sockfd = ConnectServer();
+            std::string id;
+            if (sockfd >= 0 && Exchange(sockfd, "SETUP rtsp://127.0.0.1/trackID=0 RTSP/1.0\r\nCSeq: 1\r\n" + transport + "\r\n", response)) {
+                id = ParseSessionID(response);
+            }
+            if (id.empty() || !Exchange(sockfd, "PLAY rtsp://127.0.0.1/ RTSP/1.0\r\nCSeq: 2\r\nSession: " + id + "\r\n\r\n", response)
+                || response.compare(0, 15, "RTSP/1.0 200 OK") != 0) {
+                std::cerr << "session " << i << " failed" << std::endl;
+                if (sockfd >= 0) close(sockfd);
+                result = 1;
+                break;
+            }
+            sockets.push_back(sockfd);
+        }
+
+        // 첫 프레임으로 프레임당 패킷 수를 정하고 (세션마다 같음) 남은 패킷을 비움
+        DataCaptureFrame frame;
+        frame.dataPtr = payload.data();
+        frame.size = (unsigned int)payload.size();
+        frame.timestamp = 0;
+        frame.keyframe = true;
+        DataCapture::getInstance().pushFrame(frame);
+        const long packetsPerFrame = ReceivePackets(sink, LONG_MAX) / std::max(1L, (long)sockets.size());
+
+        const SenderPoolStats before = SenderPool::GetInstance().GetStats();
+        std::vector<double> fanoutUs;
+        long lost = 0;
+        const int64_t startNs = NowNs();
+        for (long i = 0; i < frames && packetsPerFrame > 0; i++) {
+            frame.timestamp += 3000;
+            const int64_t pushNs = NowNs();
+            DataCapture::getInstance().pushFrame(frame);
+            const long expected = packetsPerFrame * (long)sockets.size();
+            lost += expected - ReceivePackets(sink, expected);
+            fanoutUs.push_back((NowNs() - pushNs) / 1000.0);
+        }
+        const double elapsedSec = (NowNs() - startNs) / 1e9;
+        const SenderPoolStats after = SenderPool::GetInstance().GetStats();
+        const double packets = (double)fanoutUs.size() * packetsPerFrame * sockets.size();
+        std::sort(fanoutUs.begin(), fanoutUs.end());
+
+        std::printf("workers %ld: %.0f packets/sec, fan-out p50 %.1f us, p99 %.1f us, sender CPU %.0f ns/packet, %ld lost\n",
+                    workers, packets / elapsedSec, Percentile(fanoutUs, 50), Percentile(fanoutUs, 99),
+                    packets > 0 ? (after.cpuNs - before.cpuNs) / packets : 0.0, lost);
+
+        for (int sockfd : sockets) {
+            close(sockfd);
+        }
+        server.stop();
+        if (result != 0) {
+            break;
+        }
+    }
+    close(sink);
+    close(rtcpSink);
+    return result;
+}
+
+/**
+ * @brief 이름이 prefix로 시작하는 스레드들의 CPU 시간 합을 반환하는 함수
+ * @param prefix 스레드 이름 앞부분 (ThreadRegistry가 붙인 이름, 예: rtsp-loop)
+ * @return double CPU 시간 (초, /proc의 clock tick 단위 해상도)
+ */
+static double ReadThreadCPUSec(const char* prefix)
+{
+    DIR* dir = opendir("/proc/self/task");
+    if (dir == nullptr) {
+        return 0.0;
+    }
+    unsigned long long ticks = 0;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        const std::string path = std::string("/proc/self/task/") + entry->d_name;
+        char name[32] = {};
+        FILE* comm = std::fopen((path + "/comm").c_str(), "r");
+        if (comm == nullptr) {
+            continue;
+        }
+        const bool matched = std::fgets(name, sizeof(name), comm) != nullptr && std::strncmp(name, prefix, std::strlen(prefix)) == 0;
+        std::fclose(comm);
+        FILE* stat = matched ? std::fopen((path + "/stat").c_str(), "r") : nullptr;
+        if (stat == nullptr) {
+            continue;
+        }
+        char line[1024];
+        if (std::fgets(line, sizeof(line), stat) != nullptr) {
+            // comm에 공백이 있을 수 있으므로 마지막 ')' 뒤부터 셈: state(3) ... utime(14) stime(15)
+            const char* field = std::strrchr(line, ')');
+            unsigned long long utime = 0, stime = 0;
+            if (field != nullptr && std::sscanf(field + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime) == 2) {
+                ticks += utime + stime;
+            }
+        }
+        std::fclose(stat);
+    }
+    closedir(dir);
+    return (double)ticks / sysconf(_SC_CLK_TCK);
+}
+
+/**
+ * @brief 제어 연결의 요청 처리 속도를 측정하는 함수
+ * @param options requests=총 요청 수(100000), clients=동시 연결 수(1), listeners=리스닝 소켓 수(0: 코어 수),
+ *                method=OPTIONS|DESCRIBE
+ * @return int 종료 코드
+ * @details 연결마다 스레드 하나가 요청을 보내고 응답을 받을 때까지 기다리기를 반복합니다.
+ *          CPU 시간은 이벤트 루프 스레드(rtsp-loop)의 것만 세므로 같은 프로세스의 클라이언트 비용은 들어가지 않습니다.
+ */
+static int BenchRequests(const BenchOptions& options)
+{
+    const long requests = GetOption(options, "requests", 100000);
+    const long clients = std::max(1L, GetOption(options, "clients", 1));
+    auto methodOption = options.find("method");
+    const std::string method = methodOption != options.end() ? methodOption->second : "OPTIONS";
+    std::string request;
+    if (method == "OPTIONS") {
+        request = "OPTIONS rtsp://127.0.0.1/ RTSP/1.0\r\nCSeq: 1\r\n\r\n";
+    } else if (method == "DESCRIBE") {
+        request = "DESCRIBE rtsp://127.0.0.1/ RTSP/1.0\r\nCSeq: 1\r\nAccept: application/sdp\r\n\r\n";
+    } else {
+        std::cerr << "unsupported method " << method << std::endl;
+        return 1;
+    }
+
+    RTSPServer& server = RTSPServer::getInstance();
+    server.setListenerCount((int)GetOption(options, "listeners", 0));
+    if (server.startServerThread() != 0) {
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<int> sockets;
+    for (long i = 0; i < clients; i++) {
+        int sockfd = ConnectServer();
+        if (sockfd < 0) {
+            std::cerr << "connection " << i << " failed" << std::endl;
+            break;
+        }
+        sockets.push_back(sockfd);
+    }
+
+    std::vector<std::vector<double>> latencyUs(sockets.size());
+    std::vector<std::thread> threads;
+    std::atomic<long> failed{0};
+    const double cpuBefore = ReadThreadCPUSec("rtsp-loop");
+    const int64_t startNs = NowNs();
+    for (size_t i = 0; i < sockets.size(); i++) {
+        threads.emplace_back([&, i]() {
+            std::string response;
+            const long count = requests / (long)sockets.size();
+            latencyUs[i].reserve(count);
+            for (long n = 0; n < count; n++) {
+                const int64_t sendNs = NowNs();
+                if (!Exchange(sockets[i], request, response)) {
+                    failed++;
+                    break;
+                }
+                latencyUs[i].push_back((NowNs() - sendNs) / 1000.0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double elapsedSec = (NowNs() - startNs) / 1e9;
+    const double cpuSec = ReadThreadCPUSec("rtsp-loop") - cpuBefore;
+
+    std::vector<double> all;
+    for (auto& samples : latencyUs) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    std::printf("%s: %zu requests over %zu connections in %.3f s (%.0f requests/sec)\n",
+                method.c_str(), all.size(), sockets.size(), elapsedSec, all.size() / elapsedSec);
+    std::printf("latency: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                Percentile(all, 50), Percentile(all, 99), Percentile(all, 100));
+    if (!all.empty()) {
+        std::printf("event loop CPU: %.2f s (%.2f us/request)\n", cpuSec, cpuSec * 1e6 / all.size());
+    }
+
+    for (int sockfd : sockets) {
+        close(sockfd);
+    }
+    server.stop();
+    return failed == 0 && sockets.size() == (size_t)clients ? 0 : 1;
+}
+
+/**
+ * @brief 많은 세션이 한꺼번에 다시 연결할 때 모든 세션이 재생될 때까지의 시간을 측정하는 함수
+ * @param options sessions=세션 수(500), clients=동시에 연결하는 클라이언트 스레드 수(16),
+ *                listeners=리스닝 소켓 수(0: 코어 수), backlog=listen 대기열 크기(0: SOMAXCONN)
+ * @return int 종료 코드
+ * @details 장애 뒤 VMS가 스트림을 한꺼번에 다시 여는 상황을 흉내 냅니다. 클라이언트 스레드들이 동시에 출발하여
+ *          세션마다 연결, SETUP(RTP/AVP/TCP), PLAY를 차례로 보내고, 출발부터 PLAY 응답까지의 시간을 잽니다.
+ *          연결이 거부되거나 200이 아닌 응답을 받은 세션은 실패로 셉니다. 모든 연결은 측정이 끝날 때까지 유지합니다.
+ */
+static int BenchReconnect(const BenchOptions& options)
+{
+    const long sessions = std::max(1L, GetOption(options, "sessions", 500));
+    const long clients = std::min(sessions, std::max(1L, GetOption(options, "clients", 16)));
+    if (!RaiseFileLimit((rlim_t)sessions * 2 + 64)) {
+        std::cerr << "RLIMIT_NOFILE is too small for " << sessions << " sessions" << std::endl;
+        return 1;
+    }
+    RTSPServer& server = RTSPServer::getInstance();
+    server.setListenerCount((int)GetOption(options, "listeners", 0));
+    server.setListenBacklog((int)GetOption(options, "backlog", 0));
+    if (server.startServerThread() != 0) {
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<std::vector<int>> sockets(clients);
+    std::vector<std::vector<double>> playMs(clients);
+    std::atomic<long> refused{0};
+    std::atomic<long> failed{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    int64_t startNs = 0;
+    for (long i = 0; i < clients; i++) {
+        threads.emplace_back([&, i]() {
+            while (!go) {
+                std::this_thread::yield();
+            }
+            std::string response;
+            for (long n = i; n < sessions; n += clients) {
+                int sockfd = ConnectServer();
+                if (sockfd < 0) {
+                    refused++;
+                    continue;
+                }
+                sockets[i].push_back(sockfd);
+                if (!Exchange(sockfd, "SETUP rtsp://127.0.0.1/ RTSP/1.0\r\nCSeq: 1\r\n"
+                                      "Transport: RTP/AVP/TCP;unicast;interleaved=0-1\r\n\r\n", response)
+                    || response.compare(0, 15, "RTSP/1.0 200 OK") != 0) {
+                    failed++;
+                    continue;
+                }
+                const std::string play = "PLAY rtsp://127.0.0.1/ RTSP/1.0\r\nCSeq: 2\r\nSession: "
+                                       + ParseSessionID(response) + "\r\n\r\n";
+                if (!Exchange(sockfd, play, response) || response.compare(0, 15, "RTSP/1.0 200 OK") != 0) {
+                    failed++;
+                    continue;
+                }
+                playMs[i].push_back((NowNs() - startNs) / 1e6);
+            }
+        });
+    }
+    startNs = NowNs();
+    go = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double elapsedSec = (NowNs() - startNs) / 1e9;
+
+    std::vector<double> all;
+    for (auto& samples : playMs) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    std::printf("reconnect: %zu/%ld sessions PLAYing in %.3f s over %ld clients (%.0f sessions/sec)\n",
+                all.size(), sessions, elapsedSec, clients, all.size() / elapsedSec);
+    std::printf("time to PLAY: p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+                Percentile(all, 50), Percentile(all, 99), Percentile(all, 100));
+    std::printf("refused connections: %ld, failed SETUP/PLAY: %ld\n", (long)refused, (long)failed);
+
+    for (auto& clientSockets : sockets) {
+        for (int sockfd : clientSockets) {
+            close(sockfd);
+        }
+    }
+    server.stop();
+    return all.size() == (size_t)sessions ? 0 : 1;
+}
+
+static volatile uint64_t measureSink; ///< MeasureNsPerCall이 반환값 합을 써 두는 곳
+
+/**
+ * @brief 함수를 반복 호출하여 호출 한 번의 평균 시간을 반환하는 함수
+ * @param calls 호출 횟수
+ * @param function 측정할 함수 (반환값을 누적하여 최적화로 호출이 사라지지 않게 함)
+ * @return double 호출 한 번의 평균 시간 (ns)
+ */
+template <typename Function>
+static double MeasureNsPerCall(long calls, Function function)
+{
+    uint64_t sum = 0;
+    const int64_t startNs = NowNs();
+    for (long i = 0; i < calls; i++) {
+        sum += function();
+    }
+    const int64_t elapsedNs = NowNs() - startNs;
+    measureSink = sum;
+    return calls > 0 ? (double)elapsedNs / calls : 0.0;
+}
+
+/**
+ * @brief 변경 전 GetTime()과 같은 방법으로 NTP 타임스탬프를 만드는 함수 (비교 기준)
+ * @return uint64_t 밀리초 단위 system_clock으로 만든 NTP 타임스탬프 (소수부는 근사값)
+ */
+static uint64_t LegacyNTPTime()
+{
+    auto now = std::chrono::system_clock::now();
+    auto msSinceEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    uint32_t ntpSeconds = (msSinceEpoch / 1000) + 2208988800U;
+    uint32_t ntpFraction = (msSinceEpoch % 1000) * 4294967;
+    return ((uint64_t)ntpSeconds << 32) | ntpFraction;
+}
+
+/**
+ * @brief NTP 타임스탬프를 연속으로 읽어 구분되는 최소 시간 단위를 반환하는 함수
+ * @param calls 호출 횟수
+ * @param function NTP 타임스탬프(32.32)를 반환하는 함수
+ * @return double 연속한 두 값의 0이 아닌 차이 중 최솟값 (us, 값이 한 번도 바뀌지 않으면 0)
+ */
+template <typename Function>
+static double MeasureNTPStepUs(long calls, Function function)
+{
+    uint64_t previous = function();
+    uint64_t minStep = 0;
+    for (long i = 0; i < calls; i++) {
+        const uint64_t current = function();
+        if (current > previous && (minStep == 0 || current - previous < minStep)) {
+            minStep = current - previous;
+        }
+        previous = current;
+    }
+    return minStep * 1e6 / 4294967296.0;
+}
+
+/**
+ * @brief NTP/RTP 시계 함수의 호출당 시간을 측정하는 함수
+ * @param options calls=함수마다 호출 수(10000000)
+ * @return int 종료 코드
+ * @details RTCP SR과 RTP 타임스탬프를 만들 때 부르는 NTPClock 함수를 변경 전 GetTime() 방식(밀리초 system_clock)과
+ *          비교합니다. 서버는 시작하지 않으며, 최소 시간 단위는 같은 함수를 연속으로 불러 바뀐 값의 최소 차이입니다.
+ */
+static int BenchClock(const BenchOptions& options)
+{
+    const long calls = std::max(1L, GetOption(options, "calls", 10000000));
+    NTPClock& clock = NTPClock::getInstance();
+
+    struct ClockCase {
+        const char* name;
+        double nsPerCall;
+        double stepUs;
+    };
+    const ClockCase cases[] = {
+        {"clock_gettime(CLOCK_MONOTONIC)",
+         MeasureNsPerCall(calls, []() { return NTPClock::GetMonotonicNs(); }), 0.0},
+        {"NTPClock::GetNTPTime",
+         MeasureNsPerCall(calls, [&]() { return clock.GetNTPTime(); }),
+         MeasureNTPStepUs(calls, [&]() { return clock.GetNTPTime(); })},
+        {"NTPClock::ToRTPTime(90 kHz)",
+         MeasureNsPerCall(calls, [&]() { return (uint64_t)clock.ToRTPTime(NTPClock::GetMonotonicNs(), 90000); }), 0.0},
+        {"GetTime",
+         MeasureNsPerCall(calls, []() { return GetTime(); }),
+         MeasureNTPStepUs(calls, []() { return GetTime(); })},
+        {"legacy GetTime (system_clock ms)",
+         MeasureNsPerCall(calls, []() { return LegacyNTPTime(); }),
+         MeasureNTPStepUs(calls, []() { return LegacyNTPTime(); })},
+    };
+
+    std::printf("%ld calls per function\n", calls);
+    for (const ClockCase& clockCase : cases) {
+        std::printf("%-34s %7.1f ns/call", clockCase.name, clockCase.nsPerCall);
+        if (clockCase.stepUs > 0.0) {
+            std::printf(", step %.3f us", clockCase.stepUs);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+/**
+ * @brief 변경 전 RequestHandler와 같은 방법으로 요청을 파싱하는 함수 (비교 기준)
+ * @param request RTSP 요청 하나
+ * @return uint64_t 파싱한 값들의 합 (최적화로 파싱이 사라지지 않게 함)
+ * @details 메서드와 CSeq를 읽고, SETUP이면 Transport의 interleaved/multicast/client_port/RTCP-mux를,
+ *          DESCRIBE이면 Accept를 각각 istringstream으로 요청 전체를 다시 훑어 찾습니다.
+ */
+static uint64_t LegacyParse(const std::string& request)
+{
+    uint64_t result = 0;
+    std::string method;
+    {
+        std::istringstream requestStream(request);
+        requestStream >> method;
+    }
+    {
+        std::istringstream requestStream(request);
+        std::string line;
+        while (std::getline(requestStream, line)) {
+            if (line.find("CSeq") != std::string::npos) {
+                std::istringstream lineStream(line);
+                std::string label;
+                int cseq = -1;
+                lineStream >> label >> cseq;
+                result += cseq;
+                break;
+            }
+        }
+    }
+    if (method == "SETUP") {
+        // ParseInterleaved, ParseMulticast, ParsePorts, ParseRTCPMux는 각각 요청 전체를 다시 읽음
+        for (const char* parameter : {"interleaved=", ";multicast", "client_port=", "rtcp-mux"}) {
+            std::istringstream requestStream(request);
+            std::string line;
+            while (std::getline(requestStream, line)) {
+                if (line.find("Transport") == std::string::npos) {
+                    continue;
+                }
+                std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+                const size_t position = line.find(parameter);
+                if (position != std::string::npos) {
+                    result += std::strtol(line.c_str() + position + std::strlen(parameter), nullptr, 10) + 1;
+                }
+                break;
+            }
+        }
+    } else if (method == "DESCRIBE") {
+        std::istringstream requestStream(request);
+        std::string line;
+        while (std::getline(requestStream, line)) {
+            if (line.find("application/sdp") != std::string::npos) {
+                result++;
+                break;
+            }
+        }
+    }
+    return result + method.size();
+}
+
+/**
+ * @brief RTSP 요청 파서의 처리 속도와 요청당 힙 할당 수를 측정하는 함수
+ * @param options requests=요청 수(1000000)
+ * @return int 종료 코드
+ * @details 이벤트 루프가 요청마다 하는 것처럼 FindMessageLength로 요청 끝을 찾고 새 RTSPRequest로 Parse 합니다.
+ *          OPTIONS, DESCRIBE, SETUP, PLAY, GET_PARAMETER 요청을 번갈아 파싱하며, 변경 전 방식(LegacyParse)과 비교합니다.
+ *          서버는 시작하지 않습니다.
+ */
+static int BenchParser(const BenchOptions& options)
+{
+    const long requests = std::max(1L, GetOption(options, "requests", 1000000));
+    const std::string samples[] = {
+        "OPTIONS rtsp://192.168.0.10:8554/ RTSP/1.0\r\nCSeq: 1\r\nUser-Agent: LibVLC/3.0.18\r\n\r\n",
+        "DESCRIBE rtsp://192.168.0.10:8554/ RTSP/1.0\r\nCSeq: 2\r\nUser-Agent: LibVLC/3.0.18\r\n"
+        "Accept: application/sdp\r\n\r\n",
+        "SETUP rtsp://192.168.0.10:8554/trackID=0 RTSP/1.0\r\nCSeq: 3\r\nUser-Agent: LibVLC/3.0.18\r\n"
+        "Transport: RTP/AVP;unicast;client_port=50000-50001;RTCP-mux\r\n\r\n",
+        "PLAY rtsp://192.168.0.10:8554/ RTSP/1.0\r\nCSeq: 4\r\nUser-Agent: LibVLC/3.0.18\r\n"
+        "Session: 8F3A29C01B7D4E65\r\nRange: npt=12.5-\r\nScale: 2.0\r\n\r\n",
+        "GET_PARAMETER rtsp://192.168.0.10:8554/ RTSP/1.0\r\nCSeq: 5\r\nUser-Agent: LibVLC/3.0.18\r\n"
+        "Session: 8F3A29C01B7D4E65\r\n\r\n",
+    };
+    const size_t sampleCount = sizeof(samples) / sizeof(samples[0]);
+    for (const std::string& sample : samples) {
+        RTSPRequest request;
+        if (RTSPRequest::FindMessageLength(sample, sample.size()) != (long)sample.size() || !request.Parse(sample)) {
+            std::cerr << "sample request does not parse: " << sample.substr(0, sample.find('\r')) << std::endl;
+            return 1;
+        }
+    }
+
+    size_t index = 0;
+    uint64_t allocationsBefore = allocationCount;
+    const double parserNs = MeasureNsPerCall(requests, [&]() {
+        const std::string& sample = samples[index++ % sampleCount];
+        const long length = RTSPRequest::FindMessageLength(sample, sample.size());
+        RTSPRequest request;
+        request.Parse(std::string_view(sample).substr(0, length));
+        return (uint64_t)request.GetCSeq() + request.GetTransport().clientRTPPort + request.GetHeaderCount();
+    });
+    const double parserAllocations = (double)(allocationCount - allocationsBefore) / requests;
+
+    index = 0;
+    allocationsBefore = allocationCount;
+    const double legacyNs = MeasureNsPerCall(requests, [&]() {
+        return LegacyParse(samples[index++ % sampleCount]);
+    });
+    const double legacyAllocations = (double)(allocationCount - allocationsBefore) / requests;
+
+    std::printf("%ld requests (OPTIONS, DESCRIBE, SETUP, PLAY, GET_PARAMETER in turn)\n", requests);
+    std::printf("%-22s %8.0f requests/sec, %6.1f ns/request, %.2f allocations/request\n",
+                "RTSPRequest::Parse", 1e9 / parserNs, parserNs, parserAllocations);
+    std::printf("%-22s %8.0f requests/sec, %6.1f ns/request, %.2f allocations/request\n",
+                "legacy istringstream", 1e9 / legacyNs, legacyNs, legacyAllocations);
+    return 0;
+}
+
+/**
+ * @brief 세션 ID 난수 생성 속도와 세션 테이블 조회 시간을 측정하는 함수
+ * @param options sessions=테이블에 등록할 세션 수(10000), calls=함수마다 호출 수(1000000)
+ * @return int 종료 코드
+ * @details GetRandom64/GetRanNum을 변경 전 방식(호출마다 random_device와 mt19937 생성)과 비교하고,
+ *          세션 테이블에 세션을 등록한 뒤 등록된 ID(hit)와 없는 ID(miss)의 Find 시간을 잽니다.
+ *          서버는 시작하지 않으며, 세션은 연결 없이(소켓 -1) 만듭니다.
+ */
+static int BenchSessions(const BenchOptions& options)
+{
+    const long sessionCount = std::max(1L, GetOption(options, "sessions", 10000));
+    const long calls = std::max(1L, GetOption(options, "calls", 1000000));
+    const long legacyCalls = std::max(1L, calls / 100);
+
+    const double randomNs = MeasureNsPerCall(calls, []() { return GetRandom64(); });
+    const double ranNumNs = MeasureNsPerCall(calls, []() { return (uint64_t)GetRanNum(32); });
+    const double legacyNs = MeasureNsPerCall(legacyCalls, []() {
+        std::random_device device;
+        std::mt19937 generator(device());
+        std::uniform_int_distribution<uint32_t> distribution(1, 65535);
+        return (uint64_t)distribution(generator);
+    });
+
+    SessionTable& table = SessionTable::GetInstance();
+    std::vector<std::shared_ptr<ClientSession>> sessions;
+    std::vector<uint64_t> ids;
+    sessions.reserve(sessionCount);
+    ids.reserve(sessionCount);
+    for (long i = 0; i < sessionCount; i++) {
+        auto session = std::make_shared<ClientSession>(-1, "127.0.0.1");
+        while (!table.Add(session)) {
+            session->RegenerateID();
+        }
+        ids.push_back(session->GetID());
+        sessions.push_back(session);
+    }
+    // 조회 순서가 등록 순서를 따라가지 않도록 섞음
+    std::shuffle(ids.begin(), ids.end(), std::mt19937_64(GetRandom64()));
+    size_t index = 0;
+    const double hitNs = MeasureNsPerCall(calls, [&]() {
+        return (uint64_t)(table.Find(ids[index++ % ids.size()]) != nullptr);
+    });
+    const double missNs = MeasureNsPerCall(calls, [&]() {
+        return (uint64_t)(table.Find(GetRandom64()) != nullptr);
+    }) - randomNs;
+
+    std::printf("%-42s %8.1f ns/call (%.1f M ids/sec)\n", "GetRandom64", randomNs, 1e3 / randomNs);
+    std::printf("%-42s %8.1f ns/call\n", "GetRanNum(32)", ranNumNs);
+    std::printf("%-42s %8.1f ns/call (%ld calls)\n", "legacy GetRanNum (random_device+mt19937)", legacyNs, legacyCalls);
+    std::printf("SessionTable::Find with %zu sessions: hit %.1f ns, miss %.1f ns (excluding GetRandom64)\n",
+                table.GetCount(), hitNs, missNs);
+
+    for (const auto& session : sessions) {
+        table.Remove(session->GetID());
+    }
+    return 0;
+}
+
+/**
+ * @struct BenchMode
+ * @brief 측정 모드 (이름, 사용법, 실행 함수)
+ */
+struct BenchMode {
+    const char* name;                      ///< 명령행에서 고르는 모드 이름
+    const char* usage;                     ///< 옵션 설명
+    int (*run)(const BenchOptions& options); ///< 실행 함수
+};
+
+static const BenchMode benchModes[] = {
+    {"connections", "connections=1000 listeners=0", BenchConnections},
+    {"iobackend", "packets=1000000 size=1200 batch=64", BenchIOBackend},
+    {"senders", "sessions=64 frames=200 size=4000 workers=4 port=40000", BenchSenders},
+    {"requests", "requests=100000 clients=1 listeners=0 method=OPTIONS|DESCRIBE", BenchRequests},
+    {"clock", "calls=10000000", BenchClock},
+    {"reconnect", "sessions=500 clients=16 listeners=0 backlog=0", BenchReconnect},
+    {"parser", "requests=1000000", BenchParser},
+    {"sessions", "sessions=10000 calls=1000000", BenchSessions},
+};
+
+/**
+ * @brief 메인 함수
+ * @param argc 명령행 인자 개수
+ * @param argv 명령행 인자 배열 (모드 이름, name=value 옵션들)
+ * @return int 프로그램 종료 코드 (0: 정상 종료)
+ */
+int main(int argc, char *argv[])
+{
+    const BenchMode* mode = nullptr;
+    for (const BenchMode& candidate : benchModes) {
+        if (argc > 1 && std::strcmp(argv[1], candidate.name) == 0) {
+            mode = &candidate;
+        }
+    }
+    if (mode == nullptr) {
+        std::fprintf(stderr, "usage: %s <mode> [name=value ...]\n", argv[0]);
+        for (const BenchMode& candidate : benchModes) {
+            std::fprintf(stderr, "  %-12s %s\n", candidate.name, candidate.usage);
+        }
+        return 1;
+    }
+
+    BenchOptions options;
+    for (int i = 2; i < argc; i++) {
+        const char* equal = std::strchr(argv[i], '=');
+        if (equal != nullptr) {
+            options[std::string(argv[i], equal - argv[i])] = equal + 1;
+        }
+    }
+
+    // 서버 로그가 측정 결과와 측정 시간에 섞이지 않도록 버림
+    std::cout.rdbuf(nullptr);
+    RTSPServer::getInstance().setProtocol(Protocol::PROTO_H264);
+    return mode->run(options);
+}
@@ -14,53 +14,248 @@
 #include <iostream>
 
 #include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <csignal>
+#include <pthread.h>
 #include "H264Encoder.h"
 #include "DataCapture.h"
+#include "ThreadRegistry.h"
+
+static std::atomic<bool> keyframeRequested{false}; ///< 다음 IDR로 건너뛰어야 하는지 여부
+static std::atomic<bool> sourceRunning{false};     ///< 파일 읽기 스레드 실행 여부
+static std::thread sourceThread;                   ///< 파일 읽기 스레드
+static const char* const h264FilePath = "../dragon.h264"; ///< 재생할 H.264 파일
+static constexpr int sourceFps = 30;                       ///< 재생 프레임 속도
+static constexpr uint32_t rtpTicksPerFrame = 90000 / sourceFps; ///< 픽처 하나의 RTP 타임스탬프 증가량 (90kHz)
+static constexpr double minScale = 0.25;      ///< 지원하는 최소 재생 배율 (절댓값)
+static constexpr double maxScale = 16.0;      ///< 지원하는 최대 재생 배율 (절댓값)
+static constexpr double trickPlayScale = 2.0; ///< 이 배율을 넘거나 역방향이면 IDR 액세스 유닛만 전송
+static constexpr double minSpeed = 0.25;      ///< 지원하는 최소 전송 속도 배율
+static constexpr double maxSpeed = 4.0;       ///< 지원하는 최대 전송 속도 배율
+
+static std::mutex sourceMutex;                 ///< 파일 위치, 타임스탬프, 배율 보호 (읽기 스레드와 PLAY의 Range/Scale/Speed)
+static std::unique_ptr<H264Encoder> sourceFile; ///< 재생 중인 파일
+static uint32_t sourceTimestamp = 0;           ///< 마지막으로 읽은 NAL 유닛의 RTP 타임스탬프
+static int64_t sourceAccessUnit = -1;          ///< 마지막으로 읽은 NAL 유닛의 액세스 유닛 번호 (-1: 다음 NAL이 새 픽처)
+static double sourceScale = 1.0;               ///< 재생 배율 (Scale, 음수: 역방향)
+static double sourceSpeed = 1.0;               ///< 전송 속도 배율 (Speed)
+static double sourceByteRate = 0.0;            ///< 파일의 평균 바이트 속도 (bytes/s, IDR만 보낼 때 대역폭 상한)
+
+/**
+ * @brief IDR만 보내는 재생(trick play)에서 다음에 보낼 IDR 액세스 유닛을 고르는 함수
+ * @param from 방금 보낸 IDR 액세스 유닛 번호
+ * @param presentationTicks [out] 이전 픽처부터 이 픽처까지의 표시 간격 (90kHz RTP 단위)
+ * @return int64_t 다음 IDR 액세스 유닛 번호 (-1: 파일 끝 또는 처음)
+ * @details 표시 간격은 내용상 간격 / 배율이며, IDR 크기를 평균 바이트 속도로 보내는 시간보다 짧으면
+ *          그 IDR을 건너뛰고 다음 IDR을 고르므로 배율과 관계없이 대역폭이 1배 근처로 유지됩니다. (sourceMutex 아래에서 호출)
+ */
+static int64_t NextTrickPlayUnit(int64_t from, double& presentationTicks)
+{
+    const int direction = sourceScale > 0 ? 1 : -1;
+    int64_t unit = sourceFile->find_random_access_unit(from, direction);
+    while (unit >= 0) {
+        const double contentTicks = std::abs(unit - from) * static_cast<double>(rtpTicksPerFrame) / std::abs(sourceScale);
+        const double budgetTicks = sourceByteRate > 0 ? sourceFile->get_access_unit_size(unit) * 90000.0 / sourceByteRate : 0.0;
+        presentationTicks = std::max(contentTicks, budgetTicks);
+        const int64_t next = sourceFile->find_random_access_unit(unit, direction);
+        if (contentTicks >= budgetTicks || next < 0) {
+            break;
+        }
+        unit = next;
+    }
+    return unit;
+}
 
 /**
  * @brief Video frame을 처리하는 함수
- * @details H.264 format의 비디오 파일에서 frame을 일겅와 DataCapture에 추가합니다.
+ * @details H.264 format의 비디오 파일에서 NAL 유닛을 읽어 DataCapture에 추가합니다.
+ *          같은 액세스 유닛(픽처)의 NAL 유닛은 같은 타임스탬프를 가지며, 새 픽처마다 표시 간격 / Speed만큼 기다립니다.
+ *          - 배율이 trickPlayScale 이하이면 모든 픽처를 보내고, 표시 간격은 프레임 간격 / Scale
+ *          - 배율이 더 크거나 역방향이면 IDR 액세스 유닛만 보내고, 타임스탬프는 표시 간격으로 다시 매김 (NextTrickPlayUnit)
+ *          키프레임 요청이 있으면 다음 IDR(SPS)로 건너뛴 뒤 계속 읽습니다.
+ *          파일은 모든 시청자가 공유하므로 새 시청자나 PLI/FIR 때문에 다른 시청자가 되감기지 않도록 앞으로만 이동합니다.
+ *          파일 끝(역방향이면 처음)에 도달하면 Range 이동이나 서버 종료를 기다립니다.
+ *          capture 역할로 등록되며, 늦게 깨어난 시간을 스케줄링 지연으로 기록합니다.
+ *          서버가 종료되면 StopH264File이 스레드를 멈추고 기다립니다.
  */
 void LoadH264File()
 {
-    std::thread([]() -> void
+    {
+        std::lock_guard<std::mutex> lock(sourceMutex);
+        sourceFile = std::make_unique<H264Encoder>(h264FilePath);
+        sourceAccessUnit = -1;
+        sourceScale = sourceSpeed = 1.0;
+        sourceByteRate = sourceFile->estimate_bitrate(sourceFps) / 8.0;
+    }
+    sourceRunning = true;
+    sourceThread = std::thread([]() -> void
                 {
                 std::cout << "thread start"<<std::endl;
-            constexpr int64_t target_frame_duration_us = 1000000 / 30; // 30 fps -> 33,333 microseconds per frame
-            H264Encoder* h264_file = new H264Encoder("../dragon.h264");
+            ThreadRegistry::GetInstance().Enter(eThreadRole_Capture, "h264-source");
+            constexpr int64_t target_frame_duration_us = 1000000 / sourceFps; // 30 fps -> 33,333 microseconds per frame
+            auto next_picture_time = std::chrono::steady_clock::now();
 
-            DataCaptureFrame frame;
-            while (true) {
-                auto frame_start_time = std::chrono::high_resolution_clock::now();
+            DataCaptureFrame frame{};
+            uint8_t prevNaluType = 0;
+            while (sourceRunning) {
+                std::unique_lock<std::mutex> lock(sourceMutex);
+                if (keyframeRequested.exchange(false) && sourceFile->seek_to_keyframe()) {
+                    sourceAccessUnit = -1;
+                }
+
+                // 새 픽처의 표시 간격 (이동 직후의 첫 픽처는 RTP-Info로 알린 대로 정확히 한 프레임 간격)
+                int64_t accessUnit = sourceFile->get_access_unit();
+                double presentationTicks = rtpTicksPerFrame;
+                if (sourceAccessUnit >= 0 && accessUnit != sourceAccessUnit) {
+                    if (sourceScale < 0 || sourceScale > trickPlayScale) {
+                        accessUnit = NextTrickPlayUnit(sourceAccessUnit, presentationTicks);
+                        sourceFile->seek_to_access_unit(accessUnit);
+                    } else {
+                        presentationTicks /= sourceScale;
+                    }
+                }
 
                 // Get the next frame
-                std::pair<const uint8_t *, int64_t> cur_frame = h264_file->get_next_frame();
+                std::pair<const uint8_t *, int64_t> cur_frame = (accessUnit >= 0) ? sourceFile->get_next_frame() : std::pair<const uint8_t *, int64_t>{nullptr, 0};
                 const uint8_t * framePtr = cur_frame.first;
                 int64_t frameSize = cur_frame.second;
                 if (framePtr == nullptr) {
-                    return;
+                    // 파일 끝: Range 이동을 기다림
+                    lock.unlock();
+                    std::this_thread::sleep_for(std::chrono::microseconds(target_frame_duration_us));
+                    next_picture_time = std::chrono::steady_clock::now();
+                    continue;
+                }
+                const bool newPicture = (accessUnit != sourceAccessUnit);
+                if (newPicture) {
+                    sourceAccessUnit = accessUnit;
+                    sourceTimestamp += static_cast<uint32_t>(std::llround(presentationTicks));
                 }
+                frame.timestamp = sourceTimestamp;
+                const auto delay = std::chrono::microseconds(std::llround(presentationTicks * 1000000 / 90000 / sourceSpeed));
+                lock.unlock();
 
                 // split nalu start code 3 or 4 byte
                 const int64_t naluStartLen = H264Encoder::is_start_code(framePtr, frameSize, 4) ? 4 : 3;
+                const uint8_t naluType = H264Encoder::get_nalu_type(framePtr, frameSize);
 
                 frame.dataPtr = (unsigned char *)framePtr + naluStartLen;
                 frame.size = frameSize - naluStartLen;
-                frame.timestamp += 3000;
+                // SPS, 또는 SPS/PPS 없이 시작하는 IDR이 디코딩 시작점
+                frame.keyframe = (naluType == NALU_TYPE_SPS)
+                              || (naluType == NALU_TYPE_IDR && prevNaluType != NALU_TYPE_PPS && prevNaluType != NALU_TYPE_SPS);
+                prevNaluType = naluType;
+
+                // 새 픽처는 이전 픽처로부터 표시 간격 / Speed가 지난 뒤에 보냄 (한 간격 이상 늦었으면 기준 시각을 다시 잡음)
+                if (newPicture) {
+                    next_picture_time += delay;
+                    const auto now = std::chrono::steady_clock::now();
+                    if (next_picture_time > now) {
+                        const int64_t remaining_time_us = std::chrono::duration_cast<std::chrono::microseconds>(next_picture_time - now).count();
+                        const int64_t wakeNs = ThreadRegistry::NowNs() + remaining_time_us * 1000;
+                        std::this_thread::sleep_until(next_picture_time);
+                        ThreadRegistry::GetInstance().RecordLatency(eThreadRole_Capture, ThreadRegistry::NowNs() - wakeNs);
+                    } else if (now - next_picture_time > delay) {
+                        next_picture_time = now;
+                    }
+                }
 
                 // Process the frame
                 DataCapture::getInstance().pushFrame(frame);
+        }
+            ThreadRegistry::GetInstance().Leave(); });
+}
 
-                // Calculate elapsed time
-                auto frame_end_time = std::chrono::high_resolution_clock::now();
-                auto elapsed_time_us = std::chrono::duration_cast<std::chrono::microseconds>(frame_end_time - frame_start_time).count();
-                // Calculate remaining time to wait
-                int64_t remaining_time_us = target_frame_duration_us - elapsed_time_us;
-                if (remaining_time_us > 0) {
-                    std::this_thread::sleep_for(std::chrono::microseconds(remaining_time_us));
-                }
-        } })
-        .detach();
+/**
+ * @brief 재생 위치를 옮기는 함수 (PLAY 요청의 Range)
+ * @param npt [in] 요청한 시작 시각, [out] 이동한 IDR 액세스 유닛의 시각 (초)
+ * @param rtpTime [out] 이동한 위치의 첫 NAL 유닛에 붙일 RTP 타임스탬프
+ * @return bool 이동 성공 여부 (false: 재생 시간을 벗어남)
+ * @details 파일의 액세스 유닛 색인을 이진 탐색하며, 타임스탬프는 이어서 증가하므로 클라이언트는 RTP-Info의 rtptime으로
+ *          이동한 위치를 알 수 있습니다. 파일은 모든 세션이 공유하므로 서버는 다른 세션이 재생 중이면 이 함수를 호출하지 않습니다.
+ */
+bool SeekH264File(double& npt, uint32_t& rtpTime)
+{
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    if (!sourceFile) {
+        return false;
+    }
+    const double position = sourceFile->seek_to_time(npt, sourceFps);
+    if (position < 0) {
+        return false;
+    }
+    keyframeRequested = false;
+    npt = position;
+    // 같은 액세스 유닛으로 이동해도 이미 보낸 NAL 유닛과 타임스탬프가 겹치지 않도록 새 픽처로 처리
+    sourceAccessUnit = -1;
+    rtpTime = sourceTimestamp + rtpTicksPerFrame;
+    return true;
+}
+
+/**
+ * @brief 재생 배율과 전송 속도를 바꾸는 함수 (PLAY 요청의 Scale/Speed)
+ * @param scale [in] 요청한 재생 배율, [out] 적용한 배율 (절댓값을 minScale~maxScale로 제한)
+ * @param speed [in] 요청한 전송 속도, [out] 적용한 속도 (minSpeed~maxSpeed로 제한)
+ * @param npt [out] 다시 시작하는 위치 (초)
+ * @param rtpTime [out] 다시 시작하는 위치의 첫 NAL 유닛에 붙일 RTP 타임스탬프
+ * @return bool 변경 성공 여부
+ * @details 현재 액세스 유닛 이하의 마지막 IDR에서 다시 시작하므로, 배율을 바꾼 직후의 첫 픽처도 바로 디코딩할 수 있습니다.
+ */
+bool SetH264Rate(double& scale, double& speed, double& npt, uint32_t& rtpTime)
+{
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    if (!sourceFile) {
+        return false;
+    }
+    const int64_t current = (sourceAccessUnit >= 0) ? sourceAccessUnit : std::max<int64_t>(sourceFile->get_access_unit(), 0);
+    const int64_t unit = sourceFile->find_random_access_unit(std::min(current, sourceFile->get_access_unit_count() - 1), 0);
+    if (!sourceFile->seek_to_access_unit(unit)) {
+        return false;
+    }
+    scale = std::copysign(std::min(std::max(std::abs(scale), minScale), maxScale), scale);
+    speed = std::min(std::max(speed, minSpeed), maxSpeed);
+    sourceScale = scale;
+    sourceSpeed = speed;
+    keyframeRequested = false;
+    npt = static_cast<double>(unit) / sourceFps;
+    sourceAccessUnit = -1;
+    rtpTime = sourceTimestamp + rtpTicksPerFrame;
+    return true;
+}
+
+/**
+ * @brief 파일의 SPS/PPS, 평균 비트레이트와 재생 시간을 서버에 알리는 함수
+ * @details DESCRIBE 응답의 SDP(sprop-parameter-sets, profile-level-id, b=AS, a=range)에 사용되며,
+ *          DESCRIBE는 재생 스레드가 시작되는 첫 SETUP보다 먼저 오므로 서버 시작 전에 호출합니다.
+ */
+void PublishH264Parameters()
+{
+    H264Encoder h264_file(h264FilePath);
+    std::string sps, pps;
+    if (h264_file.get_parameter_sets(sps, pps)) {
+        RTSPServer::getInstance().setH264ParameterSets(sps, pps);
+    }
+    RTSPServer::getInstance().setBitrate(static_cast<int>(h264_file.estimate_bitrate(sourceFps) / 1000));
+    RTSPServer::getInstance().setDuration(h264_file.get_duration(sourceFps));
+}
+
+/**
+ * @brief 파일 읽기 스레드를 멈추는 함수
+ * @details 서버 종료 이벤트에서 호출되며, 스레드가 끝날 때까지 기다립니다. (최대 한 프레임 간격)
+ */
+void StopH264File()
+{
+    sourceRunning = false;
+    if (sourceThread.joinable()) {
+        sourceThread.join();
+    }
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    sourceFile.reset();
 }
 
 /**
@@ -70,23 +265,35 @@ void LoadH264File()
  * @return int 프로그램 종료 코드 (0: 정상 종료)
  * 
  * @details RTSP 서버를 초기화하고 시작하는 주요 단계:
- * 1. RTSP 서버 프로토콜을 H264로 설정
+ * 1. RTSP 서버 프로토콜을 H264로 설정하고 파일의 SPS/PPS, 비트레이트와 재생 시간을 알림
  * 2. 초기화 이벤트 핸들러로 LoadH264File 함수 등록
- * 3. 서버 스레드 시작
- * 4. 무한 루프로 서버 유지
+ * 3. 키프레임 요청, 재생 위치 이동(Range)과 배율 변경(Scale/Speed) 이벤트 핸들러 등록
+ * 4. 서버 스레드 시작
+ * 5. SIGINT/SIGTERM을 받을 때까지 대기한 뒤 서버 종료
  */
 int main(int argc, char *argv[])
 {
-    
+    // 서버 스레드들이 신호를 가로채지 않도록 시작 전에 막고, 메인 스레드에서만 기다림
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
     RTSPServer::getInstance().setProtocol(Protocol::PROTO_H264);
+    PublishH264Parameters();
     RTSPServer::getInstance().onInitEvent = LoadH264File;
-    RTSPServer::getInstance().startServerThread();
-
-    while (1)
-    {
-        sleep(1);
+    RTSPServer::getInstance().onStopEvent = StopH264File;
+    RTSPServer::getInstance().onKeyframeEvent = []() { keyframeRequested = true; };
+    RTSPServer::getInstance().onSeekEvent = SeekH264File;
+    RTSPServer::getInstance().onRateEvent = SetH264Rate;
+    if (RTSPServer::getInstance().startServerThread() != 0) {
+        return 1;
     }
-    
-        
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    std::cout << "Signal (" << signal << ") received. Shutting down..." << std::endl;
+    RTSPServer::getInstance().stop();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,238 @@
+/**
+ * @file AdmissionControl.h
+ * @brief 서버 전체 수락 제어 클래스 헤더
+ * @details 세션 수, 총 송신 비트레이트, 송신 워커 CPU 사용률 예산을 넘는 SETUP/PLAY를 거부하는 싱글톤 클래스
+ *          - 예산을 넘는 요청은 기존 스트림을 망가뜨리지 않도록 시작 전에 거부 (453 Not Enough Bandwidth, 503 + Retry-After)
+ *          - 송신 비트레이트는 트랙별 실측 비트레이트(DataCapture)와 재생 중인 스트림 수로 계산
+ *          - 현재 사용량과 거부 횟수를 통계로 제공
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_ADMISSIONCONTROL_H
+#define RTSP_ADMISSIONCONTROL_H
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include "DataCapture.h"
+
+/**
+ * @enum AdmissionResult
+ * @brief 수락 검사 결과
+ */
+enum AdmissionResult {
+    eAdmission_Accepted,     ///< 수락
+    eAdmission_NoBandwidth,  ///< 송신 비트레이트 예산 초과 (453 Not Enough Bandwidth)
+    eAdmission_Busy,         ///< 세션 수 또는 송신 CPU 예산 초과 (503 Service Unavailable, Retry-After)
+    eAdmission_SourceShared, ///< 다른 세션도 보고 있는 소스의 위치/배율 변경 (455 Method Not Valid in This State)
+};
+
+/**
+ * @struct AdmissionStats
+ * @brief 수락 제어 통계 구조체 (예산 0은 제한 없음)
+ */
+struct AdmissionStats {
+    size_t sessions = 0;            ///< 현재 세션 수 (SETUP으로 세션 테이블에 등록된 세션)
+    int maxSessions = 0;            ///< 최대 세션 수
+    int playingStreams = 0;         ///< 재생 중인 유니캐스트 스트림 수 (세션 x 트랙)
+    uint64_t egressKbps = 0;        ///< 현재 송신 비트레이트 추정값 (kbps, 재생 중인 스트림의 트랙 실측 비트레이트 합)
+    int maxEgressKbps = 0;          ///< 최대 송신 비트레이트 (kbps)
+    double senderCpuPercent = 0.0;  ///< 송신 워커 CPU 사용률 (워커 코어 대비 %, 최근 측정 구간)
+    int maxSenderCpuPercent = 0;    ///< 최대 송신 워커 CPU 사용률 (%)
+    uint64_t admitted = 0;          ///< 수락한 수 (새 세션 생성 + 새 스트림을 시작한 PLAY)
+    uint64_t rejectedSessions = 0;  ///< 세션 수 초과로 거부한 수 (503)
+    uint64_t rejectedBandwidth = 0; ///< 비트레이트 초과로 거부한 수 (453)
+    uint64_t rejectedCpu = 0;       ///< CPU 사용률 초과로 거부한 수 (503)
+};
+
+/**
+ * @class AdmissionControl
+ * @brief 서버 전체 예산으로 새 세션과 재생 시작을 수락하거나 거부하는 싱글톤 클래스
+ * @details RequestHandler가 SETUP에서 CheckSession/CheckStreams, PLAY에서 StartStreams를 호출하고,
+ *          유니캐스트 스트림의 재생 정지를 StopStream으로 알린다.
+ *          StartStreams는 검사와 재생 중인 스트림 기록을 한 번에 하므로 여러 이벤트 루프에서 동시에 PLAY 해도 예산을 넘지 않는다.
+ *          송신 비트레이트 = 트랙별 (재생 중인 유니캐스트 스트림 수 x 트랙 비트레이트) + 송신 중인 멀티캐스트 트랙 비트레이트
+ *          트랙 비트레이트는 DataCapture가 1초마다 실측한 값이며, 측정 전에는 setBitrate로 알린 값을 사용한다.
+ *          CPU 사용률은 송신 워커들의 스레드 CPU 시간 증가량을 경과 시간 x 워커 수로 나눈 값이다.
+ *          환경 변수 RTSP_MAX_SESSIONS, RTSP_MAX_EGRESS_KBPS, RTSP_MAX_SENDER_CPU가 있으면 서버 시작 시 그 값이 우선한다.
+ */
+class AdmissionControl {
+public:
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return AdmissionControl& 싱글톤 인스턴스에 대한 참조
+     */
+    static AdmissionControl& GetInstance() {
+        static AdmissionControl instance;
+        return instance;
+    };
+
+    static const int retry_after_sec = 5;       ///< 503 응답의 Retry-After (초)
+    static const int cpu_sample_interval_ms = 500; ///< CPU 사용률을 다시 계산하는 최소 간격
+
+    /**
+     * @brief 최대 세션 수를 설정하는 메서드
+     * @param count 최대 세션 수 (0: 제한 없음)
+     */
+    void SetMaxSessions(int count);
+
+    /**
+     * @brief 최대 송신 비트레이트를 설정하는 메서드
+     * @param kbps 서버 전체 송신 비트레이트 상한 (kbps, 0: 제한 없음)
+     */
+    void SetMaxEgressBitrate(int kbps);
+
+    /**
+     * @brief 최대 송신 워커 CPU 사용률을 설정하는 메서드
+     * @param percent 송신 워커 코어 대비 사용률 상한 (1~100 %, 0: 제한 없음)
+     */
+    void SetMaxSenderCpu(int percent);
+
+    /**
+     * @brief 새 세션을 만들 수 있는지 검사하고 수락하면 세션 자리를 예약하는 메서드 (세션의 첫 SETUP)
+     * @return AdmissionResult 세션 수(세션 테이블 + 예약)나 CPU 예산을 넘으면 eAdmission_Busy
+     * @details 수락하면 AdmitSession이나 ReleaseSession을 호출할 때까지 자리를 예약하므로,
+     *          여러 이벤트 루프에서 동시에 SETUP 해도 최대 세션 수를 넘지 않는다.
+     */
+    AdmissionResult CheckSession();
+
+    /**
+     * @brief 예약한 세션 자리를 세션 생성으로 기록하는 메서드 (세션이 세션 테이블에 처음 등록될 때)
+     */
+    void AdmitSession();
+
+    /**
+     * @brief 예약한 세션 자리를 돌려주는 메서드 (CheckSession으로 수락한 SETUP이 실패했을 때)
+     */
+    void ReleaseSession();
+
+    /**
+     * @brief 트랙 스트림을 더 보낼 수 있는지 검사하는 메서드 (SETUP)
+     * @param tracks 새로 보낼 유니캐스트 스트림의 트랙 번호 목록 (같은 트랙이 여러 번 있을 수 있음)
+     * @param multicastTracks 새로 보낼 멀티캐스트 트랙 번호 목록 (이미 송신 중인 트랙은 추가 비트레이트 없음)
+     * @return AdmissionResult CPU 예산을 넘으면 eAdmission_Busy, 송신 비트레이트 예산을 넘으면 eAdmission_NoBandwidth
+     */
+    AdmissionResult CheckStreams(const std::vector<int>& tracks, const std::vector<int>& multicastTracks = {});
+
+    /**
+     * @brief 트랙 스트림을 검사하고 수락하면 재생 시작을 기록하는 메서드 (PLAY)
+     * @param tracks 재생을 시작할 유니캐스트 스트림의 트랙 번호 목록
+     * @param multicastTracks 재생을 시작할 멀티캐스트 트랙 번호 목록 (있으면 멀티캐스트 시청자 하나로 기록)
+     * @param exclusiveOwner 소스의 위치나 배율을 바꾸려는 세션 (nullptr: 현재 위치와 배율에 합류)
+     * @param ownStreams 요청한 세션이 이미 재생 중인 유니캐스트 스트림 수 (exclusiveOwner가 있을 때 다른 세션과 구분)
+     * @return AdmissionResult CheckStreams와 같고, 다음이면 eAdmission_SourceShared
+     *         (eAdmission_Accepted일 때만 기록, 시작할 스트림이 있으면 수락 수 증가)
+     *         - exclusiveOwner가 있는데 소스를 다른 세션이나 멀티캐스트 시청자가 공유하거나 다른 세션이 소스를 잡고 있음
+     *         - 합류하는데 다른 세션이 소스를 잡고 있음 (위치/배율을 바꾸는 중이거나 1배가 아닌 배율로 재생 중)
+     * @details 소스 공유 검사와 기록을 같은 잠금 아래에서 하므로, 동시에 재생을 시작한 다른 세션을 놓치지 않는다.
+     *          exclusiveOwner로 수락하면 그 세션이 소스를 잡으며, ReleaseSource를 호출할 때까지 다른 세션은 합류할 수 없다.
+     */
+    AdmissionResult StartStreams(const std::vector<int>& tracks, const std::vector<int>& multicastTracks = {},
+                                 const void* exclusiveOwner = nullptr, int ownStreams = 0);
+
+    /**
+     * @brief StartStreams의 exclusiveOwner로 잡은 소스를 놓는 메서드 (위치/배율 변경을 마친 뒤, 연결 종료)
+     * @param owner 소스를 잡은 세션 (잡은 세션이 아니면 무시)
+     * @param rateChanged 소스가 1배가 아닌 배율로 재생 중인지 여부 (true면 계속 잡고 있어 다른 세션이 합류하지 못함)
+     */
+    void ReleaseSource(const void* owner, bool rateChanged);
+
+    /**
+     * @brief 유니캐스트 스트림 재생 정지를 기록하는 메서드 (PAUSE, TEARDOWN, 연결 종료)
+     * @param track 트랙 번호
+     */
+    void StopStream(int track);
+
+    /**
+     * @brief 멀티캐스트 시청 정지를 기록하는 메서드 (StartStreams로 시작한 시청자의 PAUSE, TEARDOWN, 연결 종료)
+     */
+    void StopMulticast();
+
+    /**
+     * @brief 재생 중인 유니캐스트 스트림 수를 반환하는 메서드
+     * @return int 모든 트랙의 재생 중인 스트림 수 합 (세션 x 트랙)
+     */
+    int GetPlayingStreams();
+
+    /**
+     * @brief 트랙 하나의 비트레이트를 반환하는 메서드
+     * @param track 트랙 번호
+     * @return uint64_t 비트레이트 (bps, 실측값, 측정 전이면 setBitrate 값, 둘 다 없으면 0)
+     */
+    uint64_t GetTrackBitrate(int track);
+
+    /**
+     * @brief 현재 송신 비트레이트 추정값을 반환하는 메서드
+     * @return uint64_t 비트레이트 (bps)
+     */
+    uint64_t GetEgressBitrate();
+
+    /**
+     * @brief 송신 워커 CPU 사용률을 반환하는 메서드
+     * @return double 워커 코어 대비 사용률 (%, cpu_sample_interval_ms보다 자주 호출하면 이전 값)
+     */
+    double GetSenderCpuPercent();
+
+    /**
+     * @brief 수락 제어 통계를 반환하는 메서드
+     * @return AdmissionStats 현재 사용량, 예산, 거부 횟수
+     */
+    AdmissionStats GetStats();
+
+private:
+    /**
+     * @brief 생성자 - 검사할 때 읽는 싱글톤을 먼저 생성
+     */
+    AdmissionControl();
+
+    /**
+     * @brief CPU 사용률 예산을 넘었는지 확인하는 메서드
+     * @return bool 넘었는지 여부 (예산이 없으면 false)
+     */
+    bool IsCpuExhausted();
+
+    /**
+     * @brief 트랙 스트림 예산을 검사하는 메서드 (admissionMutex를 잡은 상태에서 호출)
+     * @param tracks 새 유니캐스트 스트림의 트랙 번호 목록
+     * @param multicastTracks 새 멀티캐스트 트랙 번호 목록
+     * @return AdmissionResult 검사 결과 (거부 횟수도 기록)
+     */
+    AdmissionResult Evaluate(const std::vector<int>& tracks, const std::vector<int>& multicastTracks);
+
+    /**
+     * @brief 현재 송신 비트레이트를 계산하는 메서드 (admissionMutex를 잡은 상태에서 호출)
+     * @return uint64_t 비트레이트 (bps)
+     */
+    uint64_t ComputeEgressBitrate();
+
+    std::atomic<int> maxSessions{0};         ///< 최대 세션 수 (0: 제한 없음)
+    std::atomic<int> maxEgressKbps{0};       ///< 최대 송신 비트레이트 (kbps, 0: 제한 없음)
+    std::atomic<int> maxSenderCpuPercent{0}; ///< 최대 송신 워커 CPU 사용률 (%, 0: 제한 없음)
+
+    std::mutex admissionMutex;               ///< 재생 중인 스트림 수와 세션 예약 수 보호 뮤텍스 (검사와 기록을 함께 잡음)
+    int reservedSessions = 0;                ///< CheckSession으로 수락했지만 아직 세션 테이블에 등록되지 않은 세션 수
+    int playing[DataCapture::max_tracks] = {}; ///< 트랙별 재생 중인 유니캐스트 스트림 수
+    int multicastViewers = 0;                ///< 재생 중인 멀티캐스트 시청자 수
+    const void* sourceHolder = nullptr;      ///< 소스의 위치/배율을 바꾸고 있거나 1배가 아닌 배율로 재생 중인 세션
+
+    std::mutex cpuMutex;                     ///< CPU 측정값 보호 뮤텍스
+    int64_t cpuSampleWallNs = 0;             ///< 마지막 CPU 측정 시각 (단조 시계)
+    int64_t cpuSampleNs = 0;                 ///< 마지막 측정 때의 워커 CPU 시간 합
+    double cpuPercent = 0.0;                 ///< 마지막으로 계산한 CPU 사용률
+
+    std::atomic<uint64_t> admitted{0};          ///< 수락한 세션 생성과 재생 시작 수
+    std::atomic<uint64_t> rejectedSessions{0};  ///< 세션 수 초과로 거부한 수
+    std::atomic<uint64_t> rejectedBandwidth{0}; ///< 비트레이트 초과로 거부한 수
+    std::atomic<uint64_t> rejectedCpu{0};       ///< CPU 사용률 초과로 거부한 수
+};
+
+#endif //RTSP_ADMISSIONCONTROL_H
@@ -5,6 +5,9 @@
  *          - 클라이언트 식별을 위한 세션 ID 관리
  *          - TCP/UDP 소켓 및 포트 관리
  *          - 클라이언트 IP 주소 관리
+ *          - RTP/RTCP interleaved 전송 (RTSP TCP 연결로 미디어 전송)
+ *          - 연결별 출력 버퍼로 RTSP 응답과 interleaved 패킷을 논블로킹 전송
+ *          - 세션 타임아웃을 위한 마지막 활동 시간 관리
  * 
  * @organization rtspMediaStream
  * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
@@ -18,10 +21,15 @@
 #include <map>
 #include <queue>
 #include <mutex>
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <sys/uio.h>
 
 class RequestHandler;
 class UDPHandler;
@@ -35,6 +43,8 @@ class MediaStreamHandler;
  */
 class ClientSession {
 public:
+    static const size_t max_output_backlog = 256 * 1024; ///< 출력 버퍼 최대 크기 (넘으면 읽지 않는 클라이언트로 보고 연결을 끊음)
+
     /** 
      * @brief 클라이언트 세션 생성자 - 새로운 클라이언트 세션 초기화
      * @param tcpSocket 클라이언트와 연결된 TCP 소켓
@@ -42,17 +52,23 @@ public:
      */
     ClientSession(const int tcpSocket, const std::string ip);
     
+    /**
+     * @brief 세션 ID를 새로 생성하는 메서드
+     * @details 세션 테이블에서 다른 활성 세션과 ID가 겹칠 때 사용
+     */
+    void RegenerateID();
+
     /**
      * @brief 클라이언트 세션 버전 정보를 반환하는 메서드
-     * @return int 클라이언트 세션 버전 정보
+     * @return uint64_t 클라이언트 세션 버전 정보
      */
-    int GetVersion() const;
+    uint64_t GetVersion() const;
 
     /**
      * @brief 클라이언트 ID를 반환하는 메서드
-     * @return int 랜덤하게 생성된 클라이언트의 고유 ID
+     * @return uint64_t CSPRNG로 생성한 클라이언트의 고유 64비트 ID (0이 아님, Session 헤더에는 16자리 16진수로 표기)
      */
-    inline int GetID() { return this->id; };
+    inline uint64_t GetID() { return this->id; };
 
     /**
      * @brief 클라이언트 세션의 TCP 소켓 정보를 반환하는 메서드
@@ -78,6 +94,13 @@ public:
      */
     inline std::string GetIP() { return this->ip; };
 
+    /**
+     * @brief 클라이언트가 접속한 서버 쪽 IP 주소를 반환하는 메서드
+     * @return const std::string& 제어 연결의 로컬 IPv4 주소 (getsockname, 알 수 없으면 "0.0.0.0")
+     * @details 여러 인터페이스가 있어도 클라이언트가 실제로 도달한 주소이므로 SDP와 Content-Base에 사용
+     */
+    inline const std::string& GetLocalIP() { return this->localIP; };
+
     /**
      * @brief RTP 포트 번호를 설정하는 메서드
      * @param rtpPort 설정할 RTP 포트 번호
@@ -90,13 +113,130 @@ public:
      */
     inline void SetRTCPPort(int rtcpPort) { this->rtcpPort = rtcpPort; };
 
+    /**
+     * @brief RFC 5761 rtcp-mux 사용 여부를 반환하는 메서드
+     * @return bool RTP와 RTCP를 한 포트로 다중화하는지 여부
+     */
+    inline bool IsRTCPMux() { return this->rtcpMux; };
+
+    /**
+     * @brief RFC 5761 rtcp-mux 사용 여부를 설정하는 메서드
+     * @param rtcpMux rtcp-mux 사용 여부
+     */
+    inline void SetRTCPMux(bool rtcpMux) { this->rtcpMux = rtcpMux; };
+
+    /**
+     * @brief RTP/RTCP를 RTSP TCP 연결로 interleaved 전송하는지 반환하는 메서드
+     * @return bool interleaved 전송 여부 (RTP/AVP/TCP)
+     */
+    inline bool IsInterleaved() { return this->interleaved; };
+
+    /**
+     * @brief interleaved 전송 여부를 설정하는 메서드
+     * @param interleaved interleaved 전송 여부 (채널 번호는 트랙마다 MediaStreamHandler가 보관)
+     */
+    inline void SetInterleaved(bool interleaved) { this->interleaved = interleaved; };
+
+    /**
+     * @brief interleaved 미디어 데이터를 TCP 연결로 전송하는 메서드
+     * @param iov 전송할 데이터 조각 ('$' 프레이밍 헤더와 RTP/RTCP 헤더, 페이로드를 복사 없이 가리킴)
+     * @param iovCount 조각 수
+     * @return bool 전송 여부 (false: 송신 버퍼에 여유가 없어 통째로 버림)
+     * @details 출력 버퍼에 남은 데이터(응답이나 패킷 조각)가 있으면 그 뒤에 붙여 writev 한 번으로 함께 보낸다.
+     *          송신 버퍼 여유가 부족하면 일부만 보내 스트림을 깨뜨리지 않도록 보내기 전에 버리고,
+     *          그래도 일부만 전송되면 나머지만 출력 버퍼에 복사해 두었다가 소켓이 쓰기 가능해지면 마저 보낸다.
+     */
+    bool WriteInterleaved(const struct iovec* iov, int iovCount);
+
+    /**
+     * @brief RTSP 응답을 전송하는 메서드
+     * @param response 전송할 RTSP 응답 메시지
+     * @details 응답을 출력 버퍼 끝에 넣고 블로킹하지 않고 보낼 수 있는 만큼 보낸다. 나머지는 소켓이 쓰기 가능해지면
+     *          OnWritable()에서 이어서 보낸다. interleaved 패킷과 같은 버퍼와 잠금을 쓰므로 패킷 중간에 끼어들지 않는다.
+     *          출력 버퍼가 max_output_backlog를 넘으면 응답을 버리고 연결을 끊는다.
+     */
+    void SendRTSPResponse(std::string& response);
+
+    /**
+     * @brief 소켓이 쓰기 가능할 때 출력 버퍼를 전송하는 메서드
+     * @return bool 연결 유지 여부 (false: 전송 실패)
+     * @details 이벤트 루프가 EPOLLOUT에서 호출하며, 버퍼를 모두 보내면 쓰기 감시를 끈다.
+     */
+    bool OnWritable();
+
+    /**
+     * @brief 쓰기 감시 변경 콜백을 설정하는 메서드
+     * @param callback 출력 버퍼에 보내지 못한 데이터가 생기면 true, 모두 보내면 false로 호출 (쓰기 잠금 아래에서 호출됨)
+     * @details 이벤트 루프에 제어 연결을 등록할 때 설정하여 EPOLLOUT 감시를 켜고 끈다.
+     */
+    inline void SetWriteInterestCallback(std::function<void(bool)> callback) { this->onWriteInterest = std::move(callback); };
+
+    /**
+     * @brief 세션 활동을 기록하는 메서드
+     * @details RTSP 요청이나 RTCP 패킷을 받을 때 호출하며, 세션 타임아웃을 연장한다.
+     */
+    void Touch();
+
+    /**
+     * @brief 마지막 활동 후 지난 시간을 반환하는 메서드
+     * @return int64_t 경과 시간 (ms)
+     */
+    int64_t GetIdleMs();
+
+    /**
+     * @brief 타임아웃된 세션의 제어 연결을 끊는 메서드
+     * @details 소켓을 shutdown하여 이벤트 루프가 연결 종료를 감지하고 세션을 정리하도록 함 (닫지는 않음)
+     */
+    void Expire();
+
+    /**
+     * @brief TCP 연결을 닫는 메서드
+     * @details 쓰기 잠금 아래에서 소켓을 닫고 무효화하여 이후의 미디어/응답 전송을 무시
+     */
+    void CloseConnection();
+
 private:
-    int id;         ///< 클라이언트 세션 ID
-    int version;    ///< 클라이언트 세션 버전 정보
+    uint64_t id;      ///< 클라이언트 세션 ID
+    uint64_t version; ///< 클라이언트 세션 버전 정보
     int tcpSocket;  ///< TCP 소켓 디스크립터
     int rtpPort;    ///< RTP 스트리밍을 위한 포트 번호
     int rtcpPort;   ///< RTCP 제어를 위한 포트 번호
+    bool rtcpMux;   ///< RTP 포트 하나로 RTCP를 다중화하는지 여부
+    bool interleaved; ///< RTP/RTCP를 RTSP TCP 연결로 전송하는지 여부
     std::string ip; ///< 클라이언트 IP 주소
+    std::string localIP; ///< 제어 연결의 서버 쪽 IP 주소
+
+    std::mutex writeMutex;     ///< TCP 연결 쓰기 직렬화 (미디어 송신 워커와 이벤트 루프)
+    std::string pendingOutput; ///< 출력 버퍼 (보내지 못한 응답과 일부만 전송된 interleaved 패킷의 나머지)
+    std::vector<struct iovec> writeVector; ///< 출력 버퍼와 interleaved 패킷을 함께 보낼 writev 조각 (재사용)
+    std::function<void(bool)> onWriteInterest; ///< 쓰기 감시(EPOLLOUT) 변경 콜백
+    bool writeInterest = false; ///< 쓰기 감시 중인지 여부
+    bool outputClosed = false;  ///< 전송 실패나 출력 버퍼 초과로 연결을 끊었는지 여부 (이후 전송은 무시)
+    int sendBufferSize = 0;    ///< TCP 송신 버퍼 크기 (처음 전송 시 조회)
+    std::atomic<int64_t> lastActivityMs{0}; ///< 마지막 활동 시간 (steady clock, ms)
+
+    /**
+     * @brief 출력 버퍼를 논블로킹으로 전송하는 메서드 (writeMutex를 잡은 상태에서 호출)
+     * @return bool 연결 유지 여부 (false: 전송 실패로 연결을 끊음, 송신 버퍼가 차서 남은 것은 true)
+     * @details 보내지 못한 데이터가 남았는지에 따라 쓰기 감시를 켜고 끈다.
+     */
+    bool FlushPendingOutput();
+
+    /**
+     * @brief 출력을 버리고 연결을 끊는 메서드 (writeMutex를 잡은 상태에서 호출)
+     */
+    void ShutdownOutput();
+
+    /**
+     * @brief 출력 버퍼 상태에 맞게 쓰기 감시를 켜거나 끄는 메서드 (writeMutex를 잡은 상태에서 호출)
+     */
+    void UpdateWriteInterest();
+
+    /**
+     * @brief TCP 송신 버퍼의 남은 공간을 반환하는 메서드 (writeMutex를 잡은 상태에서 호출)
+     * @return int64_t 큐에 더 넣을 수 있는 대략적인 바이트 수
+     */
+    int64_t GetSendBufferSpace();
     
     RequestHandler* requestHandler; ///< 클라이언트 요청 처리를 위한 핸들러
 };
@@ -18,6 +18,11 @@
 #include <vector>
 #include <queue>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
 
 /**
  * @struct DataCaptureFrame
@@ -27,26 +32,45 @@ struct DataCaptureFrame {
     unsigned char *dataPtr; ///< 프레임 데이터 포인터
     unsigned int size;      ///< 프레임 데이터 크기
     unsigned int timestamp; ///< 프레임 타임스탬프
+    bool keyframe = false;  ///< 디코딩 시작점(IDR 또는 그 앞의 SPS)인지 여부
+};
+
+/**
+ * @struct DataCaptureSharedFrame
+ * @brief 세션이 링 버퍼에서 읽어간 프레임 구조체
+ * @details 프레임 데이터는 참조 카운트로 공유되므로, 세션이 전송하는 동안
+ *          생산자가 같은 슬롯을 덮어쓰더라도 새 버퍼를 할당하여 데이터가 바뀌지 않는다.
+ */
+struct DataCaptureSharedFrame {
+    std::shared_ptr<std::vector<unsigned char>> data; ///< 프레임 데이터
+    unsigned int timestamp = 0;                       ///< 프레임 타임스탬프
+    bool keyframe = false;                            ///< 디코딩 시작점인지 여부
+    uint64_t sequence = 0;                            ///< 링 버퍼에 기록된 순번
 };
 
 /**
  * @class DataCapture
  * @brief 미디어 프레임 캡처 및 버퍼 관리를 위한 싱글톤 클래스
  * @details 순환 큐 기반의 프레임 버퍼 관리 시스템을 구현한 클래스로,
- *          프레임 데이터를 캡처하고 버퍼에 저장하며, 필요 시 프레임 데이터를 반환하는 기능을 제공한다.
+ *          생산자는 가장 오래된 프레임을 덮어쓰며 프레임을 기록하고,
+ *          각 세션은 자신의 읽기 순번으로 같은 프레임을 독립적으로 읽어간다.
+ *          느린 세션은 링에서 밀려나며 다른 세션이나 생산자를 기다리게 하지 않는다.
+ *          트랙(RTSPServer::addTrack)마다 인스턴스가 하나씩 있으며, 각 트랙의 소스는 자기 트랙 인스턴스에 기록한다.
  */
 class DataCapture {
 public:
-    static const int buffer_max_size = 10; ///< 프레임 버퍼 최대 크기
+    static const int buffer_max_size = 64; ///< 프레임 버퍼 최대 크기
+    static const int max_tracks = 4;       ///< 한 프레젠테이션의 최대 트랙 수
 
     /**
-     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
-     * @return DataCapture& 싱글톤 인스턴스에 대한 참조
+     * @brief 트랙의 인스턴스를 반환하는 정적 메서드
+     * @param track 트랙 번호 (범위를 벗어나면 0번 트랙)
+     * @return DataCapture& 트랙 인스턴스에 대한 참조
      */
-    static DataCapture &getInstance()
+    static DataCapture &getInstance(int track = 0)
     {
-        static DataCapture instance;
-        return instance;
+        static DataCapture instances[max_tracks];
+        return instances[(track >= 0 && track < max_tracks) ? track : 0];
     }
 
     /**
@@ -55,50 +79,111 @@ public:
      * @return false 버퍼에 데이터가 있는 경우
      */
     inline bool isEmptyBuffer() { return (buffer_size == 0); };
-    /**
-     * @brief 버퍼가 가득 찼는지 확인
-     * @return true 버퍼가 가득 찬 경우
-     * @return false 버퍼에 여유 공간이 있는 경우
-     */
-    inline bool isFullBuffer() { return (buffer_size == buffer_max_size); };
-    
+
     /**
      * @brief 프레임 데이터를 버퍼에 저장하는 메서드
      * @param frame 저장할 프레임 데이터
+     * @details 버퍼가 가득 차면 가장 오래된 프레임을 덮어쓰고 대기 중인 세션을 깨운 뒤 기록한 프레임으로 프레임 이벤트 콜백을 호출한다.
      */
     virtual void pushFrame(const DataCaptureFrame& frame);
-    
+
+    /**
+     * @brief 세션의 읽기 순번 위치의 프레임을 반환하는 메서드
+     * @param readSeq [in,out] 읽을 순번. 읽은 프레임의 다음 순번으로 갱신
+     * @param frame [out] 읽은 프레임
+     * @return bool 새 프레임을 읽었는지 여부
+     * @details readSeq가 이미 덮어써진 프레임을 가리키면 남아 있는 가장 오래된 프레임을 반환한다.
+     *          이때 frame.sequence가 요청한 순번과 달라지므로 호출자는 누락을 알 수 있다.
+     */
+    bool readFrame(uint64_t& readSeq, DataCaptureSharedFrame& frame);
+
+    /**
+     * @brief readSeq 위치에 프레임이 기록될 때까지 대기하는 메서드
+     * @param readSeq 기다릴 읽기 순번
+     * @param timeoutMs 최대 대기 시간 (ms)
+     * @return bool 읽을 프레임이 있는지 여부
+     */
+    bool waitForFrame(uint64_t readSeq, int timeoutMs);
+
     /**
-     * @brief 버퍼에서 프레임 데이터를 반환하는 메서드
-     * @return DataCaptureFrame 버퍼에서 반환된 프레임 데이터
+     * @brief 다음에 기록될 프레임의 순번을 반환하는 메서드
+     * @return uint64_t 다음 기록 순번 (지금까지 기록된 프레임 수)
      */
-    virtual DataCaptureFrame popFrame();
+    uint64_t getWriteSequence();
+
+    /**
+     * @brief fromSeq 이후 버퍼에 남아 있는 가장 최근 키프레임의 순번을 찾는 메서드
+     * @param fromSeq 검색을 시작할 순번 (이 순번 이상만 검색)
+     * @param keySeq [out] 찾은 키프레임의 순번
+     * @return bool 키프레임을 찾았는지 여부
+     */
+    bool findLatestKeyframe(uint64_t fromSeq, uint64_t& keySeq);
+
+    /**
+     * @brief 최근 1초 동안 기록된 스트림의 비트레이트를 반환하는 메서드
+     * @return uint64_t 비트레이트 (bps, 측정 전에는 0)
+     */
+    inline uint64_t getBitrate() { return bitrate; };
+
+    /**
+     * @brief 키프레임 요청을 대기 상태로 표시하는 메서드
+     * @details 키프레임이 버퍼에 들어올 때까지 들어온 요청은 하나로 병합된다.
+     *          대기 중인 요청이 keyframe_request_timeout_ms 이상 처리되지 않으면 다시 전달을 허용
+     * @return true 새로 대기 상태가 된 경우 (소스에 요청을 전달해야 함)
+     * @return false 이미 대기 중인 요청에 병합된 경우
+     */
+    bool markKeyframePending();
+
+    /**
+     * @brief 새 프레임 기록 이벤트 콜백 함수를 설정하는 메서드
+     * @param callback 생산자 스레드에서 호출할 콜백 (송신 워커에 프레임 전달용, nullptr이면 해제)
+     * @details 진행 중인 콜백 호출이 끝난 뒤에 바꾸므로, 반환 후에는 이전 콜백이 더 이상 호출되지 않는다.
+     */
+    void setFrameEvent(std::function<void(const DataCaptureSharedFrame&)> callback);
 
 protected:
-    std::vector <DataCaptureFrame> frameBuffer; ///< 프레임 데이터를 저장하는 버퍼
-    int head = 0; ///< 버퍼의 시작 위치
-    int tail = 0; ///< 버퍼의 끝 위치
-    int buffer_size = 0; ///< 버퍼에 저장된 프레임 수
+    static const int keyframe_request_timeout_ms = 1000; ///< 대기 중인 키프레임 요청의 재전달 허용 시간
+    static const int bitrate_window_ms = 1000;           ///< 비트레이트 측정 구간
 
-    std::mutex bufferMutex; ///< 버퍼에 대한 스레드 안전성을 보장하는 뮤텍스
+    /**
+     * @struct Slot
+     * @brief 링 버퍼의 프레임 슬롯
+     */
+    struct Slot {
+        std::shared_ptr<std::vector<unsigned char>> data; ///< 프레임 데이터 (세션이 참조 중이면 새로 할당)
+        unsigned int timestamp = 0;                       ///< 프레임 타임스탬프
+        bool keyframe = false;                            ///< 디코딩 시작점인지 여부
+    };
+
+    std::vector <Slot> frameBuffer; ///< 프레임 데이터를 저장하는 버퍼
+    uint64_t writeSeq = 0;          ///< 다음에 기록할 프레임 순번
+    int buffer_size = 0;            ///< 버퍼에 저장된 프레임 수
+
+    std::mutex bufferMutex;                 ///< 버퍼에 대한 스레드 안전성을 보장하는 뮤텍스
+    std::condition_variable frameCondition; ///< 새 프레임 기록을 알리는 조건 변수
+
+    std::atomic<bool> keyframePending{false};      ///< 소스에 전달된 키프레임 요청이 대기 중인지 여부
+    std::atomic<int64_t> keyframeRequestTimeMs{0}; ///< 마지막으로 키프레임 요청을 전달한 시각 (steady clock, ms)
+
+    int64_t bitrateWindowStartMs = 0; ///< 비트레이트 측정 구간 시작 시각 (steady clock, ms)
+    uint64_t bitrateWindowBytes = 0;  ///< 측정 구간 동안 기록된 바이트 수
+    std::atomic<uint64_t> bitrate{0}; ///< 마지막으로 측정된 비트레이트 (bps)
+
+    std::mutex frameEventMutex;                                      ///< 콜백 설정과 호출을 직렬화하는 뮤텍스
+    std::function<void(const DataCaptureSharedFrame&)> onFrameEvent; ///< 새 프레임 기록 이벤트 콜백 함수
 
     /**
      * @brief 생성자 - 버퍼 초기화
      */
     DataCapture()
     {
-        frameBuffer.resize(buffer_max_size, {nullptr, 0 , 0});
+        frameBuffer.resize(buffer_max_size);
     }
 
     /**
-     * @brief 소멸자 - 할당된 메모리 해제
+     * @brief 소멸자 - 프레임 데이터는 shared_ptr로 자동 해제
      */
-    ~DataCapture()
-    {
-        for(auto& pair : frameBuffer) {
-            delete[] pair.dataPtr;
-        }
-    }
+    ~DataCapture() = default;
 };
 
 #endif //__DATACAPTURE_H__
\ No newline at end of file
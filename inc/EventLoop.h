@@ -0,0 +1,122 @@
+/**
+ * @file EventLoop.h
+ * @brief epoll 기반 이벤트 루프 클래스 헤더
+ * @details 논블로킹 소켓 여러 개를 하나의 스레드에서 감시하고,
+ *          준비된 소켓에 등록된 콜백을 호출하는 리액터 클래스
+ *          - 파일 디스크립터별 콜백 등록/변경/해제
+ *          - eventfd를 이용한 루프 종료 요청
+ *          - 연결마다 스레드를 만들지 않고 RTSP 제어 연결 전체를 처리
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_EVENTLOOP_H
+#define RTSP_EVENTLOOP_H
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+/**
+ * @class EventLoop
+ * @brief epoll 기반 리액터 클래스
+ * @details Start()로 시작한 스레드 하나가 epoll_wait로 대기하다가 이벤트가 발생한 소켓의 콜백을 호출한다.
+ *          콜백은 항상 루프 스레드에서 호출되므로 콜백 안에서는 별도의 동기화 없이 연결 상태를 다룰 수 있다.
+ *          콜백 안에서 자기 자신을 Remove 해도 안전하다.
+ */
+class EventLoop {
+public:
+    /**
+     * @brief 소켓 이벤트 콜백 타입
+     * @details 인자로 epoll 이벤트 비트(EPOLLIN, EPOLLOUT, EPOLLRDHUP 등)를 받음
+     */
+    using Callback = std::function<void(uint32_t events)>;
+
+    /**
+     * @brief 생성자 - epoll 인스턴스와 종료 요청용 eventfd 생성
+     */
+    EventLoop();
+
+    /**
+     * @brief 소멸자 - 루프 종료 후 epoll/eventfd 닫기 (등록된 소켓은 닫지 않음)
+     */
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief 이벤트 루프 스레드를 시작하는 메서드
+     * @return bool 성공 여부 (epoll 생성 실패 시 false)
+     */
+    bool Start();
+
+    /**
+     * @brief 이벤트 루프를 멈추도록 요청하는 메서드
+     * @details 루프 스레드는 현재 처리 중인 이벤트를 마친 뒤 종료하며, 루프 밖에서 호출하면 종료까지 기다린다.
+     */
+    void Stop();
+
+    /**
+     * @brief 소켓을 감시 대상에 추가하는 메서드
+     * @param fd 감시할 논블로킹 소켓
+     * @param events 감시할 epoll 이벤트 비트
+     * @param callback 이벤트 발생 시 루프 스레드에서 호출할 콜백
+     * @return bool 성공 여부
+     */
+    bool Add(int fd, uint32_t events, Callback callback);
+
+    /**
+     * @brief 감시 중인 소켓의 이벤트 비트를 변경하는 메서드
+     * @param fd 감시 중인 소켓
+     * @param events 새 epoll 이벤트 비트
+     * @return bool 성공 여부
+     */
+    bool Modify(int fd, uint32_t events);
+
+    /**
+     * @brief 소켓을 감시 대상에서 제거하는 메서드
+     * @param fd 제거할 소켓 (닫는 것은 호출자 책임)
+     * @details 등록된 콜백(과 콜백이 잡고 있는 객체)은 진행 중인 호출이 끝난 뒤 해제된다.
+     */
+    void Remove(int fd);
+
+    /**
+     * @brief 남아 있는 모든 소켓의 콜백을 연결 종료 이벤트로 호출하는 메서드
+     * @details Stop() 뒤에 호출하며, 호출한 스레드에서 각 콜백을 EPOLLHUP으로 한 번씩 호출하여
+     *          콜백이 스스로 Remove 하고 연결을 정리하도록 한다.
+     */
+    void HangUpAll();
+
+    /**
+     * @brief 감시 중인 소켓 수를 반환하는 메서드
+     * @return size_t 등록된 소켓 수
+     */
+    size_t GetCount();
+
+private:
+    static const int max_events = 256; ///< epoll_wait 한 번에 가져올 최대 이벤트 수
+
+    /**
+     * @brief epoll_wait로 대기하며 콜백을 호출하는 루프 스레드 함수
+     */
+    void Run();
+
+    int epollFd = -1;              ///< epoll 인스턴스 디스크립터
+    int wakeupFd = -1;             ///< 루프 종료 요청용 eventfd
+    std::atomic<bool> running{false}; ///< 루프 실행 여부
+    std::thread loopThread;        ///< 이벤트 루프 스레드
+
+    std::mutex callbackMutex;      ///< 콜백 테이블 보호 뮤텍스
+    std::unordered_map<int, std::shared_ptr<Callback>> callbacks; ///< 소켓 -> 콜백
+};
+
+#endif //RTSP_EVENTLOOP_H
@@ -0,0 +1,82 @@
+/**
+ * @file FrameRing.h
+ * @brief 송신 워커별 프레임 링 버퍼 클래스 헤더
+ * @details DataCapture에 기록된 최근 프레임을 송신 워커(코어)마다 복제해 두는 링 버퍼
+ *          - 프레임 데이터는 복사하지 않고 shared_ptr로 공유
+ *          - 소유한 워커 스레드만 접근하므로 잠금 없음
+ *          - DataCapture와 같은 읽기 방식 (읽기 순번, 최신 키프레임 검색)
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_FRAMERING_H
+#define RTSP_FRAMERING_H
+
+#include <vector>
+#include <cstdint>
+#include "DataCapture.h"
+
+/**
+ * @class FrameRing
+ * @brief 워커 하나가 소유하는 프레임 링 버퍼
+ * @details SenderPool 워커는 새 프레임 알림으로 받은 프레임을 자기 링에 넣고, 자기 세션들은 이 링에서 읽는다.
+ *          세션이 프레임을 읽을 때 생산자나 다른 코어와 잠금/캐시 라인을 공유하지 않는다.
+ *          순번이 DataCapture와 같으므로 세션의 읽기 순번은 어느 워커의 링에서도 같은 의미를 가진다.
+ */
+class FrameRing {
+public:
+    static const int ring_size = DataCapture::buffer_max_size; ///< 보관할 최근 프레임 수
+
+    FrameRing();
+
+    /**
+     * @brief 프레임을 링에 넣는 메서드
+     * @param frame DataCapture가 기록한 프레임 (sequence는 DataCapture의 기록 순번)
+     * @details 가장 오래된 프레임을 밀어낸다. 순번이 건너뛰면 그 사이 프레임은 없는 것으로 처리한다.
+     */
+    void pushFrame(const DataCaptureSharedFrame& frame);
+
+    /**
+     * @brief 세션의 읽기 순번 위치의 프레임을 반환하는 메서드
+     * @param readSeq [in,out] 읽을 순번. 읽은 프레임의 다음 순번으로 갱신
+     * @return const DataCaptureSharedFrame* 읽은 프레임 (없으면 nullptr, 다음 pushFrame 전까지 유효)
+     * @details readSeq가 이미 밀려난 프레임을 가리키면 남아 있는 가장 오래된 프레임을 반환한다.
+     *          이때 sequence가 요청한 순번과 달라지므로 호출자는 누락을 알 수 있다.
+     */
+    const DataCaptureSharedFrame* readFrame(uint64_t& readSeq);
+
+    /**
+     * @brief fromSeq 이후 링에 남아 있는 가장 최근 키프레임의 순번을 찾는 메서드
+     * @param fromSeq 검색을 시작할 순번 (이 순번 이상만 검색)
+     * @param keySeq [out] 찾은 키프레임의 순번
+     * @return bool 키프레임을 찾았는지 여부
+     */
+    bool findLatestKeyframe(uint64_t fromSeq, uint64_t& keySeq) const;
+
+    /**
+     * @brief 다음에 들어올 프레임의 순번을 반환하는 메서드
+     * @return uint64_t 다음 순번
+     */
+    inline uint64_t getWriteSequence() const { return writeSeq; };
+
+    /**
+     * @brief 링을 비우는 메서드 (프레임 데이터 참조 해제)
+     */
+    void clear();
+
+private:
+    /**
+     * @brief 링에 남아 있는 가장 오래된 프레임의 순번
+     */
+    uint64_t OldestSequence() const;
+
+    std::vector<DataCaptureSharedFrame> slots; ///< 프레임 슬롯 (순번 % ring_size)
+    uint64_t writeSeq = 0;                     ///< 다음에 들어올 프레임 순번
+    uint64_t firstSeq = 0;                     ///< 링에 연속으로 들어 있는 첫 순번
+};
+
+#endif //RTSP_FRAMERING_H
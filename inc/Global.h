@@ -25,28 +25,39 @@
  */
 const int g_serverRtpPort = 8554;
 
+/**
+ * @brief 모든 세션이 공유하는 서버 RTP/RTCP UDP 포트 번호 (RFC 3551 기본값 5004/5005)
+ */
+const int g_serverMediaRtpPort = 5004;
+const int g_serverMediaRtcpPort = 5005;
+
 /**
  * @brief 현재 시간을 NTP(Network Time Protocol)타임스탬프 형식으로 반환하는 함수
- * @details 시스템 시간을 NTP 형식으로 변환하여 반환
+ * @details NTPClock의 단조 시계 기준점으로부터 계산한 NTP 시간을 반환
  *          상위 32비트: 1900년부터의 초 단위 시간
- *          하위 32비트: 초의 소수점 이하 부분
+ *          하위 32비트: 초의 소수점 이하 부분 (나노초 정밀도)
  * @return uint64_t NTP 타임스탬프 형식의 현재 시간
+ * @see NTPClock
  */
 uint64_t GetTime();
 
 /**
- * @brief 주어진 비트 수에 따라 랜덤 숫자를 생성하는 함수
- * @details 이 함수는 입력으로 받은 비트 수(n)에 따라 16비트 또는 32비트 범위의 랜덤 숫자를 생성하여 반환
- *          랜덤 시드 생성기를 사용하여 매 호출마다 새로운 랜덤 값을 생성
+ * @brief 예측할 수 없는 64비트 난수를 반환하는 함수
+ * @details 스레드마다 하나씩 두는 ChaCha20 키 스트림 생성기(CSPRNG)에서 값을 꺼내며, 잠금이나 시스템 호출이 없다.
+ *          생성기는 스레드에서 처음 호출할 때 getrandom(2)로 받은 256비트 키와 nonce로 초기화한다.
+ *          세션 ID, SSRC, 초기 시퀀스 번호처럼 외부에서 추측하면 안 되는 값에 사용
+ * @return uint64_t 64비트 난수
+ */
+uint64_t GetRandom64();
+
+/**
+ * @brief 주어진 비트 수에 따라 0이 아닌 랜덤 숫자를 생성하는 함수
+ * @details GetRandom64()의 하위 비트를 사용하며, 0이 나오면 다시 뽑는다.
  * @param n 생성할 랜덤 숫자의 비트 수. 16 또는 32만 지원
  * @return uint32_t 생성된 랜덤 숫자
- *         - n이 32일 경우: 0부터 2^32-1(0xFFFFFFFF) 범위의 랜덤 숫자
- *         - n이 16일 경우: 0부터 65535(2^16-1) 범위의 랜덤 숫자
+ *         - n이 32일 경우: 1부터 2^32-1(0xFFFFFFFF) 범위의 랜덤 숫자
+ *         - n이 16일 경우: 1부터 65535(2^16-1) 범위의 랜덤 숫자
  *         - n이 16 또는 32가 아닐 경우: 0을 반환
- * @note
- * - `std::random_device`는 랜덤 시드 값을 생성하는 데 사용
- * - `std::mt19937`는 Mersenne Twister 알고리즘을 기반으로 한 난수 생성기
- * - `std::uniform_int_distribution`은 지정된 범위 내에서 균등 분포를 가진 난수를 생성
  */
 uint32_t GetRanNum(int n);
 
@@ -65,6 +76,7 @@ uint32_t GetRanNum(int n);
  * - 이 함수는 IPv6 주소를 지원하지 않습니다. IPv4 주소만 반환
  * - `gethostbyname`는 오래된 함수로, 최신 시스템에서는 `getaddrinfo` 사용을 권장
  * - 함수 호출 중 오류가 발생하면 `perror`를 통해 에러 메시지가 출력
+ * - DNS 응답을 기다리며 블로킹될 수 있으므로 요청 처리 경로에서는 ClientSession::GetLocalIP()를 사용
  */
 std::string GetServerIP();
 
@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <cstddef>
 #include <cstdint>
@@ -30,6 +32,10 @@ constexpr uint8_t NALU_NRI_MASK = 0x60;     ///< NALU 중요도 관련 비트 
 constexpr uint8_t NALU_F_NRI_MASK = 0xE0;   ///< NALU 금지 비트와 참조 중요도 마스크
 constexpr uint8_t NALU_TYPE_MASK = 0x1F;    ///< NALU 타입 마스크
 
+constexpr uint8_t NALU_TYPE_IDR = 5;        ///< IDR 슬라이스 NALU 타입
+constexpr uint8_t NALU_TYPE_SPS = 7;        ///< SPS NALU 타입
+constexpr uint8_t NALU_TYPE_PPS = 8;        ///< PPS NALU 타입
+
 constexpr uint8_t FU_S_MASK = 0x80;         ///< FU 헤더 시작 비트 마스크
 constexpr uint8_t FU_E_MASK = 0x40;         ///< FU 헤더 끝 비트 마스크
 constexpr uint8_t SET_FU_A_MASK = 0x1C;     ///< FU 헤더 플래그 비트 마스크
@@ -53,10 +59,18 @@ private:
      */
     static const uint8_t *find_next_start_code(const uint8_t *_buffer, const int64_t buffer_len);
 
+    /**
+     * @brief 파일을 한 번 훑어 액세스 유닛(픽처) 색인을 만드는 메서드
+     * @details 생성자에서 호출하며, 이후 시간 이동과 키프레임 이동은 색인을 이진 탐색한다.
+     */
+    void build_index();
+
     uint8_t *ptr_mapped_file_cur = nullptr;     ///< 현재 매핑된 파일 위치 포인터
     uint8_t *ptr_mapped_file_start = nullptr;   ///< 매핑된 파일 시작 포인터 
     uint8_t *ptr_mapped_file_end = nullptr;     ///< 매핑된 파일 끝 포인터
     int64_t file_size = 0;                      ///< 파일 크기
+    std::vector<int64_t> access_units;          ///< 액세스 유닛 시작 위치 (파일 시작 기준, start code 포함, 오름차순)
+    std::vector<int64_t> random_access_units;   ///< IDR 슬라이스를 포함한 액세스 유닛 번호 (오름차순)
 
 public:
     /**
@@ -88,4 +102,100 @@ public:
      * - 두 번째 요소: 프레임 데이터의 크기 (바이트)
      */
     std::pair<const uint8_t *, int64_t> get_next_frame();
+
+    /**
+     * @brief NALU 헤더의 타입을 반환하는 정적 메서드
+     * @param _frame start code를 포함한 NAL 유닛
+     * @param frame_len NAL 유닛의 길이
+     * @return uint8_t NALU 타입 (0: 판별 불가)
+     */
+    static uint8_t get_nalu_type(const uint8_t *_frame, int64_t frame_len);
+
+    /**
+     * @brief Annex-B 버퍼에서 첫 SPS와 PPS를 찾는 정적 메서드
+     * @param _buffer start code로 구분된 NAL 유닛들 (인코더 extradata, 키프레임 패킷, 파일 앞부분 등)
+     * @param buffer_len 버퍼의 길이
+     * @param sps [out] SPS NAL 유닛 (start code 제외)
+     * @param pps [out] PPS NAL 유닛 (start code 제외)
+     * @return bool SPS와 PPS를 모두 찾았는지 여부
+     * @details 첫 슬라이스(VCL) NAL 유닛에서 검색을 멈추므로 키프레임 패킷 전체를 훑지 않는다.
+     */
+    static bool find_parameter_sets(const uint8_t *_buffer, int64_t buffer_len, std::string &sps, std::string &pps);
+
+    /**
+     * @brief 파일의 첫 SPS와 PPS를 반환하는 메서드
+     * @param sps [out] SPS NAL 유닛 (start code 제외)
+     * @param pps [out] PPS NAL 유닛 (start code 제외)
+     * @return bool SPS와 PPS를 모두 찾았는지 여부
+     */
+    bool get_parameter_sets(std::string &sps, std::string &pps) const;
+
+    /**
+     * @brief 파일 전체의 평균 비트레이트를 계산하는 메서드
+     * @param fps 재생 프레임 속도
+     * @return int64_t 평균 비트레이트 (bps, 픽처가 없으면 0)
+     * @details 액세스 유닛(픽처) 수로 재생 시간을 구한다.
+     */
+    int64_t estimate_bitrate(double fps) const;
+
+    /**
+     * @brief 파일의 재생 시간을 반환하는 메서드
+     * @param fps 재생 프레임 속도
+     * @return double 재생 시간 (초, 액세스 유닛 수 / fps)
+     */
+    double get_duration(double fps) const;
+
+    /**
+     * @brief 현재 위치가 속한 액세스 유닛 번호를 반환하는 메서드
+     * @return int64_t 액세스 유닛 번호 (0부터, 첫 액세스 유닛 앞이면 -1)
+     * @details 프레임마다 호출해도 되도록 색인을 이진 탐색한다. 번호가 바뀌면 새 픽처의 시작이다.
+     */
+    int64_t get_access_unit() const;
+
+    /**
+     * @brief 액세스 유닛 수를 반환하는 메서드
+     * @return int64_t 파일의 액세스 유닛(픽처) 수
+     */
+    int64_t get_access_unit_count() const { return static_cast<int64_t>(this->access_units.size()); }
+
+    /**
+     * @brief 액세스 유닛의 바이트 수를 반환하는 메서드
+     * @param unit 액세스 유닛 번호
+     * @return int64_t 액세스 유닛의 크기 (start code 포함, 번호가 범위를 벗어나면 0)
+     */
+    int64_t get_access_unit_size(int64_t unit) const;
+
+    /**
+     * @brief IDR 액세스 유닛을 찾는 메서드
+     * @param unit 기준 액세스 유닛 번호
+     * @param direction 양수: unit 다음의 첫 IDR, 음수: unit 이전의 마지막 IDR, 0: unit 이하의 마지막 IDR
+     * @return int64_t IDR 액세스 유닛 번호 (-1: 없음)
+     * @details IDR 색인을 이진 탐색한다. (O(log n))
+     */
+    int64_t find_random_access_unit(int64_t unit, int direction) const;
+
+    /**
+     * @brief 액세스 유닛의 시작으로 이동하는 메서드
+     * @param unit 액세스 유닛 번호
+     * @return bool 이동 성공 여부 (false: 번호가 범위를 벗어남)
+     */
+    bool seek_to_access_unit(int64_t unit);
+
+    /**
+     * @brief 주어진 재생 시각 이전의 가장 가까운 IDR 액세스 유닛으로 이동하는 메서드
+     * @param seconds 재생 시각 (초, 파일 시작 기준)
+     * @param fps 재생 프레임 속도
+     * @return double 이동한 위치의 재생 시각 (초, -1: 파일에 IDR이 없거나 seconds가 재생 시간을 넘음)
+     * @details IDR 색인을 이진 탐색하므로 O(log n)이며, 앞의 SPS/PPS를 포함한 액세스 유닛 시작으로 이동한다.
+     */
+    double seek_to_time(double seconds, double fps);
+
+    /**
+     * @brief 현재 위치 이후의 첫 디코딩 시작점으로 이동하는 메서드
+     * @details 현재 위치가 IDR 액세스 유닛의 시작이 아니면 다음 IDR 액세스 유닛으로 앞으로만 이동한다. (색인 이진 탐색)
+     *          뒤로 되감지 않으므로 같은 파일을 받는 다른 시청자의 재생 위치가 되돌아가지 않는다.
+     *          다음 get_next_frame() 호출은 해당 시작점부터 프레임을 반환
+     * @return bool 이동 성공 여부 (false: 현재 위치 뒤에 IDR이 없음, 위치는 그대로)
+     */
+    bool seek_to_keyframe();
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+/**
+ * @file IOBackend.h
+ * @brief RTP 패킷 일괄 전송 I/O 백엔드 클래스 헤더
+ * @details 한 프레임을 이루는 여러 RTP 패킷을 시스템 콜 한 번으로 전송하는 싱글톤 클래스
+ *          - 소켓 백엔드: sendmmsg (모든 커널에서 사용 가능한 기본값)
+ *          - io_uring 백엔드: 링크된 IORING_OP_SENDMSG를 한 번의 io_uring_enter로 제출
+ *          - 시작 시 선택하며, io_uring을 쓸 수 없는 커널에서는 소켓 백엔드로 대체
+ * 
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ * 
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_IOBACKEND_H
+#define RTSP_IOBACKEND_H
+
+#include <atomic>
+#include <cstdint>
+#include <sys/socket.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define RTSP_HAVE_IO_URING 1
+#else
+#define RTSP_HAVE_IO_URING 0
+#endif
+
+/**
+ * @enum IOBackendType
+ * @brief RTP 전송에 사용할 I/O 백엔드 종류
+ */
+enum IOBackendType {
+    eIOBackend_Socket,   ///< sendmmsg 기반 일괄 전송 (기본값)
+    eIOBackend_IoUring,  ///< io_uring 기반 일괄 전송
+};
+
+/**
+ * @class IOBackend
+ * @brief RTP 패킷 일괄 전송을 담당하는 싱글톤 클래스
+ * @details 선택된 백엔드로 mmsghdr 배열을 전송한다.
+ *          io_uring 링은 스레드마다 하나씩 만들어 SenderPool 워커끼리 잠금 없이 사용한다.
+ *          전송은 앞에서부터 순서대로 이루어지며, 하나가 실패하면 뒤의 패킷은 보내지 않는다.
+ */
+class IOBackend {
+public:
+    static const unsigned ring_entries = 64; ///< 스레드별 io_uring 제출 큐 크기 (한 번에 제출할 최대 패킷 수)
+
+    IOBackend(const IOBackend&) = delete;
+    IOBackend& operator=(const IOBackend&) = delete;
+
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return IOBackend& 싱글톤 인스턴스에 대한 참조
+     */
+    static IOBackend& GetInstance() {
+        static IOBackend instance;
+        return instance;
+    };
+
+    /**
+     * @brief 사용할 백엔드를 선택하는 메서드
+     * @param type 요청한 백엔드
+     * @return IOBackendType 실제로 선택된 백엔드 (io_uring을 쓸 수 없으면 eIOBackend_Socket)
+     * @details 서버 시작 시 한 번 호출한다. io_uring은 링 생성을 시험해 보고 실패하면 대체한다.
+     */
+    IOBackendType Init(IOBackendType type);
+
+    /**
+     * @brief 현재 선택된 백엔드를 반환하는 메서드
+     * @return IOBackendType 현재 백엔드
+     */
+    inline IOBackendType GetType() const { return type; };
+
+    /**
+     * @brief 여러 패킷을 한 번에 전송하는 메서드
+     * @param sockfd 전송할 소켓
+     * @param msgs 전송할 메시지 배열 (msg_len에 전송된 바이트 수 기록)
+     * @param count 메시지 수
+     * @param flags 전송 옵션 플래그 (MSG_DONTWAIT 등)
+     * @return int 앞에서부터 전송에 성공한 메시지 수 (-1: 첫 메시지부터 실패, errno 설정)
+     */
+    int SendMessages(int sockfd, struct mmsghdr* msgs, unsigned count, int flags);
+
+private:
+    IOBackend() = default;
+    ~IOBackend() = default;
+
+    /**
+     * @brief sendmmsg로 전송하는 메서드
+     */
+    int SendMessagesSocket(int sockfd, struct mmsghdr* msgs, unsigned count, int flags);
+
+    /**
+     * @brief 호출 스레드의 io_uring 링으로 전송하는 메서드
+     */
+    int SendMessagesIoUring(int sockfd, struct mmsghdr* msgs, unsigned count, int flags);
+
+    std::atomic<IOBackendType> type{eIOBackend_Socket}; ///< 현재 백엔드
+};
+
+#endif //RTSP_IOBACKEND_H
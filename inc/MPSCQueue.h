@@ -0,0 +1,101 @@
+/**
+ * @file MPSCQueue.h
+ * @brief 잠금 없는 다중 생산자/단일 소비자 큐 템플릿 헤더
+ * @details 여러 스레드가 넣고 한 스레드만 꺼내는 무제한 연결 리스트 큐 (Vyukov MPSC 큐)
+ *          - Push: 원자적 교환 한 번 (생산자끼리 잠금/재시도 없음)
+ *          - Pop: 소비자만 호출하며 원자적 연산 없이 읽기만 함
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_MPSCQUEUE_H
+#define RTSP_MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @class MPSCQueue
+ * @brief 잠금 없는 다중 생산자/단일 소비자 큐
+ * @tparam T 원소 타입 (기본 생성 가능하고 이동 가능해야 함)
+ * @details 생산자는 head를 새 노드로 교환한 뒤 이전 노드에 연결한다.
+ *          교환과 연결 사이에 있는 원소는 잠시 보이지 않을 수 있으므로, 생산자는 Push가 끝난 뒤 소비자를 깨워야 한다.
+ */
+template <typename T>
+class MPSCQueue {
+public:
+    MPSCQueue() : head(&stub), tail(&stub) {}
+
+    /**
+     * @brief 소멸자 - 남은 원소 해제 (생산자/소비자가 모두 멈춘 뒤에 호출)
+     */
+    ~MPSCQueue() {
+        T value;
+        while (Pop(value)) {}
+        if (tail != &stub) {
+            delete tail;
+        }
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    /**
+     * @brief 원소를 넣는 메서드 (여러 스레드에서 동시에 호출 가능)
+     * @param value 넣을 원소
+     */
+    void Push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief 원소를 꺼내는 메서드 (소비자 스레드만 호출)
+     * @param value [out] 꺼낸 원소
+     * @return bool 꺼냈는지 여부 (비어 있으면 false)
+     * @details 꺼낸 노드는 다음 Pop까지 더미 노드로 남고, 그 전의 더미 노드를 해제한다.
+     */
+    bool Pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(next->value);
+        next->value = T();
+        if (tail != &stub) {
+            delete tail;
+        }
+        tail = next;
+        return true;
+    }
+
+    /**
+     * @brief 큐가 비어 있는지 확인하는 메서드 (소비자 스레드만 호출)
+     * @return bool 꺼낼 원소가 없으면 true
+     */
+    bool Empty() const {
+        return tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    /**
+     * @struct Node
+     * @brief 큐 노드
+     */
+    struct Node {
+        std::atomic<Node*> next{nullptr}; ///< 다음 노드
+        T value;                          ///< 원소
+    };
+
+    std::atomic<Node*> head; ///< 마지막으로 넣은 노드 (생산자가 교환)
+    Node* tail;              ///< 더미 노드 (tail->next가 다음에 꺼낼 원소, 소비자만 접근)
+    Node stub;               ///< 처음 더미 노드
+};
+
+#endif //RTSP_MPSCQUEUE_H
@@ -15,8 +15,11 @@
 #define RTSP_MEDIASTREAMHANDLER_H
 
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cstdint>
 #include <alsa/asoundlib.h>
-#include <condition_variable>
 
 /**
  * @enum MediaStreamState
@@ -43,54 +46,209 @@ class RTPPacket;
  */
 class RTCPPacket;
 
+/** @class ClientSession
+ * @brief RTSP 클라이언트 세션 클래스
+ * @details 실제 구현은 ClientSession.h에 정의되어 있으며, interleaved 전송 시 TCP 연결로 미디어를 보냄
+ */
+class ClientSession;
+
+/** @class UDPHandler
+ * @brief 세션의 RTP/RTCP 목적지 관리 클래스
+ * @details 실제 구현은 UDPHandler.h에 정의되어 있음
+ */
+class UDPHandler;
+
+/** @class FrameRing
+ * @brief 송신 워커별 프레임 링 버퍼 클래스
+ * @details 실제 구현은 FrameRing.h에 정의되어 있음
+ */
+class FrameRing;
+
 /**
  * @class MediaStreamHandler
  * @brief 미디어 스트리밍 처리를 담당하는 클래스
  * @details 미디어 스트림의 상태 관리, RTP 패킷 생성 및 전송,
- *          스트리밍 제어 기능을 제공하는 클래스
+ *          스트리밍 제어 기능을 제공하는 클래스.
+ *          전용 스레드 없이 SenderPool 워커가 새 프레임마다 HandleMediaStream을 호출한다.
+ *          항상 shared_ptr로 만들며, UDPServer는 RTCP를 전달하는 동안 shared_from_this로 수명을 연장한다.
+ * @see SenderPool
  * @see UDPHandler
  * @see RTPPacket
  * @see RTCPPacket
  */
-class MediaStreamHandler {
+class MediaStreamHandler : public std::enable_shared_from_this<MediaStreamHandler> {
 public:
-    UDPHandler* udpHandler; ///< UDP 통신을 위한 핸들러  
+    UDPHandler* udpHandler = nullptr; ///< UDP 통신을 위한 핸들러 (핸들러가 소유, interleaved 전송 시 nullptr)
+    std::shared_ptr<ClientSession> clientSession; ///< 소속 RTSP 세션 (RTCP 수신 시 활동 기록, interleaved 전송 시 RTP/RTCP 전송)
 
     /**
      * @brief 생성자 - 스트림 핸들러 초기화
+     * @param track 전송할 트랙 번호 (페이로드 타입과 프레임 링을 정함)
+     */
+    explicit MediaStreamHandler(int track = 0);
+
+    /**
+     * @brief 소멸자 - RTCP 수신 테이블에서 핸들러 제거 및 UDPHandler 해제
      */
-    MediaStreamHandler();
+    ~MediaStreamHandler();
 
     /**
-     * @brief 미디어 스트림을 처리하는 메인 메서드
-     * @details 스트림의 상태에 따라 미디어 데이터를 처리하고 전송
+     * @brief 지금 보낼 수 있는 미디어 프레임을 모두 전송하는 메서드
+     * @param frames 세션을 소유한 워커의 프레임 링
+     * @details 재생 상태일 때 링 버퍼에서 이 세션의 읽기 순번 이후 프레임을 전송하고 바로 반환한다.
+     *          블로킹하지 않으며, 세션을 소유한 SenderPool 워커만 호출한다.
      */
-    void HandleMediaStream();
+    void HandleMediaStream(FrameRing& frames);
 
     /**
      * @brief 스트리밍 명령을 설정하는 메서드
      * @param cmd 설정할 명령 (PLAY, PAUSE, TEARDOWN)
+     * @details 상태만 바꾸는 O(1) 동작이며, 재생 재개는 SenderPool이 다음 작업에서 처리
      */
     void SetCmd(const std::string& cmd);
 
+    /**
+     * @brief 다음 재생의 시작 위치를 정하는 메서드 (PLAY 요청)
+     * @param seek true면 버퍼의 이전 프레임을 버리고 타임스탬프가 rtpTime 이후인 첫 키프레임부터 전송 (Range 이동)
+     * @param rtpTime 이동한 위치의 첫 프레임 RTP 타임스탬프
+     * @return uint16_t 다음에 보낼 RTP 패킷의 시퀀스 번호 (PLAY 응답 RTP-Info의 seq)
+     * @details 송신 워커가 프레임을 보내는 중이면 그 프레임을 다 보낼 때까지 기다리므로, 반환한 시퀀스 번호가 정확하다.
+     */
+    uint16_t Restart(bool seek, uint32_t rtpTime);
+
+    /**
+     * @brief 현재 스트림 상태를 반환하는 메서드
+     * @return MediaStreamState 현재 상태
+     */
+    inline MediaStreamState GetState() const { return streamState; };
+
+    /**
+     * @brief 전송하는 트랙 번호를 반환하는 메서드
+     * @return int 트랙 번호 (SenderPool 워커가 이 트랙의 프레임 링으로 HandleMediaStream 호출)
+     */
+    inline int GetTrack() const { return track; };
+
+    /**
+     * @brief interleaved 전송의 채널 번호를 설정하는 메서드 (SETUP에서 송신 풀에 등록하기 전에 호출)
+     * @param rtp RTP 채널 번호
+     * @param rtcp RTCP 채널 번호
+     */
+    inline void SetInterleavedChannels(int rtp, int rtcp) { rtpChannel = rtp; rtcpChannel = rtcp; };
+
+    /**
+     * @brief interleaved RTCP 채널 번호를 반환하는 메서드
+     * @return int RTCP 채널 번호 (클라이언트가 보낸 RTCP를 트랙에 분배할 때 사용)
+     */
+    inline int GetRTCPChannel() const { return rtcpChannel; };
+
+    /**
+     * @brief 이 스트림의 RTP SSRC를 반환하는 메서드
+     * @return uint32_t 세션마다 임의로 생성된 SSRC
+     */
+    inline uint32_t GetSSRC() const { return ssrc; };
+
+    /**
+     * @brief 새 임의의 SSRC로 바꾸는 메서드
+     * @details 다른 스트림과 SSRC가 겹칠 때 UDPServer가 등록하면서 호출한다. (SETUP 응답 전, 송신 시작 전에만 호출)
+     */
+    void RegenerateSSRC();
+
+    /**
+     * @brief UDPServer가 이 세션으로 분배한 RTCP 패킷을 처리하는 메서드
+     * @param data 수신한 RTCP 데이터
+     * @param dataLen 수신한 데이터 크기
+     * @details 세션 활동을 기록하고, PLI/FIR 피드백이 있으면 RTSPServer를 통해 키프레임을 요청
+     */
+    void OnRTCPPacket(const uint8_t* data, int64_t dataLen);
+
+    /**
+     * @brief 스트림 종료를 알리는 RTCP BYE를 전송하는 메서드
+     * @details 재생을 시작한 적이 있는 스트림만 전송하며, 송신 워커의 상태를 건드리지 않으므로 어느 스레드에서나 호출 가능
+     */
+    void SendBye();
+
+    /**
+     * @brief 느린 수신자 처리로 건너뛴 프레임 수를 반환하는 메서드
+     * @return uint64_t 링에서 밀려났거나 송신 큐가 가득 차서 보내지 않은 프레임 수
+     */
+    inline uint64_t GetSkippedFrames() const { return skippedFrames; };
+
+    /**
+     * @brief 세션을 소유한 SenderPool 워커 번호를 반환하는 메서드
+     * @return int 워커 번호 (풀에 등록되지 않았으면 -1)
+     */
+    inline int GetSenderShard() const { return senderShard; };
+
+    /**
+     * @brief 세션을 소유한 SenderPool 워커 번호를 설정하는 메서드 (SenderPool이 등록/제거 시 호출)
+     * @param shard 워커 번호 (-1: 없음)
+     */
+    inline void SetSenderShard(int shard) { senderShard = shard; };
+
 private:
-    bool threadRun = true;              ///< 스트림 실행 상태
-    MediaStreamState streamState;       ///< 현재 스트림 상태
-    std::mutex streamMutex;             ///< 스트림 동기화를 위한 뮤텍스
-    std::condition_variable condition;  ///< 스트림 상태 제어을 위한 조건 변수
+    static const int rtp_batch_size = 64;         ///< 한 번에 전송할 최대 RTP 패킷 수
+    static const int interleaved_prefix_size = 4; ///< interleaved 프레이밍 헤더 크기 ('$', 채널, 16비트 길이)
+    static const int drop_lag_frames = 8;         ///< 이 이상 밀리면 비참조 프레임을 버림
+    static const int skip_lag_frames = 24;        ///< 이 이상 밀리면 버퍼의 최신 키프레임으로 건너뜀
+
+    const int track;                         ///< 전송하는 트랙 번호
+    uint32_t ssrc;                           ///< RTP/RTCP 송신자 SSRC
+    int rtpChannel = 0;                      ///< interleaved RTP 채널 번호
+    int rtcpChannel = 1;                     ///< interleaved RTCP 채널 번호
+    std::atomic<MediaStreamState> streamState; ///< 현재 스트림 상태
+    std::atomic<uint64_t> skippedFrames{0};  ///< 느린 수신자 처리로 건너뛴 프레임 수
+    std::atomic<int> senderShard{-1};        ///< 세션을 소유한 SenderPool 워커 번호
+
+    /**
+     * @struct RTPBatch
+     * @brief 일괄 전송을 기다리는 RTP 패킷들의 헤더와 iovec (정의는 MediaStreamHandler.cpp)
+     */
+    struct RTPBatch;
+
+    // 아래 송신 상태는 세션을 소유한 SenderPool 워커가 sendMutex 아래에서 접근 (Restart만 다른 스레드에서 잠금)
+    std::mutex sendMutex;                    ///< 송신 상태 보호 뮤텍스 (워커끼리는 경합하지 않으며 PLAY 요청과만 경합)
+    std::unique_ptr<RTPPacket> rtpPacket;    ///< RTP 헤더 상태 (시퀀스 번호, 헤더 확장 유지)
+    std::unique_ptr<RTPBatch> rtpBatch;      ///< 프레임 단위 일괄 전송 버퍼
+    uint64_t readSeq = 0;                    ///< 링 버퍼 읽기 순번
+    bool playing = false;                    ///< 재생 시작 위치를 잡았는지 여부
+    bool waitKeyframe = true;                ///< 다음 키프레임까지 건너뛰는 중인지 여부
+    bool seekPending = false;                ///< Range 이동 후 seekTimestamp 이전 프레임을 버리는 중인지 여부
+    uint32_t seekTimestamp = 0;              ///< Range 이동한 위치의 첫 프레임 RTP 타임스탬프
+    unsigned int octetCount = 0;             ///< 전송한 페이로드 바이트 수 (RTCP SR)
+    unsigned int packetCount = 0;            ///< 전송한 프레임 수 (RTCP SR)
 
     /**
-     * @brief 오디오 스트림을 처리하는 메서드
+     * @brief 프레임을 RTP 패킷으로 나누어 전송하는 메서드
      * @param payload 전송할 페이로드 데이터
      * @param payloadSize 전송할 페이로드 데이터 크기
-     * @param rtpPacket RTP 패킷 객체
-     * @details 오디오 데이터를 MTU 크기에 따라 단일 또는 분할하여 RTP 패킷으로 생성하고 전송
+     * @details 프레임을 최대 데이터 크기에 따라 단일 또는 FU-A 분할 RTP 패킷으로 만들고,
+     *          프레임의 모든 패킷을 IOBackend로 한 번에 전송
+     * @return bool 모든 패킷 전송 성공 여부 (false: 송신 큐가 가득 차 나머지 조각을 버림)
+     */
+    bool SendFragmentedRTPPackets(const unsigned char* payload, size_t payloadSize);
+
+    /**
+     * @brief RTP 패킷 하나를 일괄 전송 버퍼에 추가하는 메서드
+     * @param prefix 헤더 뒤에 붙일 페이로드 헤더 (FU indicator/header, 없으면 nullptr)
+     * @param prefixSize 페이로드 헤더 크기
+     * @param data 페이로드 데이터 (복사하지 않고 프레임 버퍼를 그대로 가리킴)
+     * @param dataSize 페이로드 데이터 크기
+     * @param marker RTP 마커 비트
+     * @return bool 성공 여부 (버퍼가 가득 차 먼저 전송한 패킷이 실패하면 false)
+     */
+    bool QueueRTPPacket(const uint8_t* prefix, size_t prefixSize, const uint8_t* data, size_t dataSize, bool marker);
+
+    /**
+     * @brief 일괄 전송 버퍼의 RTP 패킷을 모두 전송하는 메서드
+     * @details UDP 세션은 IOBackend로, interleaved 세션은 RTSP TCP 연결에 writev 한 번으로 전송
+     * @return bool 모든 패킷 전송 성공 여부
      */
-    void SendFragmentedRTPPackets(unsigned char* payload, size_t payloadSize, RTPPacket& rtpPacket);
+    bool FlushRTPPackets();
 
     /**
-     * @brief 오디오 스트림을 처리하는 메서드
+     * @brief RTCP 패킷을 전송하는 메서드
      * @param rtcpPacket RTCP 패킷 객체
+     * @details interleaved 세션은 RTCP 채널로 TCP 연결에 전송
      */
     void SendRTCPPacket(RTCPPacket& rtcpPacket);
 };
@@ -0,0 +1,165 @@
+/**
+ * @file MulticastSender.h
+ * @brief UDP 멀티캐스트 송신 관리 클래스 헤더
+ * @details 같은 스트림을 보는 여러 클라이언트에게 패킷을 한 번만 보내는 멀티캐스트 송신자를 관리하는 클래스
+ *          - 멀티캐스트 그룹 주소/포트/TTL 설정
+ *          - 모든 멀티캐스트 시청자가 공유하는 트랙별 미디어 스트림 핸들러 관리
+ *          - 재생 중인 시청자 수(참조 카운트)로 송신 시작/정지
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_MULTICASTSENDER_H
+#define RTSP_MULTICASTSENDER_H
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+class ClientSession;
+class MediaStreamHandler;
+
+/**
+ * @class MulticastSender
+ * @brief 멀티캐스트 그룹으로 스트림을 한 번만 전송하는 싱글톤 클래스
+ * @details SETUP에서 multicast 전송을 요청한 클라이언트들은 이 클래스의 트랙별 핸들러를 공유한다.
+ *          트랙 N은 그룹 포트 rtpPort + 2N(RTCP는 +1)으로 전송한다.
+ *          첫 시청자가 PLAY 하면 SenderPool에서 송신을 시작하고, 마지막 시청자가 PAUSE/TEARDOWN 하거나
+ *          연결을 끊으면 송신을 멈춘다. 송신량과 CPU 사용량은 시청자 수와 무관하다.
+ * @see MediaStreamHandler
+ * @see SenderPool
+ */
+class MulticastSender {
+public:
+    MulticastSender(const MulticastSender&) = delete;
+    MulticastSender& operator=(const MulticastSender&) = delete;
+
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return MulticastSender& 싱글톤 인스턴스에 대한 참조
+     */
+    static MulticastSender& GetInstance() {
+        static MulticastSender instance;
+        return instance;
+    };
+
+    static const int default_ttl = 16; ///< 기본 멀티캐스트 TTL
+
+    /**
+     * @brief 멀티캐스트 그룹을 설정하는 메서드
+     * @param group 멀티캐스트 그룹 IPv4 주소 (224.0.0.0/4)
+     * @param rtpPort 0번 트랙의 그룹 RTP 포트 (짝수, RTCP는 rtpPort + 1, 다음 트랙은 2씩 증가)
+     * @param ttl 멀티캐스트 TTL (1~255)
+     * @return bool 설정 성공 여부 (잘못된 주소/포트/TTL이면 false)
+     * @details 첫 SETUP 전에 호출해야 하며, 설정하지 않으면 멀티캐스트 요청은 거부된다.
+     */
+    bool Configure(const std::string& group, int rtpPort, int ttl = default_ttl);
+
+    /**
+     * @brief 멀티캐스트 전송이 설정되었는지 반환하는 메서드
+     * @return bool 설정 여부
+     */
+    inline bool IsEnabled() const { return rtpPort > 0; };
+
+    /**
+     * @brief 멀티캐스트 그룹 주소를 반환하는 메서드
+     * @return const std::string& 그룹 주소
+     */
+    inline const std::string& GetGroup() const { return group; };
+
+    /**
+     * @brief 트랙의 그룹 RTP 포트를 반환하는 메서드
+     * @param track 트랙 번호
+     * @return int RTP 포트 (RTCP는 +1)
+     */
+    inline int GetRTPPort(int track = 0) const { return rtpPort + 2 * track; };
+
+    /**
+     * @brief 멀티캐스트 TTL을 반환하는 메서드
+     * @return int TTL
+     */
+    inline int GetTTL() const { return ttl; };
+
+    /**
+     * @brief 트랙의 공유 핸들러를 준비하는 메서드
+     * @param track 트랙 번호
+     * @return bool 성공 여부 (설정되지 않았거나 공유 소켓이 열려 있지 않으면 false)
+     * @details 트랙마다 처음 호출 시 그룹을 목적지로 하는 핸들러를 만들어 SenderPool에 등록한다.
+     *          시청자가 없으면 정지 상태, 이미 재생 중이면 바로 송신을 시작한다.
+     */
+    bool Prepare(int track = 0);
+
+    /**
+     * @brief 트랙 공유 스트림의 SSRC를 반환하는 메서드
+     * @param track 트랙 번호
+     * @return uint32_t SSRC (Prepare 전이면 0)
+     */
+    uint32_t GetSSRC(int track = 0);
+
+    /**
+     * @brief 재생을 시작한 시청자를 추가하는 메서드
+     * @details 시청자 수가 0에서 1이 되면 준비된 모든 트랙의 송신을 시작
+     */
+    void Join();
+
+    /**
+     * @brief 재생을 멈춘 시청자를 제거하는 메서드
+     * @details 시청자 수가 0이 되면 모든 트랙의 송신을 멈춤
+     */
+    void Leave();
+
+    /**
+     * @brief 모든 트랙의 공유 핸들러를 해제하는 메서드 (서버 종료 시)
+     * @details 그룹에 RTCP BYE를 보내고 SenderPool에서 제거한 뒤 시청자 수를 0으로 되돌린다.
+     *          설정은 유지되므로 서버를 다시 시작하면 다음 SETUP에서 핸들러를 새로 만든다.
+     */
+    void Reset();
+
+    /**
+     * @brief 트랙의 공유 스트림을 송신 중인지 반환하는 메서드
+     * @param track 트랙 번호
+     * @return bool 준비된 트랙이고 시청자가 있는지 여부 (시청자 수와 관계없이 그룹으로 한 번만 송신)
+     */
+    bool IsStreaming(int track);
+
+    /**
+     * @brief 현재 멀티캐스트 시청자 수를 반환하는 메서드
+     * @return int 재생 중인 시청자 수
+     */
+    int GetViewerCount();
+
+private:
+    /**
+     * @brief 생성자 - 핸들러가 해제될 때 사용하는 싱글톤들이 더 늦게 소멸되도록 먼저 생성
+     */
+    MulticastSender();
+
+    /**
+     * @brief 소멸자 - 공유 핸들러 해제
+     */
+    ~MulticastSender();
+
+    /**
+     * @struct TrackStream
+     * @brief 트랙 하나의 공유 스트림
+     */
+    struct TrackStream {
+        std::shared_ptr<ClientSession> session;      ///< 그룹 목적지 정보 (UDPHandler용)
+        std::shared_ptr<MediaStreamHandler> handler; ///< 모든 시청자가 공유하는 핸들러
+    };
+
+    std::mutex senderMutex;      ///< 설정/핸들러/시청자 수 보호 뮤텍스
+    std::string group;           ///< 멀티캐스트 그룹 주소
+    int rtpPort = 0;             ///< 0번 트랙의 그룹 RTP 포트 (0: 비활성)
+    int ttl = default_ttl;       ///< 멀티캐스트 TTL
+    int viewers = 0;             ///< 재생 중인 시청자 수
+    std::map<int, TrackStream> streams; ///< 트랙 번호별 공유 스트림
+};
+
+#endif //RTSP_MULTICASTSENDER_H
@@ -0,0 +1,88 @@
+/**
+ * @file NTPClock.h
+ * @brief 고해상도 NTP 벽시계 클래스 헤더
+ * @details CLOCK_MONOTONIC 나노초를 서버 시작 시점의 벽시계(NTP)에 한 번 고정하여
+ *          RTP/RTCP에서 사용하는 모든 시간을 일관되게 계산하는 클래스
+ *          - 32.32 고정소수점 NTP 타임스탬프 계산
+ *          - 클럭 레이트에 맞춘 RTP 타임스탬프 계산
+ *          - vDSO clock_gettime 사용으로 핫패스에서 시스템 콜 없음
+ * 
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ * 
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_NTPCLOCK_H
+#define RTSP_NTPCLOCK_H
+
+#include <cstdint>
+#include <time.h>
+
+constexpr uint64_t NTP_UNIX_EPOCH_OFFSET = 2208988800ULL; ///< 1900년(NTP)과 1970년(Unix) 기준점 차이 (초)
+constexpr uint64_t NS_PER_SEC = 1000000000ULL;            ///< 1초의 나노초 수
+
+/**
+ * @class NTPClock
+ * @brief 단조 증가 시계에 고정된 NTP 벽시계를 제공하는 싱글톤 클래스
+ * @details 생성 시 CLOCK_REALTIME과 CLOCK_MONOTONIC을 한 번 샘플링하여 기준점을 만들고,
+ *          이후에는 CLOCK_MONOTONIC만 읽어 기준점으로부터의 경과 시간으로 NTP/RTP 시간을 계산한다.
+ *          NTP 데몬이 벽시계를 조정해도 값이 뒤로 가거나 건너뛰지 않는다.
+ */
+class NTPClock {
+public:
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return NTPClock& 싱글톤 인스턴스에 대한 참조
+     */
+    static NTPClock& getInstance() {
+        static NTPClock instance;
+        return instance;
+    }
+
+    NTPClock(const NTPClock&) = delete;
+    NTPClock& operator=(const NTPClock&) = delete;
+
+    /**
+     * @brief 현재 단조 시계 값을 나노초 단위로 반환하는 메서드
+     * @return uint64_t CLOCK_MONOTONIC 나노초
+     */
+    static inline uint64_t GetMonotonicNs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+    }
+
+    /**
+     * @brief 현재 시간을 32.32 고정소수점 NTP 타임스탬프로 반환하는 메서드
+     * @return uint64_t 상위 32비트: 1900년부터의 초, 하위 32비트: 초의 소수부
+     */
+    inline uint64_t GetNTPTime() const { return ToNTPTime(GetMonotonicNs()); }
+
+    /**
+     * @brief 단조 시계 값을 32.32 고정소수점 NTP 타임스탬프로 변환하는 메서드
+     * @param monotonicNs 변환할 CLOCK_MONOTONIC 나노초
+     * @return uint64_t NTP 타임스탬프
+     */
+    uint64_t ToNTPTime(uint64_t monotonicNs) const;
+
+    /**
+     * @brief 단조 시계 값을 주어진 클럭 레이트의 RTP 타임스탬프로 변환하는 메서드
+     * @param monotonicNs 변환할 CLOCK_MONOTONIC 나노초
+     * @param clockRate RTP 클럭 레이트 (H264: 90000, Opus: 48000)
+     * @return uint32_t 기준점부터 경과한 RTP 틱 (32비트 랩어라운드)
+     */
+    uint32_t ToRTPTime(uint64_t monotonicNs, uint32_t clockRate) const;
+
+private:
+    /**
+     * @brief 생성자 - 벽시계와 단조 시계의 기준점 설정
+     */
+    NTPClock();
+
+    uint64_t anchorMonotonicNs; ///< 기준점의 CLOCK_MONOTONIC 나노초
+    uint64_t anchorNTPTime;     ///< 기준점의 NTP 타임스탬프 (32.32)
+};
+
+#endif //RTSP_NTPCLOCK_H
@@ -21,6 +21,18 @@
 #include <arpa/inet.h>
 #include "RTSPServer.h"
 
+/// RTCP 패킷 타입 및 피드백 메시지 관련 상수 정의
+constexpr uint8_t RTCP_PT_FIR_LEGACY = 192;  ///< RFC 2032 Full Intra Request
+constexpr uint8_t RTCP_PT_SR = 200;          ///< Sender Report
+constexpr uint8_t RTCP_PT_RR = 201;          ///< Receiver Report
+constexpr uint8_t RTCP_PT_BYE = 203;         ///< Goodbye
+constexpr uint8_t RTCP_PT_RTPFB = 205;       ///< Transport-Layer Feedback (RFC 4585)
+constexpr uint8_t RTCP_PT_PSFB = 206;        ///< Payload-Specific Feedback (RFC 4585)
+constexpr uint8_t RTCP_FMT_PLI = 1;          ///< Picture Loss Indication
+constexpr uint8_t RTCP_FMT_FIR = 4;          ///< Full Intra Request (RFC 5104)
+constexpr int64_t RTCP_HEADER_SIZE = 4;      ///< RTCP 공통 헤더 크기
+constexpr int64_t RTCP_BYE_COMPOUND_SIZE = 16; ///< 빈 RR + BYE compound 패킷 크기
+
 #pragma pack(1)  ///< 1바이트 정렬로 패딩 없이 메모리에 패킷 구조체 배치
 
 /**
@@ -34,12 +46,13 @@ class RTCPPacket
 public:
     /**
      * @brief RTCP 패킷 생성자
-     * @param timestamp RTP 타임스탬프
+     * @param ntpTime 보고 시점의 NTP 타임스탬프 (32.32)
+     * @param timestamp ntpTime과 같은 시점에 해당하는 RTP 타임스탬프
      * @param packetCount 전송된 패킷 수
      * @param octetCount 전송된 총 바이트 수
-     * @param payloadType 페이로드 타입 (H264 또는 OPUS)
+     * @param ssrc 송신자 SSRC (RTP 스트림과 동일한 값)
      */
-    RTCPPacket(const unsigned int timestamp, unsigned int packetCount, unsigned int octetCount, Protocol payloadType);
+    RTCPPacket(uint64_t ntpTime, const unsigned int timestamp, unsigned int packetCount, unsigned int octetCount, uint32_t ssrc);
 
     /**
      * @brief RTCP 패킷을 UDP 소켓으로 전송하는 메서드
@@ -51,6 +64,32 @@ public:
      */
     int64_t rtcp_sendto(int sockfd, int64_t _bufferLen, int flags, const sockaddr *to);
 
+    /**
+     * @brief 수신한 RTCP 패킷에 키프레임 요청(PLI/FIR)이 있는지 확인하는 정적 메서드
+     * @param data 수신한 RTCP 데이터 (compound 패킷 가능)
+     * @param dataLen 수신한 데이터의 크기
+     * @return bool PLI, FIR 또는 RFC 2032 FIR가 하나라도 포함되어 있으면 true
+     */
+    static bool HasKeyframeRequest(const uint8_t *data, int64_t dataLen);
+
+    /**
+     * @brief 수신한 RTCP 패킷이 가리키는 서버 측 미디어 SSRC를 찾는 정적 메서드
+     * @param data 수신한 RTCP 데이터 (compound 패킷 가능)
+     * @param dataLen 수신한 데이터의 크기
+     * @param ssrc [out] SR/RR 리포트 블록 또는 피드백 메시지의 미디어 소스 SSRC
+     * @return bool SSRC를 찾았는지 여부
+     */
+    static bool GetMediaSSRC(const uint8_t *data, int64_t dataLen, uint32_t &ssrc);
+
+    /**
+     * @brief 스트림 종료를 알리는 RTCP BYE compound 패킷을 만드는 정적 메서드
+     * @param ssrc 종료하는 송신자 SSRC
+     * @param out [out] 패킷을 기록할 버퍼 (RTCP_BYE_COMPOUND_SIZE 이상)
+     * @return int64_t 기록한 패킷 크기
+     * @details compound 패킷은 SR/RR로 시작해야 하므로 리포트 블록 없는 RR 뒤에 BYE를 붙임 (RFC 3550 6.1)
+     */
+    static int64_t WriteBye(uint32_t ssrc, uint8_t *out);
+
     /**
      * @brief 소멸자
      */
@@ -70,7 +109,7 @@ private:
 #endif
     uint8_t pt;              ///< 패킷 타입 (200: Sender Report)
     uint16_t length;         ///< 패킷 길이
-    uint32_t ssrc;           ///< 동기화 소스 식별자
+    uint32_t senderSsrc;     ///< 동기화 소스 식별자
     uint32_t ntpTimestampMsw; ///< NTP 타임스탬프 MSW
     uint32_t ntpTimestampLsw; ///< NTP 타임스탬프 LSW
     uint32_t rtpTimestamp;    ///< RTP 타임스탬프
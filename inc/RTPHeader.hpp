@@ -28,11 +28,19 @@ constexpr int64_t RTP_VERSION = 2;               ///< RTP 버전
 constexpr int64_t RTP_PAYLOAD_TYPE_H264 = 96;    ///< H264 페이로드 타입
 constexpr int64_t FU_SIZE = 2;                   ///< Fragmentation Unit 크기
 
+/// RFC 8285 one-byte 헤더 확장 관련 상수
+constexpr uint16_t RTP_EXT_ONE_BYTE_PROFILE = 0xBEDE;  ///< one-byte 헤더 확장 프로파일 식별자
+constexpr uint8_t RTP_EXT_ID_ABS_SEND_TIME = 1;        ///< abs-send-time 확장 ID (SDP extmap과 동일)
+constexpr uint8_t RTP_EXT_ID_TRANSPORT_SEQ = 2;        ///< transport-wide 시퀀스 번호 확장 ID (SDP extmap과 동일)
+constexpr int64_t RTP_EXT_ABS_SEND_TIME_SIZE = 3;      ///< abs-send-time 데이터 크기 (6.18 고정소수점 초)
+constexpr int64_t RTP_EXT_TRANSPORT_SEQ_SIZE = 2;      ///< transport-wide 시퀀스 번호 데이터 크기
+constexpr int64_t RTP_EXTENSION_SIZE = 12;             ///< 확장 헤더(4) + abs-send-time(1+3) + transport seq(1+2) + 패딩(1)
+
 /// 최대 패킷 크기 관련 상수
 constexpr int64_t MAX_UDP_PACKET_SIZE = 65535;   ///< UDP 최대 패킷 크기
 constexpr int64_t MAX_RTP_DATA_SIZE = MAX_UDP_PACKET_SIZE - IP_V4_HEADER_SIZE
-                                     - UDP_HEADER_SIZE - RTP_HEADER_SIZE - FU_SIZE;  ///< RTP 최대 데이터 크기
-constexpr int64_t MAX_RTP_PACKET_LEN = MAX_RTP_DATA_SIZE + RTP_HEADER_SIZE + FU_SIZE;  ///< RTP 최대 패킷 길이
+                                     - UDP_HEADER_SIZE - RTP_HEADER_SIZE - RTP_EXTENSION_SIZE - FU_SIZE;  ///< RTP 최대 데이터 크기
+constexpr int64_t MAX_RTP_PACKET_LEN = MAX_RTP_DATA_SIZE + RTP_HEADER_SIZE + FU_SIZE;  ///< RTP 최대 패킷 길이 (헤더 확장 제외)
 
 
 #pragma pack(1) ///< 1바이트 정렬로 패딩 없이 메모리에 헤더 구조체를 배치
@@ -114,6 +122,18 @@ public:
      */
     inline void set_marker(const bool _marker){ _marker? marker |= 0x01 : marker &= ~0x01; };
 
+    /**
+     * @brief 확장 비트 설정 (RTP 헤더의 X 비트)
+     * @param _extension 확장 비트 값 (true: 고정 헤더 뒤에 헤더 확장이 붙음)
+     */
+    inline void set_extension(const bool _extension) { extension = _extension ? 1 : 0; };
+
+    /**
+     * @brief 확장 비트 반환
+     * @return bool 헤더 확장 사용 여부
+     */
+    inline bool has_extension() const { return extension != 0; };
+
     /**
      * @brief 페이로드 타입 설정
      * @param _payloadType 새로운 페이로드 타입
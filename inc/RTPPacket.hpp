@@ -6,6 +6,7 @@
 *          - RTP 헤더와 페이로드 관리
 *          - 데이터 페이로드 설정
 *          - UDP 소켓을 통한 패킷 전송
+*          - RFC 8285 헤더 확장 (abs-send-time, transport-wide 시퀀스 번호)
  * 
  * @organization rtspMediaStream
  * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
@@ -34,6 +35,15 @@ class RTPPacket
 private:
     RTPHeader header;
     uint8_t RTP_Payload[FU_SIZE + MAX_RTP_DATA_SIZE]{0}; ///< RTP 페이로드 버퍼
+    uint8_t RTP_Extension[RTP_EXTENSION_SIZE]{0};        ///< one-byte 헤더 확장 버퍼 (전송 시점에 값 기록)
+    uint16_t transportSeq = 0;                           ///< transport-wide 시퀀스 번호 (전송한 패킷마다 증가)
+
+    /**
+     * @brief 헤더 확장에 전송 시점의 값을 기록하는 메서드
+     * @details abs-send-time은 NTP 시간의 6.18 고정소수점 초 하위 24비트,
+     *          transport-wide 시퀀스 번호는 이 트랜스포트에서 보낸 패킷 순번
+     */
+    void stamp_extension();
 
 public:
     /**
@@ -65,14 +75,36 @@ public:
    /**
     * @brief UDP 소켓을 통해 RTP 패킷을 전송하는 메서드
     * @param sockfd UDP 소켓 디스크립터
-    * @param _bufferLen 전송할 버퍼의 크기
+    * @param _bufferLen 전송할 버퍼의 크기 (RTP 고정 헤더 + 페이로드, 헤더 확장 제외)
     * @param flags 전송 옵션 플래그
     * @param to 수신자 주소 정보
     * @return int64_t 전송된 바이트 수
-    * @details 패킷 전송 후 시퀀스 번호를 자동으로 증가시킴
+    * @details 패킷 전송 후 시퀀스 번호를 자동으로 증가시킴.
+    *          헤더 확장이 켜져 있으면 고정 헤더와 페이로드 사이에 확장을 끼워 함께 전송
     */
     int64_t rtp_sendto(int sockfd, int64_t _bufferLen, int flags, const sockaddr *to);
 
+    /**
+     * @brief 현재 RTP 헤더(헤더 확장 포함)를 버퍼에 기록하는 메서드
+     * @param out 기록할 버퍼 (최소 RTP_HEADER_SIZE + RTP_EXTENSION_SIZE 바이트)
+     * @return int64_t 기록한 헤더 길이
+     * @details 페이로드를 복사하지 않고 패킷마다 헤더만 만들어 일괄 전송할 때 사용하며,
+     *          rtp_sendto와 같이 기록 후 시퀀스 번호를 자동으로 증가시킴
+     */
+    int64_t write_header(uint8_t *out);
+
+    /**
+     * @brief 헤더 확장 사용 여부를 설정하는 메서드
+     * @param enable true: abs-send-time/transport-wide 시퀀스 번호 확장을 모든 패킷에 기록 (기본값)
+     */
+    void set_header_extension(bool enable) { header.set_extension(enable); }
+
+    /**
+     * @brief 다음 패킷에 기록될 transport-wide 시퀀스 번호를 반환하는 메서드
+     * @return uint16_t transport-wide 시퀀스 번호
+     */
+    uint16_t get_transport_seq() const { return this->transportSeq; }
+
     /**
      * @brief RTP 헤더 참조를 반환하는 메서드
      * @details RTPPakcet에 설정된 RTPHeader의 참조를 가져온다.
@@ -0,0 +1,228 @@
+/**
+ * @file RTSPRequest.h
+ * @brief RTSP 요청 파서 클래스 헤더
+ * @details 요청 문자열을 복사하지 않고 한 번만 훑어서 요청 줄과 헤더를 string_view로 나누는 파서
+ *          - 고정 크기 헤더 테이블 (힙 할당 없음)
+ *          - 헤더 이름은 대소문자 구분 없이 비교
+ *          - CSeq, Transport, Session, Range, Scale, Speed 헤더는 파싱할 때 타입이 있는 값으로 해석
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_RTSPREQUEST_H
+#define RTSP_RTSPREQUEST_H
+
+#include <string_view>
+#include <cstddef>
+
+/**
+ * @struct RTSPTransport
+ * @brief Transport 헤더의 첫 번째 전송 방식 (RFC 2326 12.39)
+ */
+struct RTSPTransport {
+    bool present = false;         ///< Transport 헤더가 있었는지 여부
+    bool tcp = false;             ///< RTP/AVP/TCP 요청 여부 (interleaved 전송)
+    bool multicast = false;       ///< multicast 파라미터 여부
+    bool rtcpMux = false;         ///< RTCP-mux 파라미터 여부 (RFC 5761)
+    int clientRTPPort = -1;       ///< client_port의 RTP 포트 (-1: 없음)
+    int clientRTCPPort = -1;      ///< client_port의 RTCP 포트 (포트를 하나만 보내면 RTP 포트와 같음)
+    int rtpChannel = -1;          ///< interleaved의 RTP 채널 (-1: 없음)
+    int rtcpChannel = -1;         ///< interleaved의 RTCP 채널 (채널을 하나만 보내면 다음 번호)
+    bool invalidChannel = false;  ///< interleaved 값이 0~255 범위를 벗어났는지 여부
+};
+
+/**
+ * @struct RTSPSessionHeader
+ * @brief Session 헤더 (세션 ID와 timeout 파라미터)
+ */
+struct RTSPSessionHeader {
+    bool present = false;  ///< Session 헤더가 있었는지 여부
+    std::string_view id;   ///< 세션 ID 문자열 (요청 문자열을 가리킴)
+    int timeout = -1;      ///< timeout 파라미터 (초, -1: 없음)
+};
+
+/**
+ * @struct RTSPRange
+ * @brief Range 헤더의 npt 범위 (RFC 2326 3.6)
+ */
+struct RTSPRange {
+    bool present = false;   ///< Range 헤더가 있었는지 여부
+    bool valid = false;     ///< npt 형식으로 해석했는지 여부 (smpte/clock 등은 false)
+    bool now = false;       ///< 시작이 "now"인지 여부
+    bool hasStart = false;  ///< 시작 시각이 있는지 여부
+    bool hasEnd = false;    ///< 끝 시각이 있는지 여부
+    double start = 0.0;     ///< 시작 시각 (초)
+    double end = 0.0;       ///< 끝 시각 (초)
+};
+
+/**
+ * @class RTSPRequest
+ * @brief 한 번 훑어서 요청 줄과 헤더를 나누는 RTSP 요청 파서
+ * @details 모든 결과는 Parse에 넘긴 문자열을 가리키므로, 그 문자열이 살아 있는 동안만 유효하다.
+ *          헤더 테이블이 가득 차면 나머지 헤더는 테이블에 넣지 않지만 CSeq/Transport/Session/Range/Scale/Speed는 계속 해석한다.
+ *          같은 헤더가 여러 번 오면 GetHeader와 타입 헤더 모두 처음 것을 사용한다.
+ */
+class RTSPRequest {
+public:
+    static const size_t max_headers = 32; ///< 헤더 테이블에 보관하는 최대 헤더 수
+
+    /**
+     * @struct Header
+     * @brief 헤더 이름과 값 (앞뒤 공백 제외)
+     */
+    struct Header {
+        std::string_view name;  ///< 헤더 이름
+        std::string_view value; ///< 헤더 값
+    };
+
+    /**
+     * @brief 요청을 파싱하는 메서드
+     * @param text RTSP 요청 하나 (헤더와 본문, CRLF와 LF 줄바꿈 모두 허용. FindMessageLength로 자른 길이)
+     * @return bool 요청 줄이 "메서드 URI 버전" 형식인지 여부
+     * @details 이전 파싱 결과는 지워진다. 공백으로 시작하는 줄은 앞 헤더 값의 연속으로 처리한다.
+     */
+    bool Parse(std::string_view text);
+
+    /**
+     * @brief 입력 버퍼 앞에 있는 RTSP 메시지 하나의 길이를 구하는 정적 메서드
+     * @param input 연결의 입력 버퍼 (메시지 시작 위치부터)
+     * @param maxSize 허용하는 최대 메시지 크기 (헤더 + 본문)
+     * @return long 헤더와 Content-Length만큼의 본문을 합친 길이
+     *              (0: 아직 다 도착하지 않음, -1: Content-Length가 잘못되었거나 maxSize를 넘음)
+     * @details 헤더 끝은 빈 줄(CRLF CRLF, LF LF 모두 허용)이며 Content-Length가 없으면 본문이 없는 것으로 본다.
+     *          요청과 응답 모두에 사용할 수 있고, 전체를 파싱하지 않고 Content-Length 헤더만 찾는다.
+     */
+    static long FindMessageLength(std::string_view input, size_t maxSize);
+
+    /**
+     * @brief 메서드를 반환하는 메서드
+     * @return std::string_view RTSP 메서드 (예: "SETUP")
+     */
+    std::string_view GetMethod() const { return method; }
+
+    /**
+     * @brief 요청 URI를 반환하는 메서드
+     * @return std::string_view 요청 URI
+     */
+    std::string_view GetURI() const { return uri; }
+
+    /**
+     * @brief 프로토콜 버전을 반환하는 메서드
+     * @return std::string_view 프로토콜 버전 (예: "RTSP/1.0")
+     */
+    std::string_view GetVersion() const { return version; }
+
+    /**
+     * @brief 본문을 반환하는 메서드
+     * @return std::string_view 헤더 끝(빈 줄) 다음부터 Parse에 넘긴 문자열 끝까지 (없으면 빈 값)
+     */
+    std::string_view GetBody() const { return body; }
+
+    /**
+     * @brief 헤더 값을 찾는 메서드
+     * @param name 헤더 이름 (대소문자 구분 없음)
+     * @return std::string_view 헤더 값 (없으면 빈 값)
+     */
+    std::string_view GetHeader(std::string_view name) const;
+
+    /**
+     * @brief 헤더가 있는지 확인하는 메서드
+     * @param name 헤더 이름 (대소문자 구분 없음)
+     * @return bool 헤더 존재 여부
+     */
+    bool HasHeader(std::string_view name) const;
+
+    /**
+     * @brief 헤더 테이블에 보관한 헤더 수를 반환하는 메서드
+     * @return size_t 헤더 수 (max_headers 이하)
+     */
+    size_t GetHeaderCount() const { return headerCount; }
+
+    /**
+     * @brief 헤더 테이블의 헤더를 반환하는 메서드
+     * @param index 헤더 순번 (GetHeaderCount() 미만)
+     * @return const Header& 헤더
+     */
+    const Header& GetHeaderAt(size_t index) const { return headers[index]; }
+
+    /**
+     * @brief CSeq 값을 반환하는 메서드
+     * @return int CSeq 값 (-1: 없거나 숫자가 아님)
+     */
+    int GetCSeq() const { return cseq; }
+
+    /**
+     * @brief Transport 헤더를 반환하는 메서드
+     * @return const RTSPTransport& 해석한 Transport 헤더
+     */
+    const RTSPTransport& GetTransport() const { return transport; }
+
+    /**
+     * @brief Session 헤더를 반환하는 메서드
+     * @return const RTSPSessionHeader& 해석한 Session 헤더
+     */
+    const RTSPSessionHeader& GetSession() const { return session; }
+
+    /**
+     * @brief Range 헤더를 반환하는 메서드
+     * @return const RTSPRange& 해석한 Range 헤더
+     */
+    const RTSPRange& GetRange() const { return range; }
+
+    /**
+     * @brief Scale 헤더 값을 반환하는 메서드 (RFC 2326 12.34)
+     * @return double 재생 배율 (음수: 역방향, 0: 없거나 숫자가 아님)
+     */
+    double GetScale() const { return scale; }
+
+    /**
+     * @brief Speed 헤더 값을 반환하는 메서드 (RFC 2326 12.35)
+     * @return double 전송 속도 배율 (0: 없거나 양수가 아님)
+     */
+    double GetSpeed() const { return speed; }
+
+    /**
+     * @brief Accept 헤더가 미디어 타입을 수락하는지 확인하는 메서드
+     * @param mediaType 미디어 타입 (예: "application/sdp")
+     * @return bool 수락 여부 (대소문자 구분 없음, 와일드카드 포함. Accept 헤더가 없으면 false)
+     */
+    bool Accepts(std::string_view mediaType) const;
+
+    /**
+     * @brief 대소문자 구분 없이 두 문자열을 비교하는 정적 메서드
+     * @param a 비교할 문자열
+     * @param b 비교할 문자열
+     * @return bool ASCII 대소문자를 무시하고 같은지 여부
+     */
+    static bool EqualsIgnoreCase(std::string_view a, std::string_view b);
+
+private:
+    /**
+     * @brief CSeq/Transport/Session/Range/Scale/Speed 헤더면 타입이 있는 값으로 해석하는 메서드
+     * @param header 헤더
+     */
+    void ParseTypedHeader(const Header& header);
+
+    static void ParseTransport(std::string_view value, RTSPTransport& out);
+    static void ParseSession(std::string_view value, RTSPSessionHeader& out);
+    static void ParseRange(std::string_view value, RTSPRange& out);
+
+    std::string_view method;         ///< 메서드
+    std::string_view uri;            ///< 요청 URI
+    std::string_view version;        ///< 프로토콜 버전
+    std::string_view body;           ///< 본문
+    Header headers[max_headers];     ///< 헤더 테이블
+    size_t headerCount = 0;          ///< 헤더 테이블에 보관한 헤더 수
+    int cseq = -1;                   ///< CSeq 값
+    RTSPTransport transport;         ///< Transport 헤더
+    RTSPSessionHeader session;       ///< Session 헤더
+    RTSPRange range;                 ///< Range 헤더
+    double scale = 0.0;              ///< Scale 헤더 (0: 없음)
+    double speed = 0.0;              ///< Speed 헤더 (0: 없음)
+};
+
+#endif //RTSP_RTSPREQUEST_H
@@ -4,7 +4,7 @@
  * @details RTSP 프로토콜을 지원하는 미디어 스트리밍 서버의 핵심 기능을 제공하는 클래스
  *          - 싱글톤 패턴을 사용한 서버 인스턴스 관리
  *          - 클라이언트 연결 및 세션 관리
- *          - 프로토콜 타입(H264/Opus) 관리
+ *          - 트랙별 프로토콜 타입(H264/Opus) 관리 (오디오/비디오를 한 프레젠테이션으로 제공)
  * 
  * @organization rtspMediaStream
  * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
@@ -15,7 +15,15 @@
 
 #ifndef __RTSPSERVER_H__
 #define __RTSPSERVER_H__
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "IOBackend.h"
+#include "AdmissionControl.h"
 
 /**
  * @class FFmpegEncoder
@@ -25,6 +33,13 @@
  */
 class FFmpegEncoder;
 
+/**
+ * @class EventLoop
+ * @brief RTSP 제어 연결을 감시하는 epoll 이벤트 루프
+ * @details 실제 구현은 EventLoop.{h,cpp}에 정의됨
+ */
+class EventLoop;
+
 /**
  * @enum Protocol
  * @brief 지원하는 미디어 프로토콜 타입
@@ -53,8 +68,24 @@ private:
      * @return bool 루트 권한 실행 여부
      */
     bool isRunningAsRoot();
+
+    /**
+     * @brief 대기 중인 클라이언트 연결을 모두 수락하여 이벤트 루프에 등록하는 메서드
+     * @param loop 연결을 처리할 이벤트 루프 (리스닝 소켓을 감시하는 루프)
+     * @param listenSocket 연결을 수락할 리스닝 소켓
+     * @details 리스닝 소켓이 읽기 가능할 때 해당 이벤트 루프 스레드에서 호출된다.
+     */
+    void acceptConnections(EventLoop* loop, int listenSocket);
     
-    Protocol protocol;   ///< 현재 설정된 프로토콜 타입
+    std::vector<Protocol> tracks; ///< 트랙별 프로토콜 타입 (인덱스가 트랙 번호, SDP a=control:trackID=N)
+    IOBackendType ioBackend = eIOBackend_Socket; ///< RTP 전송에 사용할 I/O 백엔드
+    int listenerCount = 0;  ///< 리스닝 소켓/이벤트 루프 수 (0: 온라인 코어 수)
+    int listenBacklog = 0;  ///< 리스닝 소켓별 listen 대기열 크기 (0: SOMAXCONN)
+    int latencyProbeUs = 0; ///< 역할별 스케줄링 지연 측정 주기 (0: 측정 스레드 없음)
+    double duration = 0.0;  ///< 재생 시간 (초, 0: 라이브 스트림)
+    std::atomic<bool> initEventFired{false}; ///< 초기화 이벤트를 이미 발생시켰는지 여부
+    std::atomic<bool> running{false};        ///< 서버 실행 여부 (startServerThread ~ stop)
+    std::vector<std::unique_ptr<EventLoop>> eventLoops; ///< 리스닝 소켓 하나와 그 소켓으로 들어온 제어 연결을 처리하는 이벤트 루프들
 
 public:
     /**
@@ -73,18 +104,222 @@ public:
     int startServerThread();
 
     /**
-     * @brief 현재 설정된 프로토콜을 반환하는 메서드
-     * @return Protocol 현재 프로토콜 타입
+     * @brief 서버를 종료하는 메서드
+     * @details 리스닝 소켓을 닫고, 모든 세션에 RTCP BYE를 보낸 뒤 연결을 끊고, 서버가 만든 스레드를 모두 join 하여
+     *          메모리를 해제한다. 모든 스레드는 깨우기 신호로 바로 종료되므로 기다림은 실행 중인 작업 하나로 제한된다.
+     *          종료 후 startServerThread로 같은 프로세스에서 다시 시작할 수 있다.
+     */
+    void stop();
+
+    /**
+     * @brief 서버가 실행 중인지 반환하는 메서드
+     * @return bool 실행 여부
      */
-    inline Protocol getProtocol() { return protocol; };
+    inline bool isRunning() { return running; };
 
     /**
-     * @brief 프로토콜 타입을 설정하는 메서드
+     * @brief 첫 번째 트랙의 프로토콜을 반환하는 메서드
+     * @return Protocol 0번 트랙의 프로토콜 타입
+     */
+    inline Protocol getProtocol() { return getTrackProtocol(0); };
+
+    /**
+     * @brief 트랙 하나짜리 프레젠테이션의 프로토콜 타입을 설정하는 메서드
      * @param _protocol 설정할 프로토콜 타입
+     * @details 이전에 추가한 트랙을 모두 지우고 0번 트랙만 남긴다. (startServerThread 전에 호출)
+     */
+    void setProtocol(Protocol _protocol) { tracks.assign(1, _protocol); };
+
+    /**
+     * @brief 프레젠테이션에 트랙을 추가하는 메서드
+     * @param _protocol 트랙의 프로토콜 타입
+     * @return int 추가한 트랙 번호 (소스는 DataCapture::getInstance(트랙 번호)에 프레임을 기록, 실패 시 -1)
+     * @details 예: 비디오와 오디오를 한 세션으로 보내려면 addTrack(PROTO_H264), addTrack(PROTO_OPUS)
+     *          트랙마다 SDP에 m= 줄과 a=control:trackID=N이 생기고, 클라이언트는 트랙마다 SETUP 한 뒤 한 번에 PLAY 한다.
+     *          립싱크를 위해 각 소스는 프레임 타임스탬프를 NTPClock::ToRTPTime(시각, 트랙 클럭)으로 만든다.
+     *          최대 DataCapture::max_tracks개까지 추가할 수 있다. (startServerThread 전에 호출)
+     */
+    int addTrack(Protocol _protocol);
+
+    /**
+     * @brief 트랙 수를 반환하는 메서드
+     * @return int 프레젠테이션의 트랙 수
+     */
+    inline int getTrackCount() const { return (int)tracks.size(); };
+
+    /**
+     * @brief 트랙의 프로토콜을 반환하는 메서드
+     * @param track 트랙 번호
+     * @return Protocol 트랙의 프로토콜 타입 (없는 트랙이면 PROTO_H264)
+     */
+    Protocol getTrackProtocol(int track) const;
+
+    /**
+     * @brief RTP 전송에 사용할 I/O 백엔드를 설정하는 메서드
+     * @param _ioBackend 사용할 백엔드 (startServerThread 전에 호출)
+     * @details 환경 변수 RTSP_IO_BACKEND=io_uring|sendmmsg가 있으면 그 값이 우선한다.
+     *          io_uring을 쓸 수 없는 커널에서는 sendmmsg로 대체된다.
+     */
+    void setIOBackend(IOBackendType _ioBackend) { ioBackend = _ioBackend; };
+
+    /**
+     * @brief SO_REUSEPORT 리스닝 소켓 수를 설정하는 메서드
+     * @param count 리스닝 소켓 수 (소켓마다 이벤트 루프 스레드 하나, 0: 온라인 코어 수, startServerThread 전에 호출)
+     */
+    void setListenerCount(int count) { listenerCount = count; };
+
+    /**
+     * @brief 리스닝 소켓의 listen 대기열 크기를 설정하는 메서드
+     * @param backlog 대기열 크기 (0: SOMAXCONN, 실제 값은 net.core.somaxconn으로 제한됨, startServerThread 전에 호출)
+     */
+    void setListenBacklog(int backlog) { listenBacklog = backlog; };
+
+    /**
+     * @brief UDP 멀티캐스트 전송을 설정하는 메서드
+     * @param group 멀티캐스트 그룹 IPv4 주소 (예: 239.255.0.1)
+     * @param port 그룹 RTP 포트 (짝수, RTCP는 port + 1)
+     * @param ttl 멀티캐스트 TTL (기본값 16)
+     * @return bool 설정 성공 여부
+     * @details 설정하면 rtsp://주소:포트/multicast 의 SDP가 그룹 주소를 알리고, SETUP에서 RTP/AVP;multicast 요청을 받는다.
+     *          기본 프레젠테이션 URL의 SDP는 그대로 유니캐스트를 알린다.
+     *          스트림은 시청자 수와 관계없이 그룹으로 한 번만 전송된다. (startServerThread 전에 호출)
+     *          시청자의 RTCP는 세션 활동으로 기록되지 않으므로, 시청자는 SETUP 응답의 timeout= 안에
+     *          RTSP keepalive(GET_PARAMETER, OPTIONS)를 보내야 한다.
+     */
+    bool setMulticast(const std::string& group, int port, int ttl = 16);
+
+    /**
+     * @brief 활성 소스에 키프레임(IDR)을 요청하는 메서드
+     * @param track 키프레임이 필요한 트랙 번호 (H264 트랙만 요청을 전달)
+     * @details PLAY 요청 또는 RTCP PLI/FIR 피드백 수신 시 호출된다.
+     *          다음 키프레임이 나오기 전까지 들어온 요청은 트랙별로 하나로 병합되어 onKeyframeEvent를 한 번만 호출
+     */
+    void requestKeyframe(int track = 0);
+
+    /**
+     * @brief 스트림의 H264 SPS/PPS를 설정하는 메서드
+     * @param sps SPS NAL 유닛 (start code 제외)
+     * @param pps PPS NAL 유닛 (start code 제외)
+     * @param track H264 트랙 번호
+     * @details 스트림 소스가 인코더 extradata나 파일 앞부분에서 읽어 호출하며, DESCRIBE 응답의 SDP에
+     *          profile-level-id와 sprop-parameter-sets로 알려 클라이언트가 첫 키프레임 전에 디코더를 설정하게 한다.
+     *          같은 값으로 다시 호출하면 아무것도 하지 않으므로 키프레임마다 호출해도 된다.
+     */
+    void setH264ParameterSets(const std::string& sps, const std::string& pps, int track = 0);
+
+    /**
+     * @brief 스트림 비트레이트를 설정하는 메서드
+     * @param kbps 평균(또는 목표) 비트레이트 (kbps, 0: 알 수 없음)
+     * @param track 트랙 번호
+     * @details 트랙의 SDP m= 줄 아래 b=AS 줄로 알린다.
+     */
+    void setBitrate(int kbps, int track = 0);
+
+    /**
+     * @brief 스트림 재생 시간을 설정하는 메서드
+     * @param seconds 재생 시간 (초, 0: 라이브 스트림)
+     * @details SDP의 a=range 줄과 PLAY 응답의 Range 헤더 끝 시각으로 알린다. onSeekEvent와 함께 파일 소스가 설정한다.
+     */
+    void setDuration(double seconds);
+
+    /**
+     * @brief 재생 시간을 반환하는 메서드
+     * @return double 재생 시간 (초, 0: 라이브 스트림)
+     */
+    inline double getDuration() const { return duration; };
+
+    /**
+     * @brief 소스의 재생 위치를 옮기는 메서드
+     * @param npt [in] 요청한 시작 시각, [out] 실제 시작 시각 (초)
+     * @param rtpTime [out] 시작 위치의 첫 프레임 RTP 타임스탬프 (PLAY 응답 RTP-Info의 rtptime)
+     * @return bool 이동 성공 여부 (false: onSeekEvent가 없거나 범위를 벗어남)
+     * @details PLAY 요청의 Range 헤더를 받으면 호출되며, onSeekEvent를 그대로 호출한다.
+     *          rtpTime은 0번 트랙의 타임스탬프이다.
+     */
+    bool seek(double& npt, uint32_t& rtpTime);
+
+    /**
+     * @brief 소스의 재생 배율과 전송 속도를 바꾸는 메서드
+     * @param scale [in] 요청한 재생 배율 (Scale, 음수: 역방향), [out] 적용한 배율
+     * @param speed [in] 요청한 전송 속도 배율 (Speed), [out] 적용한 속도
+     * @param npt [out] 다시 시작하는 위치 (초, 현재 위치 이전의 가장 가까운 IDR)
+     * @param rtpTime [out] 다시 시작하는 위치의 첫 프레임 RTP 타임스탬프
+     * @return bool 변경 성공 여부 (false: onRateEvent가 없음)
+     * @details PLAY 요청의 Scale/Speed 헤더를 받으면 호출되며, onRateEvent를 그대로 호출한다.
+     */
+    bool changeRate(double& scale, double& speed, double& npt, uint32_t& rtpTime);
+
+    /**
+     * @brief 첫 SETUP에서 초기화 이벤트를 발생시키는 메서드
+     * @details 소스(캡처/파일 읽기) 스레드는 세션과 무관하게 하나만 있어야 하므로 onInitEvent는 한 번만 호출된다.
+     */
+    void fireInitEvent();
+
+    /**
+     * @brief 세션 타임아웃을 설정하는 메서드
+     * @param sec 타임아웃 (초, SETUP 응답의 Session 헤더로 알림)
+     * @details 타임아웃 동안 RTSP 요청(GET_PARAMETER keepalive 포함)이나 RTCP가 없는 세션은 정리된다.
+     *          SETUP을 하지 않은 연결도 같은 시간 동안 요청이 없으면 끊는다.
+     */
+    void setSessionTimeout(int sec);
+
+    /**
+     * @brief 최대 동시 세션 수를 설정하는 메서드
+     * @param count 최대 세션 수 (0: 제한 없음)
+     * @details 넘으면 새 세션의 SETUP을 503 Service Unavailable과 Retry-After로 거부한다.
+     *          환경 변수 RTSP_MAX_SESSIONS가 있으면 시작할 때 그 값이 우선한다.
+     */
+    void setMaxSessions(int count);
+
+    /**
+     * @brief 서버 전체 최대 송신 비트레이트를 설정하는 메서드
+     * @param kbps 최대 송신 비트레이트 (kbps, 0: 제한 없음)
+     * @details SETUP/PLAY 때 재생 중인 스트림의 실측 비트레이트 합에 새 스트림을 더해 넘으면 453 Not Enough Bandwidth로 거부한다.
+     *          환경 변수 RTSP_MAX_EGRESS_KBPS가 있으면 시작할 때 그 값이 우선한다.
+     */
+    void setMaxEgressBitrate(int kbps);
+
+    /**
+     * @brief 송신 워커 최대 CPU 사용률을 설정하는 메서드
+     * @param percent 송신 워커 코어 대비 최대 사용률 (1~100 %, 0: 제한 없음)
+     * @details 넘으면 새 세션과 새 스트림의 재생을 503 Service Unavailable과 Retry-After로 거부한다.
+     *          환경 변수 RTSP_MAX_SENDER_CPU가 있으면 시작할 때 그 값이 우선한다.
+     */
+    void setMaxSenderCpu(int percent);
+
+    /**
+     * @brief 수락 제어 통계를 반환하는 메서드
+     * @return AdmissionStats 세션 수, 송신 비트레이트, 송신 CPU 사용률과 예산, 거부 횟수
+     */
+    AdmissionStats getAdmissionStats();
+
+    /**
+     * @brief 스레드 역할별 CPU 친화도와 실시간 우선순위를 설정하는 메서드
+     * @param spec "역할=CPU목록[:정책[:우선순위]]"을 ';'로 이은 문자열 (역할: capture, encode, sender, control)
+     *             예: 오디오 캡처를 3번 코어에 고정하고 인코더가 침범하지 않게 하려면 "capture=3:fifo:80;encode=1-2;sender=0;control=0"
+     * @return bool 문법 오류 없이 설정했는지 여부
+     * @details 이미 실행 중인 스레드에도 바로 적용된다. 환경 변수 RTSP_THREAD_POLICY가 있으면 시작할 때 그 값이 우선한다.
+     *          sender 역할의 CPU 수는 송신 워커 수가 된다. 실시간 정책은 root 또는 CAP_SYS_NICE가 필요하다.
+     */
+    bool setThreadPolicy(const std::string& spec);
+
+    /**
+     * @brief 역할별 스케줄링 지연 측정 스레드를 설정하는 메서드
+     * @param intervalUs 측정 주기 (마이크로초, 0: 사용 안 함, startServerThread 전에 호출)
+     * @details 환경 변수 RTSP_LATENCY_PROBE_US가 있으면 그 값이 우선한다.
+     *          측정 결과는 서버 종료 시 역할별로 출력되며 ThreadRegistry::GetLatencyStats로도 볼 수 있다.
      */
-    void setProtocol(Protocol _protocol) { protocol = _protocol; };
+    void setLatencyProbe(int intervalUs) { latencyProbeUs = intervalUs; };
 
-    std::function<void()> onInitEvent;  ///< 초기화 이벤트 콜백 함수
+    std::function<void()> onInitEvent;      ///< 초기화 이벤트 콜백 함수 (첫 SETUP에서 한 번 호출)
+    std::function<void()> onStopEvent;      ///< 서버 종료 이벤트 콜백 함수 (onInitEvent로 시작한 소스 스레드를 멈추도록 등록)
+    std::function<void()> onKeyframeEvent;  ///< 키프레임 요청 이벤트 콜백 함수 (소스가 다음 프레임을 IDR로 만들도록 등록, H264 트랙 요청만 전달)
+    /// 재생 위치 이동 이벤트 콜백 함수 (파일처럼 위치를 옮길 수 있는 소스만 등록)
+    /// 요청 시각 이전의 가장 가까운 IDR로 이동하고, 실제 시각과 그 프레임의 RTP 타임스탬프를 채워 true 반환
+    std::function<bool(double& npt, uint32_t& rtpTime)> onSeekEvent;
+    /// 재생 배율/전송 속도 변경 이벤트 콜백 함수 (Scale/Speed, 위치를 옮길 수 있는 소스만 등록)
+    /// 지원하는 범위로 맞춘 값을 적용하고, 현재 위치 이전의 가장 가까운 IDR에서 다시 시작하여 그 시각과 RTP 타임스탬프를 채워 true 반환
+    std::function<bool(double& scale, double& speed, double& npt, uint32_t& rtpTime)> onRateEvent;
 };
 
 #endif // __RTSPSERVER_H__
\ No newline at end of file
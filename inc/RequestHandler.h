@@ -14,16 +14,21 @@
 #ifndef RTSP_REQUESTHANDLER_H
 #define RTSP_REQUESTHANDLER_H
 
+#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include "AdmissionControl.h"
 class ClientSession;
 class MediaStreamHandler;
+class RTSPRequest;
 
 /**
  * @class RequestHandler
  * @brief RTSP 요청 처리 클래스
  * @details 클라이언트로부터 받은 RTSP 요청을 파싱하고 처리하며,
  *          적절한 응답(OPTIONS, DESCRIBE, SETUP, PLAY, PAUSE, TEARDOWN)을 생성하는 기능을 제공한다.
+ *          트랙마다 SETUP 한 스트림은 한 세션에 묶이며, PLAY/PAUSE/TEARDOWN은 세션 URL로 모든 트랙에 한 번에 적용한다.
  * @related MediaStreamHandler
  * @related ClientSession
  */
@@ -37,90 +42,201 @@ public:
     RequestHandler(ClientSession* session);
 
     /**
-     * @brief 함수 호출 연산자 오버로딩
-     * @details 요청 처리를 위한 HandleRequest 메서드 호출
+     * @brief 제어 연결에 도착한 데이터를 처리하는 메서드
+     * @details 이벤트 루프가 소켓이 읽기 가능할 때 호출한다. 도착한 바이트를 입력 버퍼에 모으고
+     *          완성된 요청(헤더와 Content-Length만큼의 본문)마다 HandleRequest를 호출하며, 블로킹하지 않는다.
+     * @return bool 연결 유지 여부 (false: 연결을 닫아야 함)
      */
-    void operator()() { HandleRequest(); }
+    bool OnReadable();
 
     /**
-     * @brief RTSP 요청을 처리하는 메인 메서드
+     * @brief 제어 연결이 쓰기 가능할 때 남은 응답/미디어 데이터를 보내는 메서드
+     * @details 이벤트 루프가 EPOLLOUT에서 호출한다. (출력 버퍼에 보내지 못한 데이터가 있을 때만 감시)
+     * @return bool 연결 유지 여부 (false: 연결을 닫아야 함)
      */
-    void HandleRequest();
+    bool OnWritable();
 
     /**
-     * @brief 요청 처리를 위한 스레드를 시작하는 메서드
+     * @brief 완성된 RTSP 요청 하나를 처리하는 메서드
+     * @param text 헤더와 본문을 포함한 RTSP 요청 하나 (입력 버퍼를 가리키며 호출 중에만 유효)
+     * @return bool 연결 유지 여부 (false: TEARDOWN 또는 잘못된 요청)
      */
-    void StartThread();
+    bool HandleRequest(std::string_view text);
+
+    /**
+     * @brief 제어 연결을 닫는 메서드
+     * @details 세션 테이블과 송신 풀에서 세션을 제거하고 소켓을 닫는다. interleaved 송신 중인 워커와 겹치지 않도록
+     *          ClientSession의 쓰기 잠금 아래에서 닫으므로, 닫힌 번호를 재사용한 다른 연결로 미디어가 새지 않는다.
+     */
+    void Close();
 
 private:
+    static const size_t max_request_size = 64 * 1024; ///< 요청 하나(헤더 + 본문)의 최대 크기 (한 번의 읽기 이벤트에서 읽는 최대 크기)
+    static const size_t max_input_size = max_request_size + 4 + 65535; ///< 처리하지 못하고 남은 입력의 최대 크기 (요청 하나 + interleaved 프레임 하나)
+    static const int max_session_id_retries = 16;     ///< 세션 ID가 겹칠 때 다시 생성하는 최대 횟수
+    static const size_t response_buffer_reserve = 1024; ///< 응답 버퍼의 처음 용량 (SDP를 포함한 DESCRIBE 응답 크기)
+
+    /**
+     * @struct TrackStream
+     * @brief 세션에서 SETUP 한 트랙 하나
+     */
+    struct TrackStream {
+        std::shared_ptr<MediaStreamHandler> handler; ///< Related to @ref MediaStreamHandler (SenderPool과 공유, 멀티캐스트 트랙은 nullptr)
+        std::string uri;                             ///< SETUP 요청 URI (PLAY 응답 RTP-Info의 url)
+        bool playing = false;                        ///< 재생 중인 유니캐스트 스트림으로 수락 제어에 기록되었는지 여부
+    };
+
     std::shared_ptr<ClientSession> session; ///< Related to @ref ClientSession
-    MediaStreamHandler *mediaStreamHandler; ///< Related to @ref MediaStreamHandler
+    std::map<int, TrackStream> streams;     ///< 트랙 번호별 스트림 (RTP-Info를 트랙 순서로 만듦)
+    std::string inputBuffer;                ///< 아직 완성되지 않은 요청을 모아두는 연결별 입력 버퍼
+    std::string responseBuffer;             ///< 응답을 만드는 연결별 버퍼 (용량을 유지하며 재사용)
+    bool multicast = false;                 ///< 멀티캐스트 전송으로 SETUP 했는지 여부 (모든 트랙이 같은 전송 방식)
+    bool multicastJoined = false;           ///< 멀티캐스트 시청자로 재생 중인지 여부 (MulticastSender 참조 카운트)
+    bool rateChanged = false;               ///< PLAY의 Scale/Speed로 소스 재생 배율을 1배가 아닌 값으로 바꿨는지 여부
 
     /**
-     * @brief RTSP 메서드를 파싱하는 메서드
-     * @param request RTSP 요청 문자열
-     * @return std::string 파싱된 RTSP 메서드
+     * @brief OPTIONS 요청을 처리하는 메서드
+     * @param cseq 요청의 CSeq 값
      */
-    std::string ParseMethod(const std::string& request);
+    void HandleOptionsRequest(const int cseq);
 
     /**
-     * @brief CSeq 값을 파싱하는 메서드
-     * @param request RTSP 요청 문자열
-     * @return int 파싱된 CSeq 값 (-1: 파싱 실패)
+     * @brief DESCRIBE 요청을 처리하는 메서드
+     * @param request 파싱한 RTSP 요청
+     * @param cseq 요청의 CSeq 값
      */
-    int ParseCSeq(const std::string& request);
+    void HandleDescribeRequest(const RTSPRequest& request, const int cseq);
 
     /**
-     * @brief RTP/RTCP 포트를 파싱하는 메서드
-     * @param request RTSP 요청 문자열
-     * @return std::pair<int, int> RTP와 RTCP 포트 번호 쌍
+     * @brief SETUP 요청을 처리하는 메서드
+     * @param request 파싱한 RTSP 요청
+     * @param cseq 요청의 CSeq 값
      */
-    std::pair<int, int> ParsePorts(const std::string& request);
+    void HandleSetupRequest(const RTSPRequest& request, const int cseq);
 
     /**
-     * @brief Accept 헤더를 파싱하는 메서드
-     * @param request RTSP 요청 문자열
-     * @return bool SDP 수락 여부
+     * @brief RTP/AVP/TCP interleaved 전송의 SETUP 요청을 처리하는 메서드
+     * @param track 트랙 번호
+     * @param channels RTP/RTCP 채널 번호 쌍
+     * @param cseq 요청의 CSeq 값
      */
-    bool ParseAccept(const std::string& request);
+    void HandleInterleavedSetup(int track, const std::pair<int, int>& channels, const int cseq);
 
     /**
-     * @brief OPTIONS 요청을 처리하는 메서드
+     * @brief 멀티캐스트 전송의 SETUP 요청을 처리하는 메서드
+     * @param track 트랙 번호
      * @param cseq 요청의 CSeq 값
+     * @details 멀티캐스트가 설정되지 않았으면 461 Unsupported Transport로 응답
      */
-    void HandleOptionsRequest(const int cseq);
+    void HandleMulticastSetup(int track, const int cseq);
 
     /**
-     * @brief DESCRIBE 요청을 처리하는 메서드
-     * @param request RTSP 요청 문자열
+     * @brief 트랙을 SETUP 하기 전에 이전 스트림을 정리하는 메서드
+     * @param track SETUP 할 트랙 번호
+     * @param multicastSetup 멀티캐스트 전송으로 SETUP 하는지 여부
+     * @details 같은 트랙을 다시 SETUP 하면 그 트랙만, 전송 방식(유니캐스트/멀티캐스트)이 바뀌면 모든 트랙을 해제
+     */
+    void PrepareTrackSetup(int track, bool multicastSetup);
+
+    /**
+     * @brief 트랙 하나의 스트림을 해제하는 메서드
+     * @param track 해제할 트랙 번호
+     */
+    void ReleaseTrack(int track);
+
+    /**
+     * @brief 수락 제어로 거부한 요청에 응답하는 메서드
+     * @param result 수락 검사 결과 (eAdmission_NoBandwidth: 453, eAdmission_SourceShared: 455, eAdmission_Busy: 503 + Retry-After)
      * @param cseq 요청의 CSeq 값
+     * @param withSession 응답에 Session 헤더를 넣을지 여부 (이미 만들어진 세션의 요청)
      */
-    void HandleDescribeRequest(const std::string& request, const int cseq);
+    void RejectAdmission(AdmissionResult result, int cseq, bool withSession);
 
     /**
-     * @brief SETUP 요청을 처리하는 메서드
-     * @param request RTSP 요청 문자열
+     * @brief 요청의 Session 헤더가 이 연결의 세션을 가리키는지 확인하는 메서드
+     * @param request 파싱한 RTSP 요청
+     * @param cseq 요청의 CSeq 값
+     * @return bool 거부했는지 여부 (세션을 찾지 못하면 454 응답 후 true)
+     */
+    bool RejectSession(const RTSPRequest& request, int cseq);
+
+    /**
+     * @brief 트랙 URL로 세션 전체에 대한 요청을 보냈는지 확인하는 메서드
+     * @param request 파싱한 RTSP 요청
+     * @param cseq 요청의 CSeq 값
+     * @return bool 거부했는지 여부 (여러 트랙을 SETUP 한 세션에 트랙 URL로 보낸 요청이면 460 응답 후 true)
+     */
+    bool RejectTrackOperation(const RTSPRequest& request, int cseq);
+
+    /**
+     * @brief 멀티캐스트 시청을 멈추는 메서드 (PAUSE, TEARDOWN, 연결 종료)
+     */
+    void LeaveMulticast();
+
+    /**
+     * @brief 세션 테이블에 등록하고 SETUP 응답의 Session 헤더를 응답 버퍼에 추가하는 메서드
+     * @return bool 등록 성공 여부 (false: 새 ID로 다시 시도해도 모두 다른 세션과 겹침, 헤더를 추가하지 않음)
+     * @details "Session: id;timeout=N" 줄을 추가
+     */
+    bool AppendSetupSessionHeader();
+
+    /**
+     * @brief 세션 테이블에 등록하지 못한 SETUP을 되돌리고 503으로 응답하는 메서드
+     * @param cseq 요청의 CSeq 값
+     */
+    void RejectSessionSetup(int cseq);
+
+    /**
+     * @brief 응답 버퍼에 상태 줄과 CSeq 헤더를 쓰는 메서드
+     * @param status 상태 코드와 이유 문구 (예: "200 OK")
+     * @param cseq 요청의 CSeq 값
+     */
+    void BeginResponse(const char* status, int cseq);
+
+    /**
+     * @brief 응답 버퍼에 "Session: id" 헤더를 추가하는 메서드
+     */
+    void AppendSessionHeader();
+
+    /**
+     * @brief 응답 버퍼의 헤더를 끝내고 본문과 함께 전송하는 메서드
+     * @param body 본문 (Content-Length 헤더는 호출자가 추가)
+     */
+    void SendResponse(std::string_view body = std::string_view());
+
+    /**
+     * @brief 세션의 미디어 스트림을 모두 해제하는 메서드
+     * @details 전송 방식을 바꿔 다시 SETUP 하거나 연결이 끊길 때 모든 트랙의 송신 핸들러와 멀티캐스트 시청을 정리
+     */
+    void ReleaseMediaStream();
+
+    /**
+     * @brief GET_PARAMETER/SET_PARAMETER 요청(keepalive)을 처리하는 메서드
      * @param cseq 요청의 CSeq 값
      */
-    void HandleSetupRequest(const std::string& request, const int cseq);
+    void HandleParameterRequest(int cseq);
 
     /**
      * @brief PLAY 요청을 처리하는 메서드
+     * @param request 파싱한 RTSP 요청 (Range, Scale, Speed 헤더)
      * @param cseq 요청의 CSeq 값
      */
-    void HandlePlayRequest(int cseq);
+    void HandlePlayRequest(const RTSPRequest& request, int cseq);
 
     /**
      * @brief PAUSE 요청을 처리하는 메서드
+     * @param request 파싱한 RTSP 요청 (요청 URI)
      * @param cseq 요청의 CSeq 값
      */
-    void HandlePauseRequest(int cseq);
+    void HandlePauseRequest(const RTSPRequest& request, int cseq);
 
     /**
      * @brief TEARDOWN 요청을 처리하는 메서드
+     * @param request 파싱한 RTSP 요청 (요청 URI)
      * @param cseq 요청의 CSeq 값
+     * @return bool 세션이 끝났는지 여부 (false: 트랙 URL로 트랙 하나만 해제하고 나머지 트랙은 유지)
      */
-    void HandleTeardownRequest(int cseq);
+    bool HandleTeardownRequest(const RTSPRequest& request, int cseq);
 };
 
 #endif //RTSP_REQUESTHANDLER_H
@@ -0,0 +1,173 @@
+/**
+ * @file SDPCache.h
+ * @brief DESCRIBE 응답의 SDP 캐시 클래스 헤더
+ * @details 스트림 설정과 서버 주소(클라이언트가 접속한 인터페이스)마다 SDP 본문을 미리 만들어 두는 싱글톤 클래스
+ *          - 트랙 구성, 멀티캐스트 설정, 트랙별 코덱 파라미터(H264 SPS/PPS, 비트레이트)와 재생 시간이 바뀌었을 때만 다시 생성
+ *          - DESCRIBE마다 호스트 이름 조회(DNS)나 문자열 조립을 하지 않음
+ *          - 멀티캐스트 SDP는 별도의 프레젠테이션 URL(rtsp://주소:포트/multicast)로만 알림
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_SDPCACHE_H
+#define RTSP_SDPCACHE_H
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <string_view>
+#include <cstdint>
+
+/**
+ * @struct SDPDescription
+ * @brief 한 서버 주소에 대해 만들어 둔 DESCRIBE 응답 내용
+ */
+struct SDPDescription {
+    std::string sdp;          ///< SDP 본문
+    std::string contentBase;  ///< Content-Base 헤더 값 (rtsp://주소:포트/)
+};
+
+/**
+ * @class SDPCache
+ * @brief 서버 주소별 SDP를 캐시하는 싱글톤 클래스
+ * @details Get()은 현재 스트림 설정을 캐시를 만들 때의 설정과 비교하여 같으면 만들어 둔 SDP를 그대로 반환한다.
+ *          반환한 SDP는 공유 포인터이므로 다른 스레드가 다시 만들어도 응답을 보내는 동안 유효하다.
+ *          SDP의 o= 세션 ID는 서버마다 하나이며, 다시 만들 때마다 버전이 올라간다. (RFC 4566 5.2)
+ */
+class SDPCache {
+public:
+    SDPCache(const SDPCache&) = delete;
+    SDPCache& operator=(const SDPCache&) = delete;
+
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return SDPCache& 싱글톤 인스턴스에 대한 참조
+     */
+    static SDPCache& GetInstance() {
+        static SDPCache instance;
+        return instance;
+    };
+
+    static constexpr std::string_view multicast_path = "multicast"; ///< 멀티캐스트 프레젠테이션 URL 경로
+
+    /**
+     * @brief 서버 주소에 맞는 SDP를 반환하는 메서드
+     * @param serverIP 클라이언트가 접속한 서버 IPv4 주소 (제어 연결의 getsockname 주소)
+     * @param multicast 멀티캐스트 프레젠테이션 여부 (true: 그룹 주소/포트와 multicast_path Content-Base)
+     * @return std::shared_ptr<const SDPDescription> SDP와 Content-Base
+     * @details 유니캐스트 SDP는 멀티캐스트 설정과 관계없이 서버 주소와 포트 0을 알린다.
+     *          멀티캐스트 SDP는 멀티캐스트가 설정되어 있을 때만 요청해야 한다.
+     */
+    std::shared_ptr<const SDPDescription> Get(const std::string& serverIP, bool multicast = false);
+
+    /**
+     * @brief H264 트랙의 SPS/PPS를 설정하는 메서드
+     * @param sps SPS NAL 유닛 (start code 제외)
+     * @param pps PPS NAL 유닛 (start code 제외)
+     * @param track 트랙 번호
+     * @details fmtp의 profile-level-id와 sprop-parameter-sets(RFC 6184 8.1)에 사용하며, 값이 바뀌었을 때만 SDP를 다시 만든다.
+     */
+    void SetH264ParameterSets(const std::string& sps, const std::string& pps, int track);
+
+    /**
+     * @brief 트랙 비트레이트를 설정하는 메서드
+     * @param kbps 비트레이트 (kbps, 0: 알 수 없음, b=AS 줄 생략)
+     * @param track 트랙 번호
+     */
+    void SetBitrate(int kbps, int track);
+
+    /**
+     * @brief 설정한 트랙 비트레이트를 반환하는 메서드
+     * @param track 트랙 번호
+     * @return int 비트레이트 (kbps, 0: 알 수 없음)
+     */
+    int GetBitrate(int track);
+
+    /**
+     * @brief 스트림 재생 시간을 설정하는 메서드
+     * @param seconds 재생 시간 (초, 0: 라이브 스트림, a=range 줄 생략)
+     * @details a=range:npt=0-재생시간 (RFC 2326 C.1.5)으로 알려 클라이언트가 Range 이동을 할 수 있게 한다.
+     */
+    void SetDuration(double seconds);
+
+    /**
+     * @brief 모든 SDP를 다음 Get()에서 다시 만들도록 하는 메서드
+     * @details Get()이 직접 비교하지 않는 스트림 파라미터(코덱 설정 등)가 바뀌었을 때 호출
+     */
+    void Invalidate();
+
+private:
+    /**
+     * @struct StreamParams
+     * @brief SDP에 들어가는 스트림 설정 (바뀌었는지 비교용)
+     */
+    struct StreamParams {
+        std::vector<int> tracks;    ///< 트랙별 RTSPServer 프로토콜
+        std::string multicastGroup; ///< 멀티캐스트 그룹 주소 (설정하지 않았으면 빈 값)
+        int multicastPort = 0;      ///< 멀티캐스트 RTP 포트
+        int multicastTTL = 0;       ///< 멀티캐스트 TTL
+        uint64_t generation = 0;    ///< 코덱 파라미터/재생 시간 변경과 Invalidate 횟수
+
+        bool operator==(const StreamParams& other) const {
+            return tracks == other.tracks && multicastGroup == other.multicastGroup
+                && multicastPort == other.multicastPort && multicastTTL == other.multicastTTL
+                && generation == other.generation;
+        }
+    };
+
+    /**
+     * @struct Entry
+     * @brief 서버 주소 하나의 캐시 항목
+     */
+    struct Entry {
+        StreamParams params;                              ///< 만들 때의 스트림 설정
+        std::shared_ptr<const SDPDescription> description; ///< 만들어 둔 SDP
+    };
+
+    /**
+     * @struct TrackParams
+     * @brief 소스가 알려준 트랙 하나의 코덱 파라미터
+     */
+    struct TrackParams {
+        std::string h264SPS;  ///< H264 SPS (start code 제외)
+        std::string h264PPS;  ///< H264 PPS (start code 제외)
+        int bitrateKbps = 0;  ///< b=AS 비트레이트 (0: 알 수 없음)
+    };
+
+    /**
+     * @brief 생성자 - 서버 SDP 세션 ID 생성
+     */
+    SDPCache();
+
+    /**
+     * @brief 현재 스트림 설정을 읽는 메서드
+     * @return StreamParams 현재 설정
+     */
+    StreamParams CurrentParams();
+
+    /**
+     * @brief SDP를 만드는 메서드
+     * @param serverIP 서버 주소
+     * @param multicast 멀티캐스트 프레젠테이션 여부
+     * @param params 스트림 설정
+     * @return std::shared_ptr<const SDPDescription> 새 SDP
+     */
+    std::shared_ptr<const SDPDescription> Build(const std::string& serverIP, bool multicast, const StreamParams& params);
+
+    std::mutex cacheMutex;                 ///< 캐시 보호 뮤텍스
+    std::map<std::pair<std::string, bool>, Entry> entries; ///< (서버 주소, 멀티캐스트 여부)별 캐시
+    uint64_t generation = 0;               ///< 코덱 파라미터/재생 시간 변경과 Invalidate 횟수
+    std::map<int, TrackParams> trackParams; ///< 트랙 번호별 코덱 파라미터
+    double durationSec = 0.0;              ///< a=range 재생 시간 (초, 0: 라이브 스트림)
+    uint32_t sessionID;                    ///< SDP o= 세션 ID
+    uint32_t sessionVersion = 0;           ///< SDP o= 세션 버전 (다시 만들 때마다 증가)
+};
+
+#endif //RTSP_SDPCACHE_H
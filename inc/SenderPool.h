@@ -0,0 +1,210 @@
+/**
+ * @file SenderPool.h
+ * @brief 미디어 송신 스레드 풀 클래스 헤더
+ * @details 세션마다 송신 스레드를 만드는 대신 코어 수만큼의 워커가 모든 세션의 RTP 전송을 처리하는 싱글톤 클래스
+ *          - SETUP에서 세션을 워커(홈 코어) 하나에 배정하고, 세션의 송신 상태는 그 워커만 접근
+ *          - 워커마다 잠금 없는 수신함(MPSC 큐)으로 새 프레임/세션 등록/깨우기 알림 전달
+ *          - 워커마다 트랙별 최근 프레임 링을 복제하여 송신 경로에서 코어 간 잠금 없음
+ *          - 통계는 워커별로 따로 세고 조회할 때 합산
+ * 
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ * 
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_SENDERPOOL_H
+#define RTSP_SENDERPOOL_H
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+#include "MPSCQueue.h"
+#include "FrameRing.h"
+
+class MediaStreamHandler;
+
+/**
+ * @struct SenderPoolStats
+ * @brief 송신 스레드 풀 통계 구조체
+ */
+struct SenderPoolStats {
+    size_t workers = 0;          ///< 워커 스레드 수 (세션 수와 무관하게 고정)
+    size_t sessions = 0;         ///< 워커들이 소유한 세션 수
+    uint64_t frameEvents = 0;    ///< 워커들이 받은 새 프레임 알림 수 (워커 수 x 프레임 수)
+    uint64_t executedTasks = 0;  ///< 세션 송신을 실행한 횟수
+    uint64_t coalescedTasks = 0; ///< 한 번에 꺼낸 알림이 여러 개라 하나로 병합된 알림 수
+    int64_t cpuNs = 0;           ///< 워커들이 사용한 CPU 시간 합 (나노초, 워커가 잠들기 전에 갱신)
+    std::vector<size_t> sessionsPerWorker; ///< 워커별 소유 세션 수
+};
+
+/**
+ * @class SenderPool
+ * @brief 모든 세션의 미디어 전송을 처리하는 고정 크기 워커 풀 싱글톤 클래스
+ * @details 세션은 등록 시 소유 세션이 가장 적은 워커에 배정되며 이후 다른 워커로 옮겨지지 않는다.
+ *          워커는 자기 세션 목록, 프레임 링, 통계를 혼자 쓰므로 송신 경로에 코어 간 잠금이 없다.
+ *          다른 스레드는 워커의 수신함에 메시지를 넣는 것으로만 워커와 통신한다.
+ *          (생산자: 새 프레임, 제어 스레드: 세션 등록/제거/깨우기)
+ *          워커는 수신함을 한 번에 비우므로 그 사이 들어온 알림은 송신 한 번으로 병합되고,
+ *          한 세션의 패킷은 항상 소유 워커가 순서대로 전송한다.
+ *          PLAY/PAUSE는 MediaStreamHandler의 상태만 바꾸며 스레드를 재우거나 깨우지 않는다.
+ */
+class SenderPool {
+public:
+    SenderPool(const SenderPool&) = delete;
+    SenderPool& operator=(const SenderPool&) = delete;
+
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return SenderPool& 싱글톤 인스턴스에 대한 참조
+     */
+    static SenderPool& GetInstance() {
+        static SenderPool instance;
+        return instance;
+    };
+
+    /**
+     * @brief 워커 스레드를 시작하고 모든 트랙 DataCapture의 새 프레임 이벤트에 연결하는 메서드
+     * @param workerCount 워커 수 (0: sender 역할에 배정된 CPU 수, 배정하지 않았으면 온라인 코어 수)
+     * @return bool 성공 여부 (이미 시작되었으면 true)
+     */
+    bool Start(size_t workerCount = 0);
+
+    /**
+     * @brief 워커 스레드를 모두 종료하는 메서드
+     * @details 실행 중인 송신이 끝나길 기다린 뒤 반환하며, 워커가 소유한 세션 참조를 모두 해제한다.
+     */
+    void Stop();
+
+    /**
+     * @brief 세션을 풀에 등록하는 메서드
+     * @param handler 등록할 미디어 스트림 핸들러
+     * @details 소유 세션이 가장 적은 워커에 배정하고 handler의 워커 번호를 설정한다. (풀이 시작된 뒤에만 등록됨)
+     */
+    void Add(const std::shared_ptr<MediaStreamHandler>& handler);
+
+    /**
+     * @brief 세션을 풀에서 제거하는 메서드
+     * @param handler 제거할 미디어 스트림 핸들러
+     * @details 소유 워커에 제거를 알리고 바로 반환한다. 워커는 진행 중인 송신을 마친 뒤 참조를 놓는다.
+     */
+    void Remove(MediaStreamHandler* handler);
+
+    /**
+     * @brief 세션 하나의 송신을 즉시 예약하는 메서드
+     * @param handler 작업을 예약할 핸들러 (PLAY 직후 다음 프레임을 기다리지 않고 시작할 때 사용)
+     */
+    void Wake(MediaStreamHandler* handler);
+
+    /**
+     * @brief 풀 통계를 반환하는 메서드
+     * @return SenderPoolStats 워커별 통계를 합산한 값
+     */
+    SenderPoolStats GetStats();
+
+private:
+    /**
+     * @enum MessageType
+     * @brief 워커 수신함 메시지 종류
+     */
+    enum MessageType {
+        eMessage_Frame,   ///< 새 프레임 (트랙의 프레임 링에 넣고 그 트랙을 재생 중인 세션 모두 송신)
+        eMessage_Add,     ///< 세션 등록
+        eMessage_Remove,  ///< 세션 제거
+        eMessage_Wake,    ///< 세션 하나 송신
+    };
+
+    /**
+     * @struct Message
+     * @brief 워커 수신함 메시지
+     */
+    struct Message {
+        MessageType type = eMessage_Frame;           ///< 메시지 종류
+        std::shared_ptr<MediaStreamHandler> handler; ///< 등록할 세션 (eMessage_Add)
+        MediaStreamHandler* target = nullptr;        ///< 대상 세션 (eMessage_Remove, eMessage_Wake)
+        DataCaptureSharedFrame frame;                ///< 새 프레임 (eMessage_Frame)
+        int track = 0;                               ///< 새 프레임의 트랙 번호 (eMessage_Frame)
+        int64_t queuedNs = 0;                        ///< 수신함에 넣은 시각 (스케줄링 지연 측정용)
+    };
+
+    /**
+     * @struct OwnedSession
+     * @brief 워커가 소유한 세션
+     */
+    struct OwnedSession {
+        std::shared_ptr<MediaStreamHandler> handler; ///< 미디어 스트림 핸들러
+        bool runnable = false;                       ///< 이번 차례에 송신할지 여부
+    };
+
+    /**
+     * @struct Shard
+     * @brief 워커 하나(홈 코어)가 소유하는 상태
+     * @details 다른 워커와 캐시 라인을 공유하지 않도록 정렬한다.
+     */
+    struct alignas(64) Shard {
+        MPSCQueue<Message> inbox;                ///< 잠금 없는 수신함 (여러 스레드가 넣고 워커만 꺼냄)
+        std::mutex sleepMutex;                   ///< 워커 대기용 뮤텍스 (워커가 잠들어 있을 때만 사용)
+        std::condition_variable sleepCondition;  ///< 워커를 깨우는 조건 변수
+        std::atomic<bool> sleeping{false};       ///< 워커가 수신함을 기다리며 잠들었는지 여부
+        std::atomic<size_t> assigned{0};         ///< 배정된 세션 수 (Add/Remove에서 갱신, 배정 기준)
+        std::thread thread;                      ///< 워커 스레드
+
+        // 아래는 워커 스레드만 기록 (통계는 GetStats가 느슨하게 읽음)
+        FrameRing frames[DataCapture::max_tracks]; ///< 트랙별 최근 프레임 링
+        std::vector<OwnedSession> sessions;      ///< 소유 세션
+        std::atomic<size_t> sessionCount{0};     ///< 소유 세션 수
+        std::atomic<uint64_t> frameEvents{0};    ///< 받은 새 프레임 알림 수
+        std::atomic<uint64_t> executedTasks{0};  ///< 세션 송신 실행 수
+        std::atomic<uint64_t> coalescedTasks{0}; ///< 병합된 알림 수
+        std::atomic<int64_t> cpuNs{0};           ///< 워커 스레드의 CPU 시간 (CLOCK_THREAD_CPUTIME_ID)
+    };
+
+    /**
+     * @brief 생성자 - 새 프레임 이벤트를 받을 DataCapture가 풀보다 늦게 소멸되도록 먼저 생성
+     */
+    SenderPool();
+
+    /**
+     * @brief 소멸자 - 워커 스레드 종료
+     */
+    ~SenderPool();
+
+    /**
+     * @brief 모든 워커에 새 프레임을 알리는 메서드 (새 프레임 이벤트, 생산자 스레드에서 호출)
+     * @param track 프레임을 기록한 트랙 번호
+     * @param frame 기록된 프레임
+     */
+    void OnFrame(int track, const DataCaptureSharedFrame& frame);
+
+    /**
+     * @brief 워커 수신함에 메시지를 넣고 잠든 워커를 깨우는 메서드
+     * @param shard 대상 워커
+     * @param message 보낼 메시지
+     */
+    void Post(Shard& shard, Message message);
+
+    /**
+     * @brief 수신함의 메시지를 모두 처리하는 메서드 (워커 스레드에서 호출)
+     * @param shard 워커 상태
+     * @return uint32_t 새 프레임 알림이 있었던 트랙의 비트 집합 (트랙 N이면 1 << N)
+     */
+    uint32_t DrainInbox(Shard& shard);
+
+    /**
+     * @brief 워커 스레드 함수
+     * @param shard 워커 상태 (Stop이 스레드를 기다린 뒤 해제)
+     * @param index 워커 번호
+     */
+    void WorkerLoop(Shard& shard, size_t index);
+
+    std::vector<std::unique_ptr<Shard>> shards; ///< 워커별 상태 (바꾸거나 읽을 때 shardsMutex 필요, 워커와 OnFrame 제외)
+    std::atomic<bool> running{false};           ///< 풀 실행 여부
+    std::mutex shardsMutex;                     ///< 워커 목록과 세션 배정 보호 뮤텍스 (제어 경로 전용)
+};
+
+#endif //RTSP_SENDERPOOL_H
@@ -0,0 +1,153 @@
+/**
+ * @file SessionTable.h
+ * @brief 서버 전체 RTSP 세션 테이블 클래스 헤더
+ * @details 세션 ID로 활성 세션을 관리하고 유휴 세션을 정리하는 싱글톤 클래스
+ *          - 64비트 세션 ID -> ClientSession 해시 색인 (요청마다 Session 헤더 검증에 사용)
+ *          - 세션 타임아웃 (SETUP 응답의 Session: id;timeout=N)
+ *          - 타이머 휠로 유휴 연결 만료 처리 (SETUP 전의 연결 포함, RTSP 요청 또는 RTCP 수신이 있으면 활성)
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_SESSIONTABLE_H
+#define RTSP_SESSIONTABLE_H
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <condition_variable>
+
+class ClientSession;
+
+/**
+ * @class SessionTable
+ * @brief 활성 RTSP 세션을 관리하고 유휴 세션을 만료시키는 싱글톤 클래스
+ * @details SETUP으로 만들어진 세션을 ID로 등록한다. 타이머 휠은 ID 색인과 별개로 수락한 모든 연결(Watch)을 감시하여
+ *          SETUP을 하지 않는 연결도 같은 타임아웃으로 끊는다. 정리 스레드가 1초마다 타이머 휠의 슬롯 하나를 검사하여
+ *          타임아웃 동안 요청(GET_PARAMETER 등의 keepalive 포함)이나 RTCP가 없던 연결을 끊는다.
+ *          연결이 끊기면 이벤트 루프가 평소처럼 세션을 정리하므로 송신 작업, 소켓, 버퍼가 모두 해제된다.
+ *          활동할 때마다 휠을 갱신하지 않고, 슬롯이 돌아왔을 때 마지막 활동 시간을 보고 다시 배치한다.
+ *          멀티캐스트 시청자의 RTCP는 공유 핸들러로 들어오므로 세션 활동으로 기록되지 않는다.
+ *          멀티캐스트 시청자는 SETUP 응답의 timeout= 안에 RTSP 요청(GET_PARAMETER, OPTIONS)을 보내야 한다.
+ */
+class SessionTable {
+public:
+    SessionTable(const SessionTable&) = delete;
+    SessionTable& operator=(const SessionTable&) = delete;
+
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return SessionTable& 싱글톤 인스턴스에 대한 참조
+     */
+    static SessionTable& GetInstance() {
+        static SessionTable instance;
+        return instance;
+    };
+
+    static const int default_timeout_sec = 60; ///< 기본 세션 타임아웃 (RFC 2326 기본값)
+
+    /**
+     * @brief 유휴 세션 정리 스레드를 시작하는 메서드
+     * @return bool 성공 여부 (이미 시작되었으면 true)
+     */
+    bool Start();
+
+    /**
+     * @brief 정리 스레드를 종료하는 메서드
+     */
+    void Stop();
+
+    /**
+     * @brief 수락한 연결을 유휴 타임아웃 감시 대상에 추가하는 메서드
+     * @param session 연결의 세션 (휠은 약한 참조만 보관, 연결이 해제되면 다음 검사 때 버림)
+     * @details 연결마다 한 번 호출한다. SETUP 전이나 TEARDOWN 이후의 연결도 세션 타임아웃 동안 요청이 없으면 끊는다.
+     */
+    void Watch(const std::shared_ptr<ClientSession>& session);
+
+    /**
+     * @brief 세션을 등록하는 메서드
+     * @param session 등록할 세션 (테이블은 약한 참조만 보관, 타임아웃 감시는 Watch로 이미 시작됨)
+     * @return bool 성공 여부 (이미 등록된 세션이면 true, 다른 세션과 ID가 겹치면 false)
+     */
+    bool Add(const std::shared_ptr<ClientSession>& session);
+
+    /**
+     * @brief 세션을 제거하는 메서드
+     * @param id 제거할 세션 ID
+     */
+    void Remove(uint64_t id);
+
+    /**
+     * @brief 세션 ID로 세션을 찾는 메서드
+     * @param id 찾을 세션 ID
+     * @return std::shared_ptr<ClientSession> 세션 (없으면 nullptr)
+     */
+    std::shared_ptr<ClientSession> Find(uint64_t id);
+
+    /**
+     * @brief 등록된 세션 수를 반환하는 메서드
+     * @return size_t 세션 수
+     */
+    size_t GetCount();
+
+    /**
+     * @brief 세션 타임아웃을 설정하는 메서드
+     * @param sec 타임아웃 (초, 1 이상)
+     */
+    void SetTimeout(int sec);
+
+    /**
+     * @brief 세션 타임아웃을 반환하는 메서드
+     * @return int 타임아웃 (초)
+     */
+    inline int GetTimeout() const { return timeoutSec; };
+
+    /**
+     * @brief 만료 처리한 세션 수를 반환하는 메서드
+     * @return uint64_t 타임아웃으로 끊은 세션 수
+     */
+    inline uint64_t GetExpiredCount() const { return expiredCount; };
+
+private:
+    static const int wheel_slots = 64;     ///< 타이머 휠 슬롯 수 (틱 하나에 슬롯 하나)
+    static const int tick_ms = 1000;       ///< 타이머 휠 틱 간격
+
+    SessionTable() = default;
+    ~SessionTable();
+
+    /**
+     * @brief 틱마다 현재 슬롯을 검사하는 정리 스레드 함수
+     */
+    void Run();
+
+    /**
+     * @brief 연결을 남은 시간 뒤의 슬롯에 배치하는 메서드 (tableMutex를 잡은 상태에서 호출)
+     * @param session 연결의 세션
+     * @param delayMs 다시 검사할 때까지의 시간
+     * @details 휠 한 바퀴보다 길면 마지막 슬롯에 두고 그때 다시 계산
+     */
+    void Schedule(const std::weak_ptr<ClientSession>& session, int64_t delayMs);
+
+    std::mutex tableMutex;                  ///< 테이블/휠 보호 뮤텍스
+    std::condition_variable stopCondition;  ///< 정리 스레드 종료 알림
+    std::thread reaperThread;               ///< 유휴 세션 정리 스레드
+    bool running = false;                   ///< 정리 스레드 실행 여부
+
+    std::unordered_map<uint64_t, std::weak_ptr<ClientSession>> sessions; ///< 세션 ID -> 세션 (ID가 난수이므로 기본 해시로 고르게 분산)
+    std::vector<std::vector<std::weak_ptr<ClientSession>>> wheel =
+        std::vector<std::vector<std::weak_ptr<ClientSession>>>(wheel_slots); ///< 슬롯별 검사할 연결
+    uint64_t currentTick = 0;               ///< 현재 틱 (현재 슬롯 = currentTick % wheel_slots)
+
+    std::atomic<int> timeoutSec{default_timeout_sec}; ///< 세션 타임아웃 (초)
+    std::atomic<uint64_t> expiredCount{0};            ///< 만료 처리한 세션 수
+};
+
+#endif //RTSP_SESSIONTABLE_H
@@ -3,7 +3,7 @@
  * @brief TCP 연결 및 RTSP 메시지 처리를 위한 싱글톤 클래스 헤더
  * @details TCP 소켓을 생성하고 클라이언트 연결을 관리하며,
  *          RTSP 프로토콜에 따른 메시지 송수신을 처리하는 기능을 제공하는 클래스
- *          - TCP 소켓 생성 및 초기화
+ *          - SO_REUSEPORT 리스닝 소켓 생성 및 초기화 (이벤트 루프마다 하나)
  *          - 클라이언트 연결 수락 및 관리
  *          - RTSP 요청/응답 메시지 처리
  * 
@@ -49,45 +49,44 @@ public:
         return instance;
     };
 
+    static const int defer_accept_sec = 5; ///< TCP_DEFER_ACCEPT 시간 (요청 없이 연결만 맺은 클라이언트를 깨우지 않는 시간)
+
     /**
-     * @brief TCP 소켓을 생성하고 초기화하는 메서드
-     * @details 소켓 생성, 옵션 설정, 바인딩, 리스닝 상태 설정
-     * @throw std::runtime_error 소켓 생성 또는 초기화 실패 시
+     * @brief 논블로킹 리스닝 소켓을 하나 생성하고 초기화하는 메서드
+     * @param backlog listen 대기열 크기 (0 이하: SOMAXCONN)
+     * @return int 생성된 리스닝 소켓 디스크립터 (-1: 실패)
+     * @details 소켓 생성, SO_REUSEPORT/TCP_DEFER_ACCEPT 옵션 설정, 바인딩, 리스닝 상태 설정.
+     *          여러 번 호출하면 같은 포트에 리스닝 소켓이 추가되고 커널이 새 연결을 나누어 준다.
      */
-    void CreateTCPSocket();
+    int CreateTCPSocket(int backlog);
 
     /**
      * @brief 클라이언트 연결을 수락하는 메서드
+     * @param listenSocket 연결을 수락할 리스닝 소켓
      * @param _clientIp [out] 연결된 클라이언트의 IP 주소
-     * @return int 생성된 클라이언트 소켓 디스크립터
-     * @throw std::runtime_error 연결 수락 실패 시
+     * @return int 생성된 논블로킹 클라이언트 소켓 디스크립터 (-1: 대기 중인 연결 없음 또는 실패)
      */
-    int AcceptClientConnection(std::string &_clientIp);
+    int AcceptClientConnection(int listenSocket, std::string &_clientIp);
 
     /** 
-     * @brief 클라이언트 연결을 종료하는 메서드
+     * @brief 모든 리스닝 소켓을 닫는 메서드
      */
     void CloseClientConnection();
 
     /** 
-     * @brief RTSP 요청 메시지를 수신하는 메서드
-     * @param clientSocket 클라이언트 소켓 디스크립터
-     * @return std::string 수신된 RTSP 요청 메시지
-     */
-    std::string ReceiveRTSPRequest(int clientSocket);
-
-    /**
-     * @brief RTSP 응답을 전송하는 메서드
-     * @param clientSocket 클라이언트 소켓 디스크립터
-     * @param response 전송할 RTSP 응답 메시지
+     * @brief 논블로킹 소켓에 도착한 RTSP 요청 데이터를 수신하는 메서드
+     * @param clientSocket 논블로킹 클라이언트 소켓 디스크립터
+     * @param buffer [in,out] 수신한 데이터를 덧붙일 연결별 입력 버퍼
+     * @param maxBytes 이번 호출에서 읽을 최대 바이트 수 (남은 데이터는 level-triggered epoll이 다시 알림)
+     * @return bool 연결 유지 여부 (false: 클라이언트가 연결을 닫았거나 수신 실패)
      */
-    void SendRTSPResponse(int clientSocket, std::string& response);
+    bool ReceiveRTSPRequest(int clientSocket, std::string& buffer, size_t maxBytes);
 
     /**
-     * @brief TCP 소켓을 반환하는 메서드
-     * @return int& TCP 소켓 디스크립터에 대한 참조
+     * @brief 리스닝 소켓 목록을 반환하는 메서드
+     * @return const std::vector<int>& 리스닝 소켓 디스크립터 목록
      */
-    int& GetTCPSocket();
+    const std::vector<int>& GetTCPSockets();
 
     /**
      * @brief TCP 주소 구조체를 반환하는 메서드
@@ -108,8 +107,8 @@ private:
     ~TCPHandler();
 
     int tcpPort;                                ///< TCP 포트 번호
-    int tcpSocket;                              ///< TCP 소켓 디스크립터
-    sockaddr_in tcpAddr;                        ///< TCP 주소 구조체
+    std::vector<int> tcpSockets;                ///< SO_REUSEPORT 리스닝 소켓 디스크립터 목록
+    sockaddr_in tcpAddr;                        ///< TCP 바인딩 주소 구조체
     std::unordered_map<int, int> socketTable;   ///< 클라이언트 소켓 테이블
 };
 
@@ -0,0 +1,261 @@
+/**
+ * @file ThreadRegistry.h
+ * @brief 스레드 역할별 배치(CPU 친화도/실시간 우선순위) 관리 클래스 헤더
+ * @details 파이프라인 단계(캡처, 인코딩, 송신, 제어)마다 CPU 집합과 스케줄링 정책을 정하고,
+ *          서버와 소스가 만든 스레드를 역할별로 등록하여 적용하는 싱글톤 클래스
+ *          - 역할별 CPU 친화도 마스크와 SCHED_OTHER/SCHED_FIFO/SCHED_RR 우선순위
+ *          - 스레드가 스스로 등록하거나, 외부 라이브러리(FFmpeg 등)가 만든 스레드를 생성 직후 등록
+ *          - 역할별 스케줄링 지연(깨어나야 할 시각과 실제로 실행된 시각의 차이) 통계
+ *
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_THREADREGISTRY_H
+#define RTSP_THREADREGISTRY_H
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <sched.h>
+#include <sys/types.h>
+
+/**
+ * @enum ThreadRole
+ * @brief 스레드 역할 (파이프라인 단계)
+ */
+enum ThreadRole {
+    eThreadRole_Capture,  ///< 캡처 (libcamera/ALSA 콜백, 파일 읽기, 색 변환)
+    eThreadRole_Encode,   ///< 인코딩 (FFmpeg/x264 워커)
+    eThreadRole_Sender,   ///< RTP 패킷화/송신 (SenderPool 워커)
+    eThreadRole_Control,  ///< 제어 (RTSP 이벤트 루프, RTCP 수신, 세션 정리)
+    eThreadRole_Count,
+};
+
+/**
+ * @struct ThreadPolicy
+ * @brief 역할 하나의 스레드 배치 정책
+ */
+struct ThreadPolicy {
+    uint64_t cpuMask = 0;           ///< 실행할 CPU 비트 마스크 (0: 고정하지 않음)
+    int schedPolicy = SCHED_OTHER;  ///< 스케줄링 정책 (SCHED_OTHER, SCHED_FIFO, SCHED_RR)
+    int priority = 0;               ///< 실시간 우선순위 (SCHED_FIFO/SCHED_RR일 때 1~99)
+};
+
+/**
+ * @struct ThreadLatencyStats
+ * @brief 역할 하나의 스케줄링 지연 통계
+ */
+struct ThreadLatencyStats {
+    size_t threads = 0;     ///< 등록된 스레드 수
+    uint64_t samples = 0;   ///< 측정 횟수
+    uint64_t meanUs = 0;    ///< 평균 지연 (마이크로초)
+    uint64_t p99Us = 0;     ///< 99번째 백분위 지연의 상한 (2의 거듭제곱 구간)
+    uint64_t maxUs = 0;     ///< 최대 지연
+};
+
+/**
+ * @class ThreadRegistry
+ * @brief 역할별 스레드 배치를 적용하고 스케줄링 지연을 모으는 싱글톤 클래스
+ * @details 스레드는 시작할 때 Enter()로 역할을 등록하고 끝날 때 Leave()를 호출한다.
+ *          등록 시 역할의 정책이 바로 적용되며, 나중에 정책을 바꾸면 등록된 스레드 모두에 다시 적용된다.
+ *          정책은 스레드 ID(tid)로 적용하므로 다른 라이브러리가 만든 스레드도 Adopt()로 등록할 수 있다.
+ *          환경 변수 RTSP_THREAD_POLICY가 있으면 생성 시 읽는다. (형식은 Configure 참고)
+ *          실시간 정책은 CAP_SYS_NICE(또는 root)가 필요하며, 권한이 없으면 경고만 남기고 친화도만 적용한다.
+ */
+class ThreadRegistry {
+public:
+    ThreadRegistry(const ThreadRegistry&) = delete;
+    ThreadRegistry& operator=(const ThreadRegistry&) = delete;
+
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return ThreadRegistry& 싱글톤 인스턴스에 대한 참조
+     */
+    static ThreadRegistry& GetInstance() {
+        static ThreadRegistry instance;
+        return instance;
+    };
+
+    /**
+     * @brief 역할 이름을 반환하는 정적 메서드
+     * @param role 스레드 역할
+     * @return const char* 역할 이름 (capture, encode, sender, control)
+     */
+    static const char* GetRoleName(ThreadRole role);
+
+    /**
+     * @brief 역할의 배치 정책을 설정하는 메서드
+     * @param role 스레드 역할
+     * @param policy 배치 정책
+     * @return bool 등록된 스레드 모두에 적용했는지 여부 (권한 부족 등으로 일부 실패하면 false)
+     */
+    bool SetPolicy(ThreadRole role, const ThreadPolicy& policy);
+
+    /**
+     * @brief 역할의 배치 정책을 반환하는 메서드
+     * @param role 스레드 역할
+     * @return ThreadPolicy 배치 정책
+     */
+    ThreadPolicy GetPolicy(ThreadRole role);
+
+    /**
+     * @brief 문자열로 여러 역할의 배치 정책을 설정하는 메서드
+     * @param spec "역할=CPU목록[:정책[:우선순위]]"을 ';'로 이은 문자열
+     *             (예: "capture=3:fifo:80;encode=1-2;sender=0:rr:50;control=0")
+     *             CPU목록은 "0,2" 또는 "1-3" 형식이며 "*"이면 고정하지 않음, 정책은 other|fifo|rr
+     * @return bool 문법 오류 없이 모두 설정했는지 여부 (오류가 있는 항목은 무시)
+     */
+    bool Configure(const std::string& spec);
+
+    /**
+     * @brief 역할에 배정된 CPU 수를 반환하는 메서드
+     * @param role 스레드 역할
+     * @return size_t CPU 수 (고정하지 않았으면 0)
+     */
+    size_t GetCPUCount(ThreadRole role);
+
+    /**
+     * @brief 현재 스레드를 역할에 등록하고 정책을 적용하는 메서드
+     * @param role 스레드 역할
+     * @param name 스레드 이름 (ps/top에 표시, 15자까지)
+     * @param cpuSlot 역할의 CPU 중 몇 번째 CPU 하나에 고정할지 (-1: 역할의 CPU 전체, 개수를 넘으면 나머지로 순환)
+     * @details 이미 같은 역할로 등록된 스레드면 아무것도 하지 않으므로 콜백 안에서 매번 호출해도 된다.
+     *          cpuSlot은 워커마다 홈 코어를 두는 풀(SenderPool)에서 사용하며, 역할을 고정하지 않았으면 프로세스의 CPU 중에서 고른다.
+     */
+    void Enter(ThreadRole role, const char* name, int cpuSlot = -1);
+
+    /**
+     * @brief 현재 스레드의 등록을 해제하는 메서드 (스레드 함수가 끝날 때 호출)
+     */
+    void Leave();
+
+    /**
+     * @brief 함수가 실행되는 동안 생긴 스레드를 역할에 등록하는 메서드
+     * @param role 등록할 역할
+     * @param create 스레드를 만드는 함수 (예: avcodec_open2 호출)
+     * @return size_t 등록한 스레드 수
+     * @details 실행 전후의 /proc/self/task 목록을 비교하므로 그 사이 다른 곳에서 만든 스레드도 함께 등록될 수 있다.
+     */
+    size_t Adopt(ThreadRole role, const std::function<void()>& create);
+
+    /**
+     * @brief 스케줄링 지연 측정값 하나를 기록하는 메서드
+     * @param role 측정한 스레드의 역할
+     * @param latencyNs 깨어나야 할 시각부터 실제로 실행된 시각까지의 시간 (나노초)
+     */
+    void RecordLatency(ThreadRole role, int64_t latencyNs);
+
+    /**
+     * @brief 역할의 스케줄링 지연 통계를 반환하는 메서드
+     * @param role 스레드 역할
+     * @return ThreadLatencyStats 지연 통계
+     */
+    ThreadLatencyStats GetLatencyStats(ThreadRole role);
+
+    /**
+     * @brief 모든 역할의 지연 통계를 초기화하는 메서드
+     */
+    void ResetLatencyStats();
+
+    /**
+     * @brief 역할별 정책과 지연 통계를 출력하는 메서드
+     */
+    void PrintReport();
+
+    /**
+     * @brief 역할마다 지연 측정 스레드를 시작하는 메서드
+     * @param intervalUs 측정 주기 (마이크로초)
+     * @details 측정 스레드는 해당 역할로 등록되어 같은 CPU/우선순위에서 주기적으로 잠들었다 깨어나며,
+     *          예정 시각보다 늦게 깨어난 시간을 기록한다. (cyclictest와 같은 방식)
+     *          인코더처럼 직접 측정할 수 없는 역할의 지연을 보기 위한 것이며, 이미 실행 중이면 아무것도 하지 않는다.
+     */
+    void StartProbes(int intervalUs);
+
+    /**
+     * @brief 지연 측정 스레드를 종료하는 메서드
+     */
+    void StopProbes();
+
+    /**
+     * @brief 단조 시계의 현재 시각을 반환하는 정적 메서드
+     * @return int64_t CLOCK_MONOTONIC 나노초 (RecordLatency 계산용)
+     */
+    static int64_t NowNs();
+
+private:
+    static const int latency_buckets = 32; ///< 지연 히스토그램 구간 수 (구간 i: 2^(i-1) ~ 2^i 마이크로초)
+
+    /**
+     * @struct Entry
+     * @brief 등록된 스레드 정보
+     */
+    struct Entry {
+        pid_t tid;        ///< 스레드 ID
+        ThreadRole role;  ///< 역할
+        int cpuSlot;      ///< 고정할 CPU 순번 (-1: 역할의 CPU 전체)
+    };
+
+    /**
+     * @struct RoleState
+     * @brief 역할별 정책과 지연 통계
+     */
+    struct RoleState {
+        ThreadPolicy policy;                                  ///< 배치 정책
+        std::atomic<bool> warned{false};                      ///< 적용 실패 경고를 이미 출력했는지 여부
+        std::atomic<uint64_t> samples{0};                     ///< 측정 횟수
+        std::atomic<uint64_t> totalUs{0};                     ///< 지연 합계
+        std::atomic<uint64_t> maxUs{0};                       ///< 최대 지연
+        std::atomic<uint64_t> buckets[latency_buckets] = {};  ///< 지연 히스토그램
+    };
+
+    /**
+     * @brief 생성자 - 프로세스의 기본 CPU 집합을 저장하고 환경 변수 설정을 읽음
+     */
+    ThreadRegistry();
+
+    /**
+     * @brief 소멸자 - 측정 스레드 종료
+     */
+    ~ThreadRegistry();
+
+    /**
+     * @brief 스레드 하나에 정책을 적용하는 메서드
+     * @param tid 스레드 ID
+     * @param role 역할 (경고 출력용)
+     * @param policy 적용할 정책
+     * @param cpuSlot 고정할 CPU 순번 (-1: 역할의 CPU 전체)
+     * @return int 0이면 성공, 실패하면 errno (ESRCH: 이미 끝난 스레드)
+     */
+    int Apply(pid_t tid, ThreadRole role, const ThreadPolicy& policy, int cpuSlot);
+
+    /**
+     * @brief 현재 프로세스의 스레드 ID 목록을 읽는 메서드
+     * @return std::vector<pid_t> /proc/self/task의 스레드 ID
+     */
+    static std::vector<pid_t> ListThreads();
+
+    /**
+     * @brief 측정 스레드 함수
+     * @param role 측정할 역할
+     * @param intervalUs 측정 주기
+     */
+    void ProbeLoop(ThreadRole role, int intervalUs);
+
+    std::mutex registryMutex;                 ///< 정책/등록 목록 보호 뮤텍스
+    RoleState roles[eThreadRole_Count];       ///< 역할별 상태
+    std::vector<Entry> entries;               ///< 등록된 스레드
+    cpu_set_t defaultCPUs;                    ///< 고정하지 않은 역할이 사용할 CPU 집합 (프로세스 시작 시 집합)
+
+    std::atomic<bool> probing{false};         ///< 측정 스레드 실행 여부
+    std::vector<std::thread> probes;          ///< 역할별 측정 스레드
+};
+
+#endif //RTSP_THREADREGISTRY_H
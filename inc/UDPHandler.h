@@ -1,10 +1,10 @@
 /**
  * @file UDPHandler.h
- * @brief UDP 소켓 관리 클래스 헤더
- * @details RTP/RTCP 스트리밍을 위한 UDP 소켓을 관리하는 클래스
- *          - RTP 소켓 생성 및 관리
- *          - RTCP 소켓 생성 및 관리
- *          - 클라이언트 주소 관리
+ * @brief 세션별 RTP/RTCP 목적지 관리 클래스 헤더
+ * @details RTP/RTCP 스트리밍을 위한 클라이언트 목적지와 공유 UDP 소켓을 연결하는 클래스
+ *          - 서버 공유 RTP/RTCP 소켓 참조 (UDPServer)
+ *          - 클라이언트 RTP/RTCP 주소 관리
+ *          - RFC 5761 rtcp-mux 처리
  * 
  * @organization rtspMediaStream
  * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
@@ -24,9 +24,10 @@ class ClientSession;
 
 /**
  * @class UDPHandler
- * @brief RTP/RTCP를 위한 UDP 소켓 관리 클래스
- * @details 클라이언트와의 미디어 스트리밍을 위한 UDP 소켓을 관리하며,
- *          RTP/RTCP 프로토콜에 필요한 소켓과 주소 정보를 제공한다.
+ * @brief 세션의 RTP/RTCP 목적지를 관리하는 클래스
+ * @details 소켓은 UDPServer가 서버 전체에서 한 쌍만 열어 공유하고,
+ *          이 클래스는 세션별 목적지 주소와 rtcp-mux 여부를 관리한다.
+ * @see UDPServer
  */
 class UDPHandler {
 public:
@@ -37,28 +38,40 @@ public:
     UDPHandler(std::shared_ptr<ClientSession> client);
 
     /**
-     * @brief 소멸자 - 소켓 리소스 해제
+     * @brief 소멸자 - 공유 소켓은 UDPServer가 소유하므로 닫지 않음
      */
-    ~UDPHandler();
+    ~UDPHandler() = default;
 
     /**
-     * @brief RTP와 RTCP UDP 소켓을 생성하는 메서드
-     * @return bool 소켓 생성 성공 여부
-     * @details 클라이언트의 RTP/RTCP 포트로 연결할 UDP 소켓을 생성
+     * @brief 클라이언트의 RTP/RTCP 목적지를 설정하는 메서드
+     * @return bool 공유 소켓이 열려 있고 목적지 설정에 성공했는지 여부
+     * @details rtcp-mux 세션은 RTCP도 클라이언트 RTP 포트로, 서버 RTP 소켓을 통해 전송
      */
-    bool CreateUDPSocket();
+    bool InitTransport();
 
     /**
-     * @brief RTP 소켓을 반환하는 메서드
-     * @return int& RTP 소켓 디스크립터에 대한 참조
+     * @brief 클라이언트가 RTCP를 보낼 서버 RTP 포트 번호를 반환하는 메서드
+     * @return int 서버 RTP 포트 번호
      */
-    int& GetRTPSocket();
+    int GetServerRTPPort();
 
     /**
-     * @brief RTCP 소켓을 반환하는 메서드
-     * @return int& RTCP 소켓 디스크립터에 대한 참조
+     * @brief 클라이언트가 RTCP를 보낼 서버 RTCP 포트 번호를 반환하는 메서드
+     * @return int 서버 RTCP 포트 번호 (rtcp-mux 시 RTP 포트와 동일)
      */
-    int& GetRTCPSocket();
+    int GetServerRTCPPort();
+
+    /**
+     * @brief RTP 전송에 사용할 소켓을 반환하는 메서드
+     * @return int 공유 RTP 소켓 디스크립터
+     */
+    int GetRTPSocket();
+
+    /**
+     * @brief RTCP 전송에 사용할 소켓을 반환하는 메서드
+     * @return int 공유 RTCP 소켓 디스크립터 (rtcp-mux 시 RTP 소켓)
+     */
+    int GetRTCPSocket();
 
     /**
      * @brief RTP 주소를 반환하는 메서드
@@ -72,13 +85,17 @@ public:
      */
     sockaddr_in& GetRTCPAddr();
 
+    /**
+     * @brief rtcp-mux 사용 여부를 반환하는 메서드
+     * @return bool RTP와 RTCP를 한 포트로 다중화하는지 여부
+     */
+    inline bool IsRTCPMux() { return rtcpMux; };
 
 private:
     std::shared_ptr<ClientSession> client; ///< 클라이언트 세션 객체
-    int rtpSocket;                         ///< RTP 소켓 디스크립터
-    int rtcpSocket;                        ///< RTCP 소켓 디스크립터
+    bool rtcpMux;                          ///< RFC 5761 rtcp-mux 사용 여부
     sockaddr_in rtpAddr;                   ///< RTP 주소 구조체
     sockaddr_in rtcpAddr;                  ///< RTCP 주소 구조체
 };
 
-#endif //RTSP_UDPHANDLER_H
\ No newline at end of file
+#endif //RTSP_UDPHANDLER_H
@@ -0,0 +1,161 @@
+/**
+ * @file UDPServer.h
+ * @brief 모든 세션이 공유하는 서버 측 RTP/RTCP 소켓 관리 클래스 헤더
+ * @details 잘 알려진 RTP/RTCP 포트 한 쌍을 바인딩하여 모든 세션이 공유하도록 하는 싱글톤 클래스
+ *          - 서버 RTP/RTCP 포트 바인딩 (RFC 5761 rtcp-mux 시 RTP 포트 하나만 사용)
+ *          - 목적지별 sendto를 위한 공유 소켓 제공
+ *          - 수신 RTCP를 SSRC와 송신 주소로 세션에 분배하는 단일 수신 스레드 (SETUP에서 등록한 주소에서 온 RTCP만)
+ * 
+ * @organization rtspMediaStream
+ * @repository https://github.com/rtspMediaStream/raspberrypi5-rtsp-server
+ * 
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#ifndef RTSP_UDPSERVER_H
+#define RTSP_UDPSERVER_H
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <utility>
+#include <unordered_map>
+#include <arpa/inet.h>
+
+class MediaStreamHandler;
+
+/**
+ * @class UDPServer
+ * @brief 공유 RTP/RTCP 소켓을 관리하는 싱글톤 클래스
+ * @details 세션마다 소켓을 만드는 대신 서버 전체에서 RTP/RTCP 소켓 한 쌍만 사용한다.
+ *          송신은 세션별 목적지 주소로 sendto 하고, 수신한 RTCP는 패킷에 포함된
+ *          미디어 SSRC 또는 송신 주소로 해당 MediaStreamHandler를 찾아 전달한다.
+ */
+class UDPServer {
+public:
+    UDPServer(const UDPServer&) = delete;
+    UDPServer& operator=(const UDPServer&) = delete;
+
+    /**
+     * @brief 싱글톤 인스턴스를 반환하는 정적 메서드
+     * @return UDPServer& 싱글톤 인스턴스에 대한 참조
+     */
+    static UDPServer& GetInstance() {
+        static UDPServer instance;
+        return instance;
+    };
+
+    /**
+     * @brief 공유 RTP/RTCP 소켓을 바인딩하고 RTCP 수신 스레드를 시작하는 메서드
+     * @param rtpPort 바인딩할 서버 RTP 포트
+     * @param rtcpPort 바인딩할 서버 RTCP 포트
+     * @return bool 성공 여부 (이미 열려 있으면 true)
+     */
+    bool Open(int rtpPort, int rtcpPort);
+
+    /**
+     * @brief RTCP 수신 스레드를 종료하고 공유 소켓을 닫는 메서드
+     * @details 종료 후 Open으로 다시 열 수 있음
+     */
+    void Close();
+
+    /**
+     * @brief 공유 소켓으로 보내는 멀티캐스트 패킷의 TTL을 설정하는 메서드
+     * @param ttl 멀티캐스트 TTL (1: 같은 서브넷, 라우터를 넘을 때마다 1씩 감소)
+     * @return bool 성공 여부 (소켓이 열려 있어야 함)
+     * @details 유니캐스트 전송에는 영향을 주지 않음
+     */
+    bool SetMulticastTTL(int ttl);
+
+    /**
+     * @brief RTCP 수신을 위해 미디어 스트림 핸들러를 등록하는 메서드
+     * @param handler 등록할 핸들러 (SSRC와 클라이언트 RTCP 주소로 색인)
+     * @details 다른 핸들러와 SSRC가 겹치면 핸들러의 SSRC를 새로 만들어 등록하므로 SETUP 응답 전에 호출한다.
+     *          세션 수가 바뀌므로 공유 RTP 소켓의 송신 버퍼 크기를 다시 계산
+     */
+    void Register(MediaStreamHandler* handler);
+
+    /**
+     * @brief 등록된 미디어 스트림 핸들러를 제거하는 메서드
+     * @param handler 제거할 핸들러
+     */
+    void Unregister(MediaStreamHandler* handler);
+
+    /**
+     * @brief 공유 RTP 소켓을 반환하는 메서드
+     * @return int RTP 소켓 디스크립터
+     */
+    inline int GetRTPSocket() { return rtpSocket; };
+
+    /**
+     * @brief 공유 RTCP 소켓을 반환하는 메서드
+     * @return int RTCP 소켓 디스크립터
+     */
+    inline int GetRTCPSocket() { return rtcpSocket; };
+
+    /**
+     * @brief 서버 RTP 포트 번호를 반환하는 메서드
+     * @return int 서버 RTP 포트 번호
+     */
+    inline int GetRTPPort() { return rtpPort; };
+
+    /**
+     * @brief 서버 RTCP 포트 번호를 반환하는 메서드
+     * @return int 서버 RTCP 포트 번호
+     */
+    inline int GetRTCPPort() { return rtcpPort; };
+
+private:
+    static const int send_buffer_latency_ms = 250;           ///< 송신 버퍼가 담을 스트림 시간
+    static const int min_send_buffer_size = 256 * 1024;      ///< 최소 송신 버퍼 크기 (bytes)
+    static const int max_send_buffer_size = 8 * 1024 * 1024; ///< 최대 송신 버퍼 크기 (bytes)
+    static const uint64_t default_stream_bitrate = 4000000;  ///< 비트레이트 측정 전 사용할 값 (bps)
+
+    UDPServer() = default;
+    ~UDPServer();
+
+    /**
+     * @brief 스트림 비트레이트와 세션 수로 공유 RTP 소켓의 송신 버퍼 크기를 설정하는 메서드
+     * @details 모든 세션의 send_buffer_latency_ms 분량을 담을 수 있는 크기로 설정 (tableMutex를 잡은 상태에서 호출)
+     */
+    void ResizeSendBuffer();
+
+    /**
+     * @brief RTP/RTCP 소켓을 poll로 감시하며 수신 RTCP를 분배하는 스레드 함수
+     */
+    void ReceiveLoop();
+
+    /**
+     * @brief 수신한 RTCP 패킷을 해당 세션의 핸들러에 전달하는 메서드
+     * @param data 수신한 RTCP 데이터
+     * @param dataLen 수신한 데이터 크기
+     * @param from 송신 주소
+     */
+    void Dispatch(const uint8_t* data, int64_t dataLen, const sockaddr_in& from);
+
+    int rtpSocket = -1;   ///< 공유 RTP 소켓 디스크립터 (rtcp-mux RTCP 수신 포함)
+    int rtcpSocket = -1;  ///< 공유 RTCP 소켓 디스크립터
+    int rtpPort = -1;     ///< 서버 RTP 포트 번호
+    int rtcpPort = -1;    ///< 서버 RTCP 포트 번호
+    int wakeupFd = -1;    ///< 수신 스레드 종료 요청용 eventfd
+    std::thread receiveThread; ///< RTCP 수신 스레드
+
+    std::mutex tableMutex; ///< 핸들러 테이블 보호 뮤텍스
+    using Address = std::pair<uint32_t, uint16_t>; ///< 네트워크 바이트 순서의 IPv4 주소와 포트
+
+    /**
+     * @struct SSRCRoute
+     * @brief SSRC 테이블 항목 (핸들러와 등록된 클라이언트 RTCP 주소)
+     */
+    struct SSRCRoute {
+        MediaStreamHandler* handler; ///< 핸들러
+        Address address;             ///< SETUP에서 등록한 클라이언트 RTCP 주소 (다른 주소에서 온 RTCP는 분배하지 않음)
+    };
+
+    std::unordered_map<uint32_t, SSRCRoute> ssrcTable;                         ///< 미디어 SSRC -> 핸들러
+    std::map<Address, MediaStreamHandler*> addressTable;                       ///< 클라이언트 RTCP 주소 -> 핸들러
+};
+
+#endif //RTSP_UDPSERVER_H
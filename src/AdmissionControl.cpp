@@ -0,0 +1,286 @@
+/**
+ * @file AdmissionControl.cpp
+ * @brief AdmissionControl 클래스의 구현부
+ * @details 세션 수/송신 비트레이트/송신 CPU 예산 검사와 사용량 측정 구현
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "AdmissionControl.h"
+#include "SessionTable.h"
+#include "SenderPool.h"
+#include "MulticastSender.h"
+#include "SDPCache.h"
+#include "ThreadRegistry.h"
+
+#include <iostream>
+
+/**
+ * @details 세션 테이블, 송신 풀, 멀티캐스트 송신자, SDP 캐시를 먼저 생성하여 더 늦게 소멸되도록 함
+ */
+AdmissionControl::AdmissionControl() {
+    SessionTable::GetInstance();
+    SenderPool::GetInstance();
+    MulticastSender::GetInstance();
+    SDPCache::GetInstance();
+}
+
+void AdmissionControl::SetMaxSessions(int count) {
+    maxSessions = count > 0 ? count : 0;
+}
+
+void AdmissionControl::SetMaxEgressBitrate(int kbps) {
+    maxEgressKbps = kbps > 0 ? kbps : 0;
+}
+
+void AdmissionControl::SetMaxSenderCpu(int percent) {
+    maxSenderCpuPercent = (percent > 0 && percent <= 100) ? percent : 0;
+}
+
+/**
+ * @details 세션 수를 먼저 보고, 그다음 송신 CPU 사용률을 봄 (둘 다 잠시 뒤 다시 시도할 수 있는 거부)
+ *          세션 수는 등록된 세션과 예약된 세션을 함께 세고, 검사와 예약을 같은 잠금 아래에서 함
+ *          (등록 직후 예약을 돌려주기 전까지는 한 세션을 두 번 세므로 잠깐 보수적으로 거부할 수 있음)
+ */
+AdmissionResult AdmissionControl::CheckSession() {
+    const int limit = maxSessions;
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    if (limit > 0 && SessionTable::GetInstance().GetCount() + reservedSessions >= (size_t)limit) {
+        rejectedSessions++;
+        std::cerr << "Admission: session limit " << limit << " reached." << std::endl;
+        return eAdmission_Busy;
+    }
+    if (IsCpuExhausted()) {
+        rejectedCpu++;
+        return eAdmission_Busy;
+    }
+    reservedSessions++;
+    return eAdmission_Accepted;
+}
+
+AdmissionResult AdmissionControl::CheckStreams(const std::vector<int>& tracks, const std::vector<int>& multicastTracks) {
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    return Evaluate(tracks, multicastTracks);
+}
+
+void AdmissionControl::AdmitSession() {
+    admitted++;
+    ReleaseSession();
+}
+
+void AdmissionControl::ReleaseSession() {
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    if (reservedSessions > 0) {
+        reservedSessions--;
+    }
+}
+
+/**
+ * @details 검사와 기록을 같은 잠금 아래에서 하여 동시에 PLAY 한 연결들이 함께 예산을 넘지 않도록 함
+ *          exclusiveOwner가 있으면 예산보다 먼저, 요청한 세션 밖에 재생 중인 유니캐스트 스트림이나 멀티캐스트 시청자가 있는지,
+ *          다른 세션이 소스를 잡고 있는지 확인 (합류하는 요청은 다른 세션이 소스를 잡고 있는지만 확인)
+ *          새로 시작하는 스트림이 있을 때만 수락 수에 기록 (이미 재생 중인 세션의 PLAY는 세지 않음)
+ */
+AdmissionResult AdmissionControl::StartStreams(const std::vector<int>& tracks, const std::vector<int>& multicastTracks,
+                                               const void* exclusiveOwner, int ownStreams) {
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    if (exclusiveOwner) {
+        int others = multicastViewers - ownStreams;
+        for (int track = 0; track < DataCapture::max_tracks; track++) {
+            others += playing[track];
+        }
+        if (others > 0 || (sourceHolder && sourceHolder != exclusiveOwner)) {
+            return eAdmission_SourceShared;
+        }
+    } else if (sourceHolder && (!tracks.empty() || !multicastTracks.empty())) {
+        // 1배가 아닌 배율로 재생 중인 소스에 합류하면 요청하지 않은 배율을 받게 됨
+        return eAdmission_SourceShared;
+    }
+    const AdmissionResult result = Evaluate(tracks, multicastTracks);
+    if (result == eAdmission_Accepted && exclusiveOwner) {
+        sourceHolder = exclusiveOwner;
+    }
+    if (result == eAdmission_Accepted && (!tracks.empty() || !multicastTracks.empty())) {
+        admitted++;
+    }
+    if (result == eAdmission_Accepted) {
+        for (int track : tracks) {
+            if (track >= 0 && track < DataCapture::max_tracks) {
+                playing[track]++;
+            }
+        }
+        if (!multicastTracks.empty()) {
+            multicastViewers++;
+        }
+    }
+    return result;
+}
+
+void AdmissionControl::ReleaseSource(const void* owner, bool rateChanged) {
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    if (sourceHolder == owner && !rateChanged) {
+        sourceHolder = nullptr;
+    }
+}
+
+void AdmissionControl::StopStream(int track) {
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    if (track >= 0 && track < DataCapture::max_tracks && playing[track] > 0) {
+        playing[track]--;
+    }
+}
+
+void AdmissionControl::StopMulticast() {
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    if (multicastViewers > 0) {
+        multicastViewers--;
+    }
+}
+
+int AdmissionControl::GetPlayingStreams() {
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    int count = 0;
+    for (int track = 0; track < DataCapture::max_tracks; track++) {
+        count += playing[track];
+    }
+    return count;
+}
+
+/**
+ * @details
+ *   - 송신 CPU 예산을 넘으면 503 (부하가 줄면 다시 시도할 수 있음)
+ *   - 현재 송신 비트레이트 + 새 스트림 비트레이트가 예산을 넘으면 453
+ *     (멀티캐스트 트랙은 이미 그룹으로 송신 중이면 추가 비트레이트 없음)
+ *   - 새 스트림이 없으면(이미 재생 중인 세션의 PLAY) 비트레이트는 검사하지 않음
+ */
+AdmissionResult AdmissionControl::Evaluate(const std::vector<int>& tracks, const std::vector<int>& multicastTracks) {
+    if ((!tracks.empty() || !multicastTracks.empty()) && IsCpuExhausted()) {
+        rejectedCpu++;
+        return eAdmission_Busy;
+    }
+
+    const int limitKbps = maxEgressKbps;
+    if (limitKbps > 0) {
+        uint64_t added = 0;
+        for (int track : tracks) {
+            added += GetTrackBitrate(track);
+        }
+        MulticastSender& multicastSender = MulticastSender::GetInstance();
+        for (int track : multicastTracks) {
+            if (!multicastSender.IsStreaming(track)) {
+                added += GetTrackBitrate(track);
+            }
+        }
+        if (added > 0) {
+            const uint64_t egress = ComputeEgressBitrate();
+            if (egress + added > (uint64_t)limitKbps * 1000) {
+                rejectedBandwidth++;
+                std::cerr << "Admission: egress " << egress / 1000 << " + " << added / 1000
+                          << " kbps exceeds " << limitKbps << " kbps." << std::endl;
+                return eAdmission_NoBandwidth;
+            }
+        }
+    }
+    return eAdmission_Accepted;
+}
+
+/**
+ * @details 소스가 1초마다 측정한 비트레이트를 우선 사용 (스트림마다 같은 프레임을 보내므로 스트림 하나의 송신량)
+ */
+uint64_t AdmissionControl::GetTrackBitrate(int track) {
+    if (track < 0 || track >= DataCapture::max_tracks) {
+        return 0;
+    }
+    const uint64_t measured = DataCapture::getInstance(track).getBitrate();
+    if (measured > 0) {
+        return measured;
+    }
+    return (uint64_t)SDPCache::GetInstance().GetBitrate(track) * 1000;
+}
+
+uint64_t AdmissionControl::GetEgressBitrate() {
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    return ComputeEgressBitrate();
+}
+
+/**
+ * @details 유니캐스트는 트랙별 재생 중인 스트림 수만큼, 멀티캐스트는 송신 중인 트랙마다 한 번
+ */
+uint64_t AdmissionControl::ComputeEgressBitrate() {
+    uint64_t egress = 0;
+    MulticastSender& multicastSender = MulticastSender::GetInstance();
+    for (int track = 0; track < DataCapture::max_tracks; track++) {
+        const bool multicastStreaming = multicastSender.IsStreaming(track);
+        if (playing[track] == 0 && !multicastStreaming) {
+            continue;
+        }
+        const uint64_t bitrate = GetTrackBitrate(track);
+        egress += bitrate * playing[track];
+        if (multicastStreaming) {
+            egress += bitrate;
+        }
+    }
+    return egress;
+}
+
+/**
+ * @details 워커들이 잠들기 전에 기록한 스레드 CPU 시간 합의 증가량 / (경과 시간 x 워커 수)
+ *          측정 간격보다 자주 호출되면 이전 값을 반환하여 짧은 구간의 튀는 값을 피함
+ */
+double AdmissionControl::GetSenderCpuPercent() {
+    const SenderPoolStats stats = SenderPool::GetInstance().GetStats();
+    const int64_t now = ThreadRegistry::NowNs();
+    std::lock_guard<std::mutex> lock(cpuMutex);
+    if (cpuSampleWallNs == 0 || stats.cpuNs < cpuSampleNs) {
+        // 처음 측정하거나 풀이 다시 시작됨
+        cpuSampleWallNs = now;
+        cpuSampleNs = stats.cpuNs;
+        cpuPercent = 0.0;
+        return cpuPercent;
+    }
+    const int64_t elapsedNs = now - cpuSampleWallNs;
+    if (elapsedNs >= (int64_t)cpu_sample_interval_ms * 1000000 && stats.workers > 0) {
+        cpuPercent = (double)(stats.cpuNs - cpuSampleNs) * 100.0 / ((double)elapsedNs * stats.workers);
+        cpuSampleWallNs = now;
+        cpuSampleNs = stats.cpuNs;
+    }
+    return cpuPercent;
+}
+
+bool AdmissionControl::IsCpuExhausted() {
+    const int limit = maxSenderCpuPercent;
+    if (limit <= 0) {
+        return false;
+    }
+    const double usage = GetSenderCpuPercent();
+    if (usage < limit) {
+        return false;
+    }
+    std::cerr << "Admission: sender CPU " << usage << "% exceeds " << limit << "%." << std::endl;
+    return true;
+}
+
+/**
+ * @details 사용량은 호출 시점에 계산
+ */
+AdmissionStats AdmissionControl::GetStats() {
+    AdmissionStats stats;
+    stats.sessions = SessionTable::GetInstance().GetCount();
+    stats.maxSessions = maxSessions;
+    {
+        std::lock_guard<std::mutex> lock(admissionMutex);
+        for (int track = 0; track < DataCapture::max_tracks; track++) {
+            stats.playingStreams += playing[track];
+        }
+        stats.egressKbps = ComputeEgressBitrate() / 1000;
+    }
+    stats.maxEgressKbps = maxEgressKbps;
+    stats.senderCpuPercent = GetSenderCpuPercent();
+    stats.maxSenderCpuPercent = maxSenderCpuPercent;
+    stats.admitted = admitted;
+    stats.rejectedSessions = rejectedSessions;
+    stats.rejectedBandwidth = rejectedBandwidth;
+    stats.rejectedCpu = rejectedCpu;
+    return stats;
+}
@@ -12,28 +12,259 @@
 #include "RequestHandler.h"
 #include "UDPHandler.h"
 #include "MediaStreamHandler.h"
+
 #include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <linux/sockios.h>
+
+/**
+ * @brief 0이 아닌 64비트 세션 ID를 만드는 함수 (0은 Session 헤더 해석 실패를 나타냄)
+ */
+static uint64_t NewSessionID() {
+    uint64_t id;
+    do {
+        id = GetRandom64();
+    } while (id == 0);
+    return id;
+}
 
 /**
  * @details
- *   - 보안과 고유한 세션 ID를 위해 랜덤하게 생성
+ *   - 추측할 수 없는 세션 ID를 위해 CSPRNG로 0이 아닌 64비트 값 생성
  *   - SDP 규격에 따라 세션 ID와 세션 버전에 동일한 값을 사용
  *     (RFC 4566 - 5.2. Origin ("o=") 참조)
- *   - TCP 소켓과 IP 주소 설정
+ *   - TCP 소켓과 IP 주소 설정 (서버 쪽 주소는 연결된 소켓에서 조회하며 DNS를 사용하지 않음)
  *   - RTP/RTCP 포트를 초기값(-1)으로 설정
+ *   - rtcp-mux와 interleaved 전송은 SETUP에서 요청할 때만 사용
  */
 ClientSession::ClientSession(const int tcpSocket, const std::string ip) {
-    this->id = (int)GetRanNum(16);  // 랜덤한 세션 ID 생성
+    this->id = NewSessionID();      // 랜덤한 세션 ID 생성
     this->version = id;             // 세션 버전은 세션 ID와 동일하게 설정
     this->tcpSocket = tcpSocket;
     this->ip = ip;
+    this->localIP = "0.0.0.0";
+
+    sockaddr_in localAddr{};
+    socklen_t localAddrLen = sizeof(localAddr);
+    char localBuffer[INET_ADDRSTRLEN];
+    if (tcpSocket >= 0 && getsockname(tcpSocket, (sockaddr*)&localAddr, &localAddrLen) == 0
+        && localAddr.sin_family == AF_INET
+        && inet_ntop(AF_INET, &localAddr.sin_addr, localBuffer, sizeof(localBuffer)) != nullptr) {
+        this->localIP = localBuffer;
+    }
 
     this->rtpPort = -1;
     this->rtcpPort = -1;
+    this->rtcpMux = false;
+    this->interleaved = false;
+    Touch();
 }
 
 /**
  * @brief 세션 버전을 반환하는 메서드
  * @return int 현재 세션의 버전 번호 (세션 ID와 동일한 값)
  */
-int ClientSession::GetVersion() const { return this->version; }
\ No newline at end of file
+uint64_t ClientSession::GetVersion() const { return this->version; }
+
+/**
+ * @details 송신 버퍼가 찰 때까지 출력 버퍼를 보내고 전송한 만큼 제거
+ *          EAGAIN 외의 오류는 연결을 shutdown하여 이벤트 루프가 정리하도록 함
+ */
+bool ClientSession::FlushPendingOutput() {
+    while (!pendingOutput.empty()) {
+        ssize_t sent = send(tcpSocket, pendingOutput.data(), pendingOutput.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            std::cerr << "Error: fail to send to client " << ip << std::endl;
+            ShutdownOutput();
+            return false;
+        }
+        pendingOutput.erase(0, sent);
+    }
+    UpdateWriteInterest();
+    return true;
+}
+
+/**
+ * @details 남은 출력을 버리고 shutdown하면 이벤트 루프가 연결 종료(EPOLLHUP)를 감지하여 세션을 정리
+ *          같은 입력 버퍼에 남은 요청의 응답은 보내지 않음
+ */
+void ClientSession::ShutdownOutput() {
+    outputClosed = true;
+    pendingOutput.clear();
+    shutdown(tcpSocket, SHUT_RDWR);
+    UpdateWriteInterest();
+}
+
+/**
+ * @details 상태가 바뀔 때만 콜백을 호출하여 epoll_ctl 호출을 줄임
+ */
+void ClientSession::UpdateWriteInterest() {
+    const bool wanted = !pendingOutput.empty();
+    if (wanted != writeInterest && onWriteInterest) {
+        onWriteInterest(wanted);
+        writeInterest = wanted;
+    }
+}
+
+/**
+ * @details SO_SNDBUF는 커널이 관리 오버헤드를 포함해 두 배로 잡으므로 절반을 데이터 용량으로 보고,
+ *          SIOCOUTQ로 아직 전송되지 않은 바이트를 빼서 계산
+ */
+int64_t ClientSession::GetSendBufferSpace() {
+    if (sendBufferSize == 0) {
+        socklen_t optionLen = sizeof(sendBufferSize);
+        if (getsockopt(tcpSocket, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, &optionLen) == -1) {
+            sendBufferSize = -1;
+        }
+    }
+    int queued = 0;
+    if (sendBufferSize <= 0 || ioctl(tcpSocket, SIOCOUTQ, &queued) == -1) {
+        return INT64_MAX;  // 알 수 없으면 writev 결과로 판단
+    }
+    return (int64_t)sendBufferSize / 2 - queued;
+}
+
+/**
+ * @details
+ *   - 출력 버퍼와 이번 데이터를 합친 크기보다 송신 버퍼 여유가 작으면 출력 버퍼만 보내고 이번 데이터는 버림
+ *     (패킷 경계가 깨지지 않도록 통째로)
+ *   - 출력 버퍼가 남아 있으면 그 뒤에 이번 조각들을 붙여 논블로킹 writev(sendmsg) 한 번으로 전송
+ *   - 보낸 만큼 출력 버퍼에서 제거하고, 이번 데이터 중 보내지 못한 바이트만 복사하여 보관
+ */
+bool ClientSession::WriteInterleaved(const struct iovec* iov, int iovCount) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (tcpSocket < 0 || outputClosed) {
+        return false;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < iovCount; i++) {
+        total += iov[i].iov_len;
+    }
+    if ((int64_t)(pendingOutput.size() + total) > GetSendBufferSpace()) {
+        FlushPendingOutput();
+        return false;
+    }
+
+    writeVector.clear();
+    if (!pendingOutput.empty()) {
+        writeVector.push_back({(void*)pendingOutput.data(), pendingOutput.size()});
+    }
+    writeVector.insert(writeVector.end(), iov, iov + iovCount);
+
+    struct msghdr msg{};
+    msg.msg_iov = writeVector.data();
+    msg.msg_iovlen = writeVector.size();
+    ssize_t sent;
+    do {
+        sent = sendmsg(tcpSocket, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+        return false;
+    }
+
+    // 출력 버퍼부터 보낸 만큼 제거하고, 일부만 전송된 이번 데이터는 패킷 경계를 지키기 위해 나머지를 보관
+    size_t skip = sent;
+    const size_t pendingSent = std::min(skip, pendingOutput.size());
+    pendingOutput.erase(0, pendingSent);
+    skip -= pendingSent;
+    for (int i = 0; i < iovCount; i++) {
+        if (skip >= iov[i].iov_len) {
+            skip -= iov[i].iov_len;
+            continue;
+        }
+        pendingOutput.append((const char*)iov[i].iov_base + skip, iov[i].iov_len - skip);
+        skip = 0;
+    }
+    UpdateWriteInterest();
+    return true;
+}
+
+/**
+ * @details 출력 버퍼 뒤에 응답을 붙이고 보낼 수 있는 만큼 바로 전송
+ *          출력 버퍼가 한도를 넘으면 응답을 읽지 않는 클라이언트로 보고 연결을 shutdown
+ */
+void ClientSession::SendRTSPResponse(std::string& response) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (tcpSocket < 0 || outputClosed) {
+        return;
+    }
+    if (pendingOutput.size() + response.size() > max_output_backlog) {
+        std::cerr << "Client " << ip << " output backlog exceeded " << max_output_backlog << " bytes, closing." << std::endl;
+        ShutdownOutput();
+        return;
+    }
+    pendingOutput += response;
+    FlushPendingOutput();
+}
+
+/**
+ * @details 이벤트 루프 스레드에서 호출되며 미디어 송신 워커와 같은 쓰기 잠금 사용
+ */
+bool ClientSession::OnWritable() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (tcpSocket < 0 || outputClosed) {
+        return false;
+    }
+    return FlushPendingOutput();
+}
+
+/**
+ * @details 세션 버전은 SDP에 이미 알린 값이므로 유지
+ */
+void ClientSession::RegenerateID() {
+    this->id = NewSessionID();
+}
+
+/**
+ * @brief 단조 시계의 현재 시간을 ms 단위로 반환하는 함수
+ */
+static int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @details 여러 스레드(이벤트 루프, RTCP 수신)에서 호출되므로 원자적으로 기록
+ */
+void ClientSession::Touch() {
+    lastActivityMs.store(NowMs(), std::memory_order_relaxed);
+}
+
+/**
+ * @details 현재 시간과 마지막 활동 시간의 차이
+ */
+int64_t ClientSession::GetIdleMs() {
+    return NowMs() - lastActivityMs.load(std::memory_order_relaxed);
+}
+
+/**
+ * @details 소켓 번호는 이벤트 루프가 정리할 때까지 유지되므로 쓰기 잠금 아래에서 shutdown만 수행
+ */
+void ClientSession::Expire() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (tcpSocket >= 0) {
+        shutdown(tcpSocket, SHUT_RDWR);
+    }
+}
+
+/**
+ * @details 출력 버퍼에 남은 데이터는 버림
+ */
+void ClientSession::CloseConnection() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (tcpSocket >= 0) {
+        close(tcpSocket);
+        tcpSocket = -1;
+    }
+    pendingOutput.clear();
+}
@@ -8,59 +8,157 @@
  */
 
 #include "DataCapture.h"
+#include <chrono>
 #include <cstring>
 #include <iostream>
 
+/**
+ * @brief steady clock 기준 현재 시각을 ms 단위로 반환하는 함수
+ */
+static int64_t NowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 /**
  * @details
- *   - 버퍼가 가득 차지 않은 경우만 프레임 추가
- *   - 필요시 새로운 메모리 할당 또는 기존 메모리 재사용
- *   - 스레드 안전성을 위한 뮤텍스 사용
+ *   - 가장 오래된 슬롯을 덮어쓰며 프레임 추가
+ *   - 세션이나 송신 워커의 링이 아직 슬롯 데이터를 참조 중이면 새 버퍼를 할당, 아니면 기존 메모리 재사용
+ *   - 키프레임이 들어오면 대기 중인 키프레임 요청 해제
+ *   - 스레드 안전성을 위한 뮤텍스 사용 후 대기 중인 세션을 깨우고 onFrameEvent로 기록한 프레임을 송신 워커에 전달
+ *   - onFrameEvent는 frameEventMutex를 잡고 호출하여 setFrameEvent와 겹치지 않도록 함
  */
 void DataCapture::pushFrame(const DataCaptureFrame& frame)
 {
-    if(!isFullBuffer()){
-        bufferMutex.lock();
-        if(frameBuffer[tail].dataPtr == nullptr){
-            frameBuffer[tail].dataPtr = new unsigned char[frame.size];
-        }else if(frameBuffer[tail].size < frame.size){
-            delete[] frameBuffer[tail].dataPtr;
-            frameBuffer[tail].dataPtr = new unsigned char[frame.size];
+    DataCaptureSharedFrame written;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        Slot& slot = frameBuffer[writeSeq % buffer_max_size];
+        if (!slot.data || slot.data.use_count() > 1) {
+            slot.data = std::make_shared<std::vector<unsigned char>>();
         }
+        slot.data->assign(frame.dataPtr, frame.dataPtr + frame.size);
+        slot.timestamp = frame.timestamp;
+        slot.keyframe = frame.keyframe;
 
-        memcpy(frameBuffer[tail].dataPtr, frame.dataPtr, frame.size);
-        frameBuffer[tail].size = frame.size;
-        frameBuffer[tail].timestamp = frame.timestamp;
+        written.data = slot.data;
+        written.timestamp = slot.timestamp;
+        written.keyframe = slot.keyframe;
+        written.sequence = writeSeq;
+        writeSeq++;
+        if (buffer_size < buffer_max_size) {
+            buffer_size++;
+        }
 
+        const int64_t now = NowMs();
+        if (bitrateWindowStartMs == 0) {
+            bitrateWindowStartMs = now;
+        }
+        bitrateWindowBytes += frame.size;
+        if (now - bitrateWindowStartMs >= bitrate_window_ms) {
+            bitrate = bitrateWindowBytes * 8 * 1000 / (now - bitrateWindowStartMs);
+            bitrateWindowStartMs = now;
+            bitrateWindowBytes = 0;
+        }
+    }
+    if (frame.keyframe) {
+        keyframePending = false;
+    }
+    frameCondition.notify_all();
 
-        tail = (tail + 1) % buffer_max_size;
-        buffer_size++;
-        // std::cout << "push img \n"<<buffer_size;
-        bufferMutex.unlock();
+    std::lock_guard<std::mutex> lock(frameEventMutex);
+    if (onFrameEvent) {
+        onFrameEvent(written);
     }
 }
 
 /**
- * @brief 버퍼에서 프레임을 추출하는 메서드
- * @return DataCaptureFrame 추출된 프레임 데이터
+ * @details 호출 중에도 frameEventMutex를 잡고 있으므로 잠금을 얻은 시점에는 진행 중인 콜백이 없음
+ */
+void DataCapture::setFrameEvent(std::function<void(const DataCaptureSharedFrame&)> callback)
+{
+    std::lock_guard<std::mutex> lock(frameEventMutex);
+    onFrameEvent = std::move(callback);
+}
+
+/**
  * @details
- *   - 버퍼가 비어있는 경우 NULL 반환
- *   - FIFO 방식으로 가장 오래된 프레임을 반환
- *   - 스레드 안전성을 위한 뮤텍스 사용
+ *   - 읽을 프레임이 없으면 false 반환
+ *   - 이미 덮어써진 순번이면 남아 있는 가장 오래된 프레임부터 반환
+ *   - 프레임 데이터는 복사하지 않고 shared_ptr로 공유
  */
-DataCaptureFrame DataCapture::popFrame() 
+bool DataCapture::readFrame(uint64_t& readSeq, DataCaptureSharedFrame& frame)
 {
-    bufferMutex.lock();
-    if(isEmptyBuffer()) {
-        bufferMutex.unlock();
-        return {nullptr, 0, 0};
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (readSeq >= writeSeq) {
+        return false;
     }
 
-    auto ret = frameBuffer[head];
-    head = (head + 1) % buffer_max_size; // head 위치 갱신
-    // std::cout << "pop  img \n"<<buffer_size;
-    buffer_size--;
-    bufferMutex.unlock();
+    const uint64_t oldestSeq = writeSeq - buffer_size;
+    if (readSeq < oldestSeq) {
+        readSeq = oldestSeq;
+    }
 
-    return ret;
-}
\ No newline at end of file
+    const Slot& slot = frameBuffer[readSeq % buffer_max_size];
+    frame.data = slot.data;
+    frame.timestamp = slot.timestamp;
+    frame.keyframe = slot.keyframe;
+    frame.sequence = readSeq;
+    readSeq++;
+    return true;
+}
+
+/**
+ * @details 조건 변수로 새 프레임이 기록되거나 시간이 초과될 때까지 대기
+ */
+bool DataCapture::waitForFrame(uint64_t readSeq, int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    return frameCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                   [this, readSeq]() { return readSeq < writeSeq; });
+}
+
+/**
+ * @details 지금까지 기록된 프레임 수가 다음 기록 순번
+ */
+uint64_t DataCapture::getWriteSequence()
+{
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return writeSeq;
+}
+
+/**
+ * @details 가장 최근 프레임부터 거꾸로 검색하여, 버퍼에 남아 있고 fromSeq 이상인 첫 키프레임을 반환
+ */
+bool DataCapture::findLatestKeyframe(uint64_t fromSeq, uint64_t& keySeq)
+{
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    const uint64_t oldestSeq = writeSeq - buffer_size;
+    const uint64_t lowerSeq = fromSeq > oldestSeq ? fromSeq : oldestSeq;
+
+    for (uint64_t seq = writeSeq; seq > lowerSeq; seq--) {
+        if (frameBuffer[(seq - 1) % buffer_max_size].keyframe) {
+            keySeq = seq - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @details
+ *   - 대기 중인 요청이 없으면 대기 상태로 전환하고 true 반환
+ *   - 대기 중인 요청이 있으면 병합하고 false 반환
+ *   - 소스가 요청을 놓친 경우를 대비해 일정 시간이 지나면 다시 전달을 허용
+ */
+bool DataCapture::markKeyframePending()
+{
+    const int64_t now = NowMs();
+
+    if (keyframePending.exchange(true) && now - keyframeRequestTimeMs < keyframe_request_timeout_ms) {
+        return false;
+    }
+    keyframeRequestTimeMs = now;
+    return true;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file EventLoop.cpp
+ * @brief EventLoop 클래스의 구현부
+ * @details EventLoop 클래스의 멤버 함수를 구현한 소스 파일
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "EventLoop.h"
+#include "ThreadRegistry.h"
+
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+/**
+ * @details epoll 인스턴스와 종료 요청을 전달할 eventfd를 만들고 eventfd를 감시 대상에 추가
+ */
+EventLoop::EventLoop() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd == -1 || wakeupFd == -1) {
+        std::cerr << "Error: fail to create epoll instance: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeupFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &event);
+}
+
+/**
+ * @details 루프 스레드를 종료시킨 뒤 디스크립터를 닫음
+ */
+EventLoop::~EventLoop() {
+    Stop();
+    if (wakeupFd != -1) close(wakeupFd);
+    if (epollFd != -1) close(epollFd);
+}
+
+/**
+ * @details 루프 스레드를 하나만 시작
+ */
+bool EventLoop::Start() {
+    if (epollFd == -1 || wakeupFd == -1) {
+        return false;
+    }
+    if (running.exchange(true)) {
+        return true;
+    }
+    loopThread = std::thread(&EventLoop::Run, this);
+    return true;
+}
+
+/**
+ * @details eventfd에 값을 써서 epoll_wait를 깨우고, 루프 스레드가 아닌 곳에서 호출했으면 종료를 기다림
+ */
+void EventLoop::Stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(wakeupFd, &one, sizeof(one)) < 0) {
+        std::cerr << "Error: fail to wake up event loop" << std::endl;
+    }
+    if (loopThread.joinable()) {
+        if (loopThread.get_id() == std::this_thread::get_id()) {
+            loopThread.detach();
+        } else {
+            loopThread.join();
+        }
+    }
+}
+
+/**
+ * @details 콜백을 먼저 테이블에 넣은 뒤 epoll에 등록하여 첫 이벤트부터 콜백을 찾을 수 있도록 함
+ */
+bool EventLoop::Add(int fd, uint32_t events, Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        callbacks[fd] = std::make_shared<Callback>(std::move(callback));
+    }
+
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        std::cerr << "Error: fail to add fd " << fd << " to epoll: " << strerror(errno) << std::endl;
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        callbacks.erase(fd);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @details EPOLL_CTL_MOD로 감시할 이벤트 비트만 변경
+ */
+bool EventLoop::Modify(int fd, uint32_t events) {
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+/**
+ * @details epoll에서 제거하고 콜백 테이블에서 삭제 (호출 중인 콜백은 Run이 잡고 있는 참조로 유지됨)
+ */
+void EventLoop::Remove(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    std::lock_guard<std::mutex> lock(callbackMutex);
+    callbacks.erase(fd);
+}
+
+/**
+ * @details 콜백이 테이블을 수정하므로 복사본을 순회 (루프 스레드가 멈춘 뒤이므로 동시에 호출되지 않음)
+ */
+void EventLoop::HangUpAll() {
+    std::vector<std::shared_ptr<Callback>> remaining;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        for (auto& entry : callbacks) {
+            remaining.push_back(entry.second);
+        }
+    }
+    for (auto& callback : remaining) {
+        (*callback)(EPOLLHUP);
+    }
+}
+
+/**
+ * @details 콜백 테이블 크기를 반환
+ */
+size_t EventLoop::GetCount() {
+    std::lock_guard<std::mutex> lock(callbackMutex);
+    return callbacks.size();
+}
+
+/**
+ * @details
+ *   - control 역할로 등록하여 설정된 CPU/우선순위에서 실행
+ *   - epoll_wait로 최대 max_events개의 이벤트를 한 번에 가져옴
+ *   - 이벤트마다 콜백을 찾아 참조를 잡은 채로 호출 (같은 배치에서 앞선 콜백이 제거한 소켓은 건너뜀)
+ *   - eventfd 이벤트는 Stop 요청으로 처리
+ */
+void EventLoop::Run() {
+    epoll_event events[max_events];
+    ThreadRegistry::GetInstance().Enter(eThreadRole_Control, "rtsp-loop");
+
+    while (running) {
+        int eventCount = epoll_wait(epollFd, events, max_events, -1);
+        if (eventCount == -1) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error: epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < eventCount && running; i++) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeupFd) {
+                uint64_t value;
+                while (read(wakeupFd, &value, sizeof(value)) > 0) {}
+                continue;
+            }
+
+            std::shared_ptr<Callback> callback;
+            {
+                std::lock_guard<std::mutex> lock(callbackMutex);
+                auto it = callbacks.find(fd);
+                if (it == callbacks.end()) continue;
+                callback = it->second;
+            }
+            (*callback)(events[i].events);
+        }
+    }
+    ThreadRegistry::GetInstance().Leave();
+}
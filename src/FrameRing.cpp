@@ -0,0 +1,82 @@
+/**
+ * @file FrameRing.cpp
+ * @brief FrameRing 클래스의 구현부
+ * @details FrameRing 클래스의 멤버 함수를 구현한 소스 파일
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "FrameRing.h"
+
+/**
+ * @details 슬롯을 미리 만들어 두어 프레임마다 할당하지 않음
+ */
+FrameRing::FrameRing() : slots(ring_size) {
+}
+
+/**
+ * @details
+ *   - 첫 프레임이거나 순번이 건너뛰었으면 그 프레임부터 연속 구간을 새로 시작
+ *   - 이미 지나간 순번(중복)은 무시
+ */
+void FrameRing::pushFrame(const DataCaptureSharedFrame& frame) {
+    if (frame.sequence < writeSeq) {
+        return;
+    }
+    if (frame.sequence != writeSeq) {
+        firstSeq = frame.sequence;
+    }
+    slots[frame.sequence % ring_size] = frame;
+    writeSeq = frame.sequence + 1;
+}
+
+/**
+ * @details 프레임을 복사하지 않고 슬롯을 가리킴 (공유 데이터 참조 카운트를 건드리지 않음)
+ */
+const DataCaptureSharedFrame* FrameRing::readFrame(uint64_t& readSeq) {
+    if (readSeq >= writeSeq) {
+        return nullptr;
+    }
+    const uint64_t oldestSeq = OldestSequence();
+    if (readSeq < oldestSeq) {
+        readSeq = oldestSeq;
+    }
+    const DataCaptureSharedFrame* frame = &slots[readSeq % ring_size];
+    readSeq++;
+    return frame;
+}
+
+/**
+ * @details 가장 최근 프레임부터 거꾸로 검색
+ */
+bool FrameRing::findLatestKeyframe(uint64_t fromSeq, uint64_t& keySeq) const {
+    const uint64_t oldestSeq = OldestSequence();
+    const uint64_t lowerSeq = fromSeq > oldestSeq ? fromSeq : oldestSeq;
+
+    for (uint64_t seq = writeSeq; seq > lowerSeq; seq--) {
+        if (slots[(seq - 1) % ring_size].keyframe) {
+            keySeq = seq - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @details 순번은 유지하고 데이터 참조만 해제
+ */
+void FrameRing::clear() {
+    for (auto& slot : slots) {
+        slot = DataCaptureSharedFrame();
+    }
+    firstSeq = writeSeq;
+}
+
+/**
+ * @details 연속 구간의 시작과 링 크기 중 늦은 쪽
+ */
+uint64_t FrameRing::OldestSequence() const {
+    const uint64_t ringStart = writeSeq > (uint64_t)ring_size ? writeSeq - ring_size : 0;
+    return firstSeq > ringStart ? firstSeq : ringStart;
+}
@@ -8,41 +8,144 @@
  */
 
 #include "Global.h"
+#include "NTPClock.h"
 
 #include <chrono>
 #include <random>
+#include <cerrno>
 #include <netdb.h>
 #include <iomanip>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/random.h>
 
 /**
  * @details 이 함수는 현재 시간을 NTP(Network Time Protocol)타임스탬프 형식으로 반환
+ *          벽시계를 매번 읽지 않고 NTPClock의 단조 시계 기준점에서 계산하므로 NTP 조정에 의해 건너뛰지 않음
  */
 uint64_t GetTime() {
-    auto now = std::chrono::system_clock::now();
-    auto msSinceEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-    uint32_t ntpSeconds = (msSinceEpoch / 1000) + 2208988800U; // 1970 to 1900
-    uint32_t ntpFraction = (msSinceEpoch % 1000) * 4294967;
-    uint64_t ntpTime = ((uint64_t)ntpSeconds << 32) | ntpFraction;
-    return ntpTime;
+    return NTPClock::getInstance().GetNTPTime();
 }
 
 /**
- * @details 이 함수는 입력으로 받은 비트 수(n)에 따라 16비트 또는 32비트 범위의 랜덤 숫자를 생성하여 반환
+ * @brief 32비트 값을 왼쪽으로 회전하는 함수
+ */
+static inline uint32_t RotateLeft(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+/**
+ * @brief ChaCha20 quarter round (RFC 8439 2.1)
+ */
+static inline void QuarterRound(uint32_t* x, int a, int b, int c, int d) {
+    x[a] += x[b]; x[d] = RotateLeft(x[d] ^ x[a], 16);
+    x[c] += x[d]; x[b] = RotateLeft(x[b] ^ x[c], 12);
+    x[a] += x[b]; x[d] = RotateLeft(x[d] ^ x[a], 8);
+    x[c] += x[d]; x[b] = RotateLeft(x[b] ^ x[c], 7);
+}
+
+/**
+ * @class ChaChaGenerator
+ * @brief 스레드별 ChaCha20 키 스트림 난수 생성기
+ * @details 상태: 상수 4워드, 키 8워드, 64비트 블록 카운터, 64비트 nonce (RFC 8439 2.3, 원래 ChaCha 배치)
+ *          블록 하나(64바이트)로 64비트 값 8개를 만들며, 카운터가 2^64 블록 안에서 겹치지 않으므로 재시드하지 않음
+ */
+class ChaChaGenerator {
+public:
+    /**
+     * @details getrandom(2)으로 키와 nonce를 받고, 실패하면 std::random_device로 채움
+     */
+    ChaChaGenerator() {
+        uint32_t seed[10];
+        size_t filled = 0;
+        while (filled < sizeof(seed)) {
+            ssize_t got = getrandom((char*)seed + filled, sizeof(seed) - filled, 0);
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            filled += got;
+        }
+        if (filled < sizeof(seed)) {
+            std::random_device rd;
+            for (uint32_t& word : seed) {
+                word = rd();
+            }
+        }
+        state[0] = 0x61707865; state[1] = 0x3320646e; state[2] = 0x79622d32; state[3] = 0x6b206574;  // "expand 32-byte k"
+        for (int i = 0; i < 8; i++) {
+            state[4 + i] = seed[i];
+        }
+        state[12] = 0;
+        state[13] = 0;
+        state[14] = seed[8];
+        state[15] = seed[9];
+    }
+
+    uint64_t Next() {
+        if (used >= block_words) {
+            Refill();
+        }
+        uint64_t value = (uint64_t)block[used] | ((uint64_t)block[used + 1] << 32);
+        used += 2;
+        return value;
+    }
+
+private:
+    static const int block_words = 16;
+
+    /**
+     * @details 20라운드(열/대각선 라운드 10번) 후 입력 상태를 더하고 블록 카운터 증가
+     */
+    void Refill() {
+        for (int i = 0; i < block_words; i++) {
+            block[i] = state[i];
+        }
+        for (int round = 0; round < 10; round++) {
+            QuarterRound(block, 0, 4, 8, 12);
+            QuarterRound(block, 1, 5, 9, 13);
+            QuarterRound(block, 2, 6, 10, 14);
+            QuarterRound(block, 3, 7, 11, 15);
+            QuarterRound(block, 0, 5, 10, 15);
+            QuarterRound(block, 1, 6, 11, 12);
+            QuarterRound(block, 2, 7, 8, 13);
+            QuarterRound(block, 3, 4, 9, 14);
+        }
+        for (int i = 0; i < block_words; i++) {
+            block[i] += state[i];
+        }
+        if (++state[12] == 0) {
+            state[13]++;
+        }
+        used = 0;
+    }
+
+    uint32_t state[block_words];
+    uint32_t block[block_words];
+    int used = block_words;
+};
+
+/**
+ * @details 스레드마다 생성기를 따로 두어 잠금 없이 호출
+ */
+uint64_t GetRandom64() {
+    thread_local ChaChaGenerator generator;
+    return generator.Next();
+}
+
+/**
+ * @details 하위 n비트만 사용하므로 범위 안에서 균등하게 분포
  */
 uint32_t GetRanNum(int n) {
-    std::random_device rd; // make random seed
-    std::mt19937 generator(rd()); // init random number generator
-    if (n == 32) {
-        // generate random number between 0 and 2^32-1
-        std::uniform_int_distribution<uint32_t> distribution(1, 0xFFFFFFFF);
-        return distribution(generator);
-    } else if (n == 16) {
-        std::uniform_int_distribution<uint32_t> distribution(1, 65535);
-        return distribution(generator);
+    if (n != 16 && n != 32) {
+        return 0;
     }
-    return 0;
+    const uint64_t mask = (n == 32) ? 0xFFFFFFFFULL : 0xFFFFULL;
+    uint32_t value;
+    do {
+        value = (uint32_t)(GetRandom64() & mask);
+    } while (value == 0);
+    return value;
 }
 
 /**
@@ -16,6 +16,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <algorithm>
 
 #include <arpa/inet.h>
 #include <fcntl.h>
@@ -31,6 +32,7 @@
  *   - 파일 크기 확인
  *   - mmap을 사용하여 파일을 메모리에 매핑
  *   - 초기 포인터 설정
+ *   - 액세스 유닛 색인 생성
  * @throw std::runtime_error 파일 열기 또는 메모리 매핑 실패 시
  */
 H264Encoder::H264Encoder(const char *filename)
@@ -45,6 +47,7 @@ H264Encoder::H264Encoder(const char *filename)
     this->ptr_mapped_file_start = this->ptr_mapped_file_cur = reinterpret_cast<uint8_t *>(mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, this->fd, 0));
     this->ptr_mapped_file_end = this->ptr_mapped_file_start + this->file_size;
     assert(this->ptr_mapped_file_cur != MAP_FAILED);
+    build_index();
 }
 
 /**
@@ -122,4 +125,173 @@ std::pair<const uint8_t *, int64_t> H264Encoder::get_next_frame()
     auto ptr_ret = this->ptr_mapped_file_cur;
     this->ptr_mapped_file_cur += frame_size;
     return {ptr_ret, frame_size};
-}
\ No newline at end of file
+}
+
+/**
+ * @details start code(3 또는 4바이트) 다음 바이트의 하위 5비트가 NALU 타입
+ */
+uint8_t H264Encoder::get_nalu_type(const uint8_t *_frame, const int64_t frame_len)
+{
+    if (H264Encoder::is_start_code(_frame, frame_len, 4) && frame_len > 4)
+        return _frame[4] & NALU_TYPE_MASK;
+    if (H264Encoder::is_start_code(_frame, frame_len, 3) && frame_len > 3)
+        return _frame[3] & NALU_TYPE_MASK;
+    return 0;
+}
+
+/**
+ * @details 액세스 유닛 경계 (H.264 7.4.1.2.3을 단순화):
+ *   - 슬라이스(VCL) 뒤에 나온 AUD, SEI, SPS, PPS, 예약 타입(14~18)은 다음 액세스 유닛의 시작
+ *   - 슬라이스 뒤에 나온 first_mb_in_slice가 0인 슬라이스는 다음 픽처의 시작
+ *     (first_mb_in_slice는 슬라이스 헤더의 첫 ue(v) 값이므로, 0이면 NAL 헤더 다음 바이트의 최상위 비트가 1)
+ *   - 4바이트 start code는 앞의 0x00을 포함하도록 위치를 보정
+ */
+void H264Encoder::build_index()
+{
+    this->access_units.clear();
+    this->random_access_units.clear();
+    bool unit_has_slice = false;
+    bool unit_has_idr = false;
+    for (const uint8_t *p = this->ptr_mapped_file_start; p + 4 < this->ptr_mapped_file_end; ++p) {
+        if (p[0] != 0x00 || p[1] != 0x00 || p[2] != 0x01)
+            continue;
+        const uint8_t type = p[3] & NALU_TYPE_MASK;
+        const bool is_slice = type >= 1 && type <= NALU_TYPE_IDR;
+        const bool starts_unit = this->access_units.empty()
+                              || (unit_has_slice && (is_slice ? (p[4] & 0x80) != 0 : (type == 6 || type == 7 || type == 8 || type == 9 || (type >= 14 && type <= 18))));
+        if (starts_unit) {
+            if (unit_has_idr)
+                this->random_access_units.push_back(static_cast<int64_t>(this->access_units.size()) - 1);
+            const uint8_t *unit_start = (p > this->ptr_mapped_file_start && p[-1] == 0x00) ? p - 1 : p;
+            this->access_units.push_back(unit_start - this->ptr_mapped_file_start);
+            unit_has_slice = unit_has_idr = false;
+        }
+        unit_has_slice |= is_slice;
+        unit_has_idr |= type == NALU_TYPE_IDR;
+        p += 3;
+    }
+    if (unit_has_idr)
+        this->random_access_units.push_back(static_cast<int64_t>(this->access_units.size()) - 1);
+}
+
+int64_t H264Encoder::get_access_unit() const
+{
+    const int64_t offset = this->ptr_mapped_file_cur - this->ptr_mapped_file_start;
+    return std::upper_bound(this->access_units.begin(), this->access_units.end(), offset) - this->access_units.begin() - 1;
+}
+
+double H264Encoder::get_duration(const double fps) const
+{
+    return fps > 0 ? this->access_units.size() / fps : 0.0;
+}
+
+int64_t H264Encoder::get_access_unit_size(const int64_t unit) const
+{
+    if (unit < 0 || unit >= get_access_unit_count())
+        return 0;
+    const int64_t end = (unit + 1 < get_access_unit_count()) ? this->access_units[unit + 1] : this->file_size;
+    return end - this->access_units[unit];
+}
+
+int64_t H264Encoder::find_random_access_unit(const int64_t unit, const int direction) const
+{
+    auto it = (direction >= 0)
+            ? std::upper_bound(this->random_access_units.begin(), this->random_access_units.end(), unit)
+            : std::lower_bound(this->random_access_units.begin(), this->random_access_units.end(), unit);
+    if (direction > 0)
+        return (it != this->random_access_units.end()) ? *it : -1;
+    return (it != this->random_access_units.begin()) ? *(it - 1) : -1;
+}
+
+bool H264Encoder::seek_to_access_unit(const int64_t unit)
+{
+    if (unit < 0 || unit >= get_access_unit_count())
+        return false;
+    this->ptr_mapped_file_cur = this->ptr_mapped_file_start + this->access_units[unit];
+    return true;
+}
+
+/**
+ * @details 요청 시각의 액세스 유닛 번호를 구하고, 그 번호 이하의 마지막 IDR 액세스 유닛으로 이동
+ */
+double H264Encoder::seek_to_time(const double seconds, const double fps)
+{
+    if (fps <= 0 || seconds < 0)
+        return -1.0;
+    const int64_t target = static_cast<int64_t>(seconds * fps);
+    if (target >= get_access_unit_count())
+        return -1.0;
+    const int64_t unit = find_random_access_unit(target, 0);
+    if (!seek_to_access_unit(unit))
+        return -1.0;
+    return unit / fps;
+}
+
+/**
+ * @details
+ *   - 현재 위치가 IDR 액세스 유닛의 시작이면 그대로 둠
+ *   - 아니면 현재 액세스 유닛 다음의 첫 IDR 액세스 유닛을 이진 탐색하여 앞으로만 이동
+ *     (파일을 여러 시청자가 공유하므로 뒤로 되감지 않음)
+ */
+bool H264Encoder::seek_to_keyframe()
+{
+    const int64_t current = get_access_unit();
+    if (current >= 0 && find_random_access_unit(current, 0) == current
+        && this->ptr_mapped_file_cur == this->ptr_mapped_file_start + this->access_units[current])
+        return true;
+    const int64_t forward_unit = find_random_access_unit(current, 1);
+    return seek_to_access_unit(forward_unit);
+}
+
+/**
+ * @details
+ *   - start code마다 NAL 유닛을 잘라 타입 확인 (NAL 끝의 trailing zero는 다음 4바이트 start code의 일부이므로 제외)
+ *   - SPS/PPS는 처음 나온 것만 저장
+ *   - 슬라이스 NAL 유닛(타입 1~5)이 나오면 검색 종료
+ */
+bool H264Encoder::find_parameter_sets(const uint8_t *_buffer, const int64_t buffer_len, std::string &sps, std::string &pps)
+{
+    if (buffer_len < 4)
+        return false;
+    bool found_sps = false;
+    bool found_pps = false;
+    const uint8_t *end = _buffer + buffer_len;
+    const uint8_t *cur = H264Encoder::find_next_start_code(_buffer, buffer_len);
+    while (cur != nullptr && cur < end) {
+        const int64_t start_len = H264Encoder::is_start_code(cur, end - cur, 4) ? 4 : 3;
+        const uint8_t *nalu = cur + start_len;
+        if (nalu >= end)
+            break;
+        const uint8_t *next = (end - nalu > 3) ? H264Encoder::find_next_start_code(nalu, end - nalu) : nullptr;
+        const uint8_t *nalu_end = next ? next : end;
+        while (nalu_end > nalu && nalu_end[-1] == 0x00)
+            --nalu_end;
+
+        const uint8_t type = nalu[0] & NALU_TYPE_MASK;
+        if (type == NALU_TYPE_SPS && !found_sps) {
+            sps.assign(reinterpret_cast<const char *>(nalu), nalu_end - nalu);
+            found_sps = true;
+        } else if (type == NALU_TYPE_PPS && !found_pps) {
+            pps.assign(reinterpret_cast<const char *>(nalu), nalu_end - nalu);
+            found_pps = true;
+        } else if (type >= 1 && type <= NALU_TYPE_IDR) {
+            break;
+        }
+        if (found_sps && found_pps)
+            break;
+        cur = next;
+    }
+    return found_sps && found_pps;
+}
+
+bool H264Encoder::get_parameter_sets(std::string &sps, std::string &pps) const
+{
+    return H264Encoder::find_parameter_sets(this->ptr_mapped_file_start, this->file_size, sps, pps);
+}
+
+int64_t H264Encoder::estimate_bitrate(const double fps) const
+{
+    if (this->access_units.empty() || fps <= 0)
+        return 0;
+    return static_cast<int64_t>(this->file_size * 8 * fps / this->access_units.size());
+}
@@ -0,0 +1,341 @@
+/**
+ * @file IOBackend.cpp
+ * @brief IOBackend 클래스의 구현부
+ * @details IOBackend 클래스의 멤버 함수를 구현한 소스 파일
+ *          io_uring은 liburing 없이 커널 헤더와 시스템 콜로 직접 사용
+ * 
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "IOBackend.h"
+
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <unistd.h>
+
+#if RTSP_HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/**
+ * @class UringRing
+ * @brief 스레드 하나가 사용하는 io_uring 제출/완료 링
+ */
+class UringRing {
+public:
+    /**
+     * @brief 링을 생성하고 제출/완료 큐를 매핑하는 메서드
+     * @param entries 제출 큐 크기
+     * @return bool 성공 여부 (커널이 io_uring을 지원하지 않으면 false)
+     */
+    bool Setup(unsigned entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ringFd = (int)syscall(__NR_io_uring_setup, entries, &params);
+        if (ringFd < 0) {
+            return false;
+        }
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) {
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        }
+
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            sqRing = nullptr;
+            return false;
+        }
+        if (singleMmap) {
+            cqRing = sqRing;
+        } else {
+            cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                cqRing = nullptr;
+                return false;
+            }
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe*)mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            sqes = nullptr;
+            return false;
+        }
+
+        char* sq = (char*)sqRing;
+        sqTail = (unsigned*)(sq + params.sq_off.tail);
+        sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+        sqArray = (unsigned*)(sq + params.sq_off.array);
+        char* cq = (char*)cqRing;
+        cqHead = (unsigned*)(cq + params.cq_off.head);
+        cqTail = (unsigned*)(cq + params.cq_off.tail);
+        cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+        capacity = params.sq_entries;
+        completedOk.assign(capacity, 0);
+        return true;
+    }
+
+    /**
+     * @brief 매핑을 해제하고 링을 닫는 소멸자
+     */
+    ~UringRing() {
+        if (sqes) munmap(sqes, sqesSize);
+        if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing) munmap(sqRing, sqRingSize);
+        if (ringFd >= 0) close(ringFd);
+    }
+
+    /**
+     * @brief 메시지들을 링크된 SENDMSG로 제출하고 모두 완료될 때까지 기다리는 메서드
+     * @return int 앞에서부터 성공 완료(CQE)가 확인된 메시지 수 (-1: 첫 메시지부터 실패, errno 설정)
+     * @details 링크(IOSQE_IO_LINK)로 묶여 있어 하나가 실패하면 뒤의 전송은 -ECANCELED로 취소된다.
+     *          커널이 호출자의 msghdr/iovec을 참조하므로 제출한 모든 완료를 거둔 뒤에 반환한다.
+     *          완료 대기가 일시적이지 않은 오류로 실패하면 링을 고장으로 표시하고 (IsBroken) 확인된 수만 반환한다.
+     *          이때 제출했지만 완료를 확인하지 못한 메시지는 커널이 이미 보냈을 수 있다 (GetSubmitted).
+     */
+    int SendMessages(int sockfd, struct mmsghdr* msgs, unsigned count, int flags) {
+        count = std::min(count, capacity);
+        unsigned tail = *sqTail;
+        for (unsigned i = 0; i < count; i++) {
+            const unsigned index = tail & sqMask;
+            io_uring_sqe* sqe = &sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = sockfd;
+            sqe->addr = (uint64_t)(uintptr_t)&msgs[i].msg_hdr;
+            sqe->len = 1;
+            sqe->msg_flags = flags;
+            sqe->user_data = i;
+            if (i + 1 < count) {
+                sqe->flags = IOSQE_IO_LINK;
+            }
+            sqArray[index] = index;
+            completedOk[i] = 0;
+            tail++;
+        }
+        __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+        int submitted;
+        lastSubmitted = 0;
+        do {
+            submitted = (int)syscall(__NR_io_uring_enter, ringFd, count, count, IORING_ENTER_GETEVENTS, nullptr, 0);
+        } while (submitted < 0 && errno == EINTR);
+        if (submitted < 0) {
+            // 제출 자체가 실패: 커널이 SQE를 가져가지 않았으므로 되돌림
+            __atomic_store_n(sqTail, tail - count, __ATOMIC_RELEASE);
+            return -1;
+        }
+        if ((unsigned)submitted < count) {
+            // 일부만 제출됨: 커널이 가져가지 않은 SQE는 다음 호출에 섞이지 않도록 되돌림
+            __atomic_store_n(sqTail, tail - (count - (unsigned)submitted), __ATOMIC_RELEASE);
+        }
+
+        lastSubmitted = (unsigned)submitted;
+
+        // 완료 수집: 제출한 수만큼 모두 거둔 뒤 반환 (남은 CQE가 다음 호출에 섞이지 않도록)
+        int firstError = 0;
+        unsigned completed = 0;
+        const unsigned expected = (unsigned)submitted;
+        while (completed < expected) {
+            unsigned head = *cqHead;
+            const unsigned ready = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            if (head == ready) {
+                if (syscall(__NR_io_uring_enter, ringFd, 0, expected - completed, IORING_ENTER_GETEVENTS, nullptr, 0) < 0
+                    && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    firstError = errno;
+                    broken = true;
+                    break;
+                }
+                continue;
+            }
+            for (; head != ready; head++, completed++) {
+                const io_uring_cqe& cqe = cqes[head & cqMask];
+                const unsigned index = (unsigned)cqe.user_data;
+                if (index >= count) {
+                    continue;
+                }
+                if (cqe.res < 0) {
+                    if (firstError == 0) {
+                        firstError = -cqe.res;
+                    }
+                } else {
+                    msgs[index].msg_len = (unsigned)cqe.res;
+                    completedOk[index] = 1;
+                }
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+
+        // 링크 순서상 처음으로 성공이 확인되지 않은 메시지 앞까지만 전송된 것으로 셈
+        unsigned sent = 0;
+        while (sent < expected && completedOk[sent]) {
+            sent++;
+        }
+        if (sent == 0) {
+            errno = firstError != 0 ? firstError : EIO;
+            return -1;
+        }
+        return (int)sent;
+    }
+
+    /**
+     * @brief 완료 대기가 복구할 수 없는 오류로 실패했는지 확인하는 메서드
+     * @return bool 고장 여부 (true면 이 링을 버리고 sendmmsg로 전송해야 함)
+     */
+    bool IsBroken() const {
+        return broken;
+    }
+
+    /**
+     * @brief 마지막 SendMessages에서 커널에 제출된 메시지 수를 반환하는 메서드
+     * @return unsigned 제출된 메시지 수 (이 뒤의 메시지는 커널에 전달된 적이 없음)
+     */
+    unsigned GetSubmitted() const {
+        return lastSubmitted;
+    }
+
+private:
+    int ringFd = -1;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    size_t sqesSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+    unsigned capacity = 0;
+    std::vector<unsigned char> completedOk; ///< 메시지별 성공 완료 여부
+    unsigned lastSubmitted = 0;             ///< 마지막 호출에서 제출된 메시지 수
+    bool broken = false;
+};
+
+static thread_local std::unique_ptr<UringRing> threadRing; ///< 호출 스레드의 링
+static thread_local bool threadRingFailed = false;          ///< 링 생성 실패 또는 고장 여부
+
+/**
+ * @brief 호출 스레드의 io_uring 링을 반환하는 함수
+ * @return UringRing* 링 (생성 실패 또는 고장 이후에는 nullptr)
+ */
+static UringRing* GetThreadRing() {
+    if (!threadRing && !threadRingFailed) {
+        threadRing = std::make_unique<UringRing>();
+        if (!threadRing->Setup(IOBackend::ring_entries)) {
+            threadRing.reset();
+            threadRingFailed = true;
+        }
+    }
+    return threadRing.get();
+}
+
+/**
+ * @brief 고장 난 링을 닫고 호출 스레드가 이후 sendmmsg를 사용하도록 하는 함수
+ * @details 링을 닫으면 커널이 남은 요청을 취소한다.
+ */
+static void DropThreadRing() {
+    std::cerr << "io_uring completion wait failed, fall back to sendmmsg: " << strerror(errno) << std::endl;
+    threadRing.reset();
+    threadRingFailed = true;
+}
+#endif
+
+/**
+ * @details io_uring은 빌드에 포함되어 있고 현재 커널에서 링을 만들 수 있을 때만 선택
+ */
+IOBackendType IOBackend::Init(IOBackendType _type) {
+    if (_type == eIOBackend_IoUring) {
+#if RTSP_HAVE_IO_URING
+        if (GetThreadRing() != nullptr) {
+            type = eIOBackend_IoUring;
+            std::cout << "RTP I/O backend: io_uring" << std::endl;
+            return type;
+        }
+        std::cerr << "io_uring is not available, fall back to sendmmsg: " << strerror(errno) << std::endl;
+#else
+        std::cerr << "io_uring support is not built in, fall back to sendmmsg" << std::endl;
+#endif
+    }
+    type = eIOBackend_Socket;
+    std::cout << "RTP I/O backend: sendmmsg" << std::endl;
+    return type;
+}
+
+/**
+ * @details 현재 백엔드로 전송 (io_uring 링을 만들 수 없는 스레드에서는 sendmmsg 사용)
+ */
+int IOBackend::SendMessages(int sockfd, struct mmsghdr* msgs, unsigned count, int flags) {
+    if (count == 0) {
+        return 0;
+    }
+    if (type == eIOBackend_IoUring) {
+        return SendMessagesIoUring(sockfd, msgs, count, flags);
+    }
+    return SendMessagesSocket(sockfd, msgs, count, flags);
+}
+
+/**
+ * @details sendmmsg가 일부만 보내고 돌아오면 나머지를 이어서 전송
+ */
+int IOBackend::SendMessagesSocket(int sockfd, struct mmsghdr* msgs, unsigned count, int flags) {
+    unsigned sent = 0;
+    while (sent < count) {
+        int result = sendmmsg(sockfd, msgs + sent, count - sent, flags);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            return sent > 0 ? (int)sent : -1;
+        }
+        sent += result;
+    }
+    return (int)sent;
+}
+
+/**
+ * @details 링 크기보다 많은 메시지는 나누어 제출
+ *          링이 고장 나면 제출된 메시지는 보낸 것으로 세고, 제출된 적 없는 메시지만 sendmmsg로 보냄
+ */
+int IOBackend::SendMessagesIoUring(int sockfd, struct mmsghdr* msgs, unsigned count, int flags) {
+#if RTSP_HAVE_IO_URING
+    UringRing* ring = GetThreadRing();
+    if (ring != nullptr) {
+        unsigned sent = 0;
+        while (sent < count) {
+            const unsigned batch = std::min(count - sent, (unsigned)ring_entries);
+            int result = ring->SendMessages(sockfd, msgs + sent, batch, flags);
+            if (ring->IsBroken()) {
+                // 제출한 메시지는 완료를 확인하지 못했어도 커널이 보냈을 수 있으므로 다시 보내지 않고 버림
+                // (중복 전송 방지), 제출된 적 없는 나머지만 sendmmsg로 전송
+                sent += ring->GetSubmitted();
+                DropThreadRing();
+                int rest = SendMessagesSocket(sockfd, msgs + sent, count - sent, flags);
+                if (rest < 0) {
+                    return sent > 0 ? (int)sent : -1;
+                }
+                return (int)(sent + rest);
+            }
+            if (result < 0) {
+                return sent > 0 ? (int)sent : -1;
+            }
+            sent += result;
+            if ((unsigned)result < batch) {
+                break;  // 중간에 실패하여 뒤의 링크가 취소됨
+            }
+        }
+        return (int)sent;
+    }
+#endif
+    return SendMessagesSocket(sockfd, msgs, count, flags);
+}
@@ -11,178 +11,374 @@
 #include "Global.h"
 #include "TCPHandler.h"
 #include "UDPHandler.h"
+#include "UDPServer.h"
 #include "MediaStreamHandler.h"
 #include "DataCapture.h"
+#include "FrameRing.h"
 #include "OpusEncoder.h"
 #include "H264Encoder.h"
 #include "RTPHeader.hpp"
 #include "RTPPacket.hpp"
+#include "NTPClock.h"
+#include "IOBackend.h"
+#include "ClientSession.h"
 
 #include <iostream>
 #include <cstdint>
 #include <cstring>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <chrono>
 #include <thread>
-#include <mutex>
+#include <memory>
 #include <utility>
 #include <random>
 #include <algorithm>
 
 /**
- * @details 스트림 상태를 초기화 상태로 설정
+ * @details 패킷마다 헤더(고정 헤더 + 헤더 확장 + FU 헤더)만 따로 두고 페이로드는 프레임 버퍼를 가리킴
+ *          헤더 앞에는 interleaved 프레이밍 헤더 자리를 비워 두어 TCP 전송 시에도 복사하지 않음
+ *          iov는 연속된 배열이므로 interleaved 전송 시 프레임 전체를 iovec 배열 하나로 writev
  */
-MediaStreamHandler::MediaStreamHandler(): streamState(MediaStreamState::eMediaStream_Init){}
+struct MediaStreamHandler::RTPBatch {
+    uint8_t headers[rtp_batch_size][interleaved_prefix_size + RTP_HEADER_SIZE + RTP_EXTENSION_SIZE + FU_SIZE]; ///< 패킷별 헤더
+    struct iovec iov[rtp_batch_size][2];  ///< 패킷별 [(프레이밍 헤더 +) 헤더, 페이로드]
+    struct mmsghdr msgs[rtp_batch_size];  ///< 전송할 메시지
+    unsigned count = 0;                   ///< 버퍼에 쌓인 패킷 수
+};
 
 /**
  * @details
- *   - 페이로드 크기에 따라 단일 패킷 또는 분할 패킷으로 전송
- *   - FU-A 형식으로 NAL 단위 분할 처리
- *   - RTP 헤더 마커 비트 설정
+ *   - 스트림 상태를 초기화 상태로 설정하고, 공유 소켓에서 RTCP를 구분할 수 있도록 임의의 SSRC 생성 (트랙마다 다른 SSRC)
+ *   - 세션 동안 재사용할 RTP 패킷을 임의의 시작 시퀀스 번호로 생성
  */
-void MediaStreamHandler::SendFragmentedRTPPackets(unsigned char* payload, size_t payloadSize, RTPPacket& rtpPacket) {
-    unsigned char nalHeader = payload[0]; // NAL 헤더 (첫 바이트)
+MediaStreamHandler::MediaStreamHandler(int track)
+    : track(track), ssrc(GetRanNum(32)), streamState(MediaStreamState::eMediaStream_Init) {
+    RTPHeader rtpHeader(0, 0, ssrc);
+    rtpHeader.set_payloadType(RTSPServer::getInstance().getTrackProtocol(track));
+    rtpHeader.set_seq((uint16_t)GetRanNum(16));
+    rtpPacket = std::make_unique<RTPPacket>(rtpHeader);
+    rtpBatch = std::make_unique<RTPBatch>();
+}
 
-    if (payloadSize <= MAX_RTP_DATA_SIZE) {
-        // 마커 비트 설정
-        rtpPacket.get_header().set_marker(1); // 단일 RTP 패킷이므로 마커 비트 활성화
+/**
+ * @details 재사용하는 RTP 패킷 헤더의 SSRC도 함께 변경
+ */
+void MediaStreamHandler::RegenerateSSRC() {
+    ssrc = GetRanNum(32);
+    rtpPacket->get_header().set_ssrc(ssrc);
+}
 
-        // 패킷 크기가 MTU 이하인 경우, 단일 RTP 패킷 전송
-        memcpy(rtpPacket.get_payload(), payload, payloadSize); // NAL 데이터 복사
+/**
+ * @details 해제된 핸들러로 RTCP가 분배되지 않도록 UDPServer 테이블에서 제거하고 UDPHandler 해제
+ */
+MediaStreamHandler::~MediaStreamHandler() {
+    UDPServer::GetInstance().Unregister(this);
+    delete udpHandler;
+}
 
-        rtpPacket.rtp_sendto(udpHandler->GetRTPSocket(), RTP_HEADER_SIZE + payloadSize, 0, (struct sockaddr *)(&udpHandler->GetRTPAddr()));
-        return;
+/**
+ * @brief 버려도 다른 프레임의 디코딩에 영향이 없는 H264 프레임인지 확인하는 함수
+ * @details start code가 있으면 건너뛰고 첫 NAL 헤더의 nal_ref_idc(NRI)가 0인 non-IDR 슬라이스인지 검사
+ */
+static bool IsDisposableFrame(const unsigned char* data, size_t size) {
+    size_t pos = 0;
+    while (pos < size && pos < 3 && data[pos] == 0x00) pos++;
+    if (pos >= 2 && pos < size && data[pos] == 0x01) pos++;
+    else pos = 0;
+    if (pos >= size) return false;
+    return (data[pos] & NALU_NRI_MASK) == 0 && (data[pos] & NALU_TYPE_MASK) == 1;
+}
+
+/**
+ * @details
+ *   - 마커 비트를 설정하고 현재 헤더를 패킷 슬롯에 기록 (시퀀스 번호 증가)
+ *   - interleaved 세션이면 '$', RTP 채널, 패킷 길이를 헤더 앞에 기록
+ *   - 버퍼가 가득 차 있으면 먼저 전송
+ */
+bool MediaStreamHandler::QueueRTPPacket(const uint8_t* prefix, size_t prefixSize, const uint8_t* data, size_t dataSize, bool marker) {
+    if (rtpBatch->count == rtp_batch_size && !FlushRTPPackets()) {
+        return false;
     }
 
-    const int64_t packetNum = payloadSize / MAX_RTP_DATA_SIZE;
-    const int64_t remainPacketSize = payloadSize % MAX_RTP_DATA_SIZE;
-    int64_t pos = 1;    // NAL 헤더(첫 바이트)는 별도 처리
+    RTPBatch& batch = *rtpBatch;
+    const unsigned index = batch.count++;
 
-    // 패킷 크기가 MTU를 초과하는 경우, FU-A로 분할
-    for (int i = 0; i < packetNum; i++) {
-        rtpPacket.get_payload()[0] = (nalHeader & NALU_F_NRI_MASK) | SET_FU_A_MASK;
-        rtpPacket.get_payload()[1] = nalHeader & NALU_TYPE_MASK;
-        rtpPacket.get_header().set_marker(0);
+    uint8_t* header = batch.headers[index] + interleaved_prefix_size;
+    rtpPacket->get_header().set_marker(marker);
+    int64_t headerSize = rtpPacket->write_header(header);
+    if (prefixSize > 0) {
+        memcpy(header + headerSize, prefix, prefixSize);
+        headerSize += prefixSize;
+    }
 
-        if (i == 0)
-        {
-            // 첫 번째 조각: FU-A Start
-            rtpPacket.get_payload()[1] = (nalHeader & NALU_TYPE_MASK) | FU_S_MASK;
-        }
-        else if (i == packetNum - 1 && remainPacketSize == 0)
-        {
-            // 마지막 조각: FU-A End
-            rtpPacket.get_payload()[1] = (nalHeader & NALU_TYPE_MASK) | FU_E_MASK;
-        }
-        else
-        {
-            // 중간 조각: FU-A Middle
-            rtpPacket.get_payload()[1] = (nalHeader & NALU_TYPE_MASK);
-        }
+    if (udpHandler == nullptr) {
+        const size_t packetSize = headerSize + dataSize;
+        header -= interleaved_prefix_size;
+        header[0] = '$';
+        header[1] = (uint8_t)rtpChannel;
+        header[2] = (uint8_t)(packetSize >> 8);
+        header[3] = (uint8_t)(packetSize & 0xFF);
+        headerSize += interleaved_prefix_size;
+    }
 
-        // RTP 패킷 생성
-        memcpy(rtpPacket.get_payload() + FU_SIZE, &payload[pos], MAX_RTP_DATA_SIZE); // 분할된 데이터 복사
-        rtpPacket.rtp_sendto(udpHandler->GetRTPSocket(), MAX_RTP_PACKET_LEN, 0, (struct sockaddr*)(&udpHandler->GetRTPAddr()));
+    batch.iov[index][0].iov_base = header;
+    batch.iov[index][0].iov_len = headerSize;
+    batch.iov[index][1].iov_base = (void *)data;
+    batch.iov[index][1].iov_len = dataSize;
+    if (udpHandler == nullptr) {
+        return true;
+    }
+
+    struct msghdr& msg = batch.msgs[index].msg_hdr;
+    memset(&batch.msgs[index], 0, sizeof(batch.msgs[index]));
+    msg.msg_name = &udpHandler->GetRTPAddr();
+    msg.msg_namelen = sizeof(sockaddr_in);
+    msg.msg_iov = batch.iov[index];
+    msg.msg_iovlen = 2;
+    return true;
+}
+
+/**
+ * @details MSG_DONTWAIT로 전송하여 송신 큐가 가득 차면 블로킹하지 않고 나머지 패킷을 버림
+ *          interleaved 세션은 TCP 송신 버퍼에 여유가 없으면 패킷 전체를 버림 (스트림 중간이 잘리지 않음)
+ */
+bool MediaStreamHandler::FlushRTPPackets() {
+    const unsigned count = rtpBatch->count;
+    if (count == 0) {
+        return true;
+    }
+    rtpBatch->count = 0;
+    if (udpHandler == nullptr) {
+        return clientSession->WriteInterleaved(&rtpBatch->iov[0][0], count * 2);
+    }
+    return IOBackend::GetInstance().SendMessages(udpHandler->GetRTPSocket(), rtpBatch->msgs, count, MSG_DONTWAIT) == (int)count;
+}
 
-        pos += MAX_RTP_DATA_SIZE;
+/**
+ * @details
+ *   - 페이로드 크기에 따라 단일 패킷 또는 분할 패킷으로 전송
+ *   - FU-A 형식으로 NAL 단위 분할 처리 (NAL 헤더 뒤의 데이터를 나누고 첫/마지막 조각에 S/E 비트 설정)
+ *   - RTP 헤더 마커 비트 설정 (프레임의 마지막 패킷)
+ *   - 프레임의 모든 패킷을 모아 시스템 콜 한 번으로 전송
+ */
+bool MediaStreamHandler::SendFragmentedRTPPackets(const unsigned char* payload, size_t payloadSize) {
+    if (payloadSize <= MAX_RTP_DATA_SIZE) {
+        // 패킷 크기가 최대 데이터 크기 이하인 경우, 단일 RTP 패킷 전송
+        return QueueRTPPacket(nullptr, 0, payload, payloadSize, true) && FlushRTPPackets();
     }
-    // 남은 데이터 처리
-    if(remainPacketSize > 0) {
-        rtpPacket.get_payload()[0] = (nalHeader & NALU_F_NRI_MASK) | SET_FU_A_MASK;
-        rtpPacket.get_payload()[1]= (nalHeader & NALU_TYPE_MASK) | FU_E_MASK;
-        
-        rtpPacket.get_header().set_marker(1);
-        // RTP 패킷 생성
-        memcpy(rtpPacket.get_payload() + FU_SIZE, &payload[pos], remainPacketSize); // 분할된 데이터 복사
-        rtpPacket.rtp_sendto(udpHandler->GetRTPSocket(), RTP_HEADER_SIZE + FU_SIZE + remainPacketSize, 0, (struct sockaddr *)(&udpHandler->GetRTPAddr()));
+
+    const unsigned char nalHeader = payload[0]; // NAL 헤더 (첫 바이트)
+    size_t pos = 1;                             // NAL 헤더(첫 바이트)는 FU indicator/header로 대체
+    size_t remain = payloadSize - 1;
+    bool first = true;
+
+    // 패킷 크기가 최대 데이터 크기를 초과하는 경우, FU-A로 분할
+    while (remain > 0) {
+        const size_t chunk = std::min(remain, (size_t)MAX_RTP_DATA_SIZE);
+        const bool last = (chunk == remain);
+
+        uint8_t fu[FU_SIZE];
+        fu[0] = (nalHeader & NALU_F_NRI_MASK) | SET_FU_A_MASK;
+        fu[1] = nalHeader & NALU_TYPE_MASK;
+        if (first) fu[1] |= FU_S_MASK;  // 첫 번째 조각: FU-A Start
+        if (last) fu[1] |= FU_E_MASK;   // 마지막 조각: FU-A End
+
+        if (!QueueRTPPacket(fu, FU_SIZE, &payload[pos], chunk, last)) {
+            return false;
+        }
+        pos += chunk;
+        remain -= chunk;
+        first = false;
     }
+    return FlushRTPPackets();
 }
 
 /**
  * @details RTCP 패킷을 생성하고 전송
  */
 void MediaStreamHandler::SendRTCPPacket(RTCPPacket& rtcpPacket){
+    if (udpHandler == nullptr) {
+        uint8_t prefix[interleaved_prefix_size] = {'$', (uint8_t)rtcpChannel,
+                                                   (uint8_t)(sizeof(RTCPPacket) >> 8), (uint8_t)(sizeof(RTCPPacket) & 0xFF)};
+        struct iovec iov[2] = {{prefix, sizeof(prefix)}, {&rtcpPacket, sizeof(RTCPPacket)}};
+        clientSession->WriteInterleaved(iov, 2);
+        return ;
+    }
     rtcpPacket.rtcp_sendto(udpHandler->GetRTCPSocket(), sizeof(RTCPPacket), 0, (struct sockaddr *)(&udpHandler->GetRTCPAddr()));
     return ;
 }
 
+/**
+ * @details 빈 RR + BYE compound 패킷을 RTCP 목적지(interleaved 세션은 RTCP 채널)로 전송
+ */
+void MediaStreamHandler::SendBye() {
+    const MediaStreamState state = streamState;
+    if (state != MediaStreamState::eMediaStream_Play && state != MediaStreamState::eMediaStream_Pause) {
+        return;
+    }
+
+    uint8_t packet[interleaved_prefix_size + RTCP_BYE_COMPOUND_SIZE];
+    const int64_t packetSize = RTCPPacket::WriteBye(ssrc, packet + interleaved_prefix_size);
+    if (udpHandler == nullptr) {
+        packet[0] = '$';
+        packet[1] = (uint8_t)rtcpChannel;
+        packet[2] = (uint8_t)(packetSize >> 8);
+        packet[3] = (uint8_t)(packetSize & 0xFF);
+        struct iovec iov = {packet, (size_t)(interleaved_prefix_size + packetSize)};
+        clientSession->WriteInterleaved(&iov, 1);
+        return;
+    }
+    sendto(udpHandler->GetRTCPSocket(), packet + interleaved_prefix_size, packetSize, MSG_DONTWAIT,
+           (struct sockaddr *)&udpHandler->GetRTCPAddr(), sizeof(sockaddr_in));
+}
+
+/**
+ * @details 수신한 RTCP는 세션 활동으로 기록하고 (RR만 보내는 클라이언트도 타임아웃되지 않음),
+ *          RR 등 다른 패킷은 무시하고 PLI/FIR만 키프레임 요청으로 전달
+ */
+void MediaStreamHandler::OnRTCPPacket(const uint8_t* data, int64_t dataLen) {
+    if (clientSession != nullptr) {
+        clientSession->Touch();
+    }
+    if (RTCPPacket::HasKeyframeRequest(data, dataLen)) {
+        RTSPServer::getInstance().requestKeyframe(track);
+    }
+}
+
 /**
  * @details
- *   - 스트림 상태에 따라 미디어 데이터 처리
- *   - DataCapture로부터 프레임 데이터 획득
+ *   - 재생 상태가 아니면 바로 반환 (일시 정지 세션은 워커를 점유하지 않음)
+ *   - Range 이동 후에는 이동한 위치보다 먼저 들어온 프레임을 버리고 이동한 위치의 키프레임부터 전송
+ *   - 소유 워커의 프레임 링에서 세션 자신의 읽기 순번으로 읽을 수 있는 프레임을 모두 전송 (잠금 없음)
  *   - RTP 패킷 생성 및 전송
+ *   - 느린 수신자 처리 (다른 세션에 지연을 주지 않도록 이 세션의 프레임만 버림)
+ *     - 링에서 밀려났거나 송신 큐가 가득 차면 다음 키프레임까지 건너뛰고 키프레임 요청
+ *     - drop_lag_frames 이상 밀리면 비참조 프레임을 버림
+ *     - skip_lag_frames 이상 밀리면 버퍼의 최신 키프레임으로 바로 이동
  *   - RTCP Sender Report 주기적 전송
+ *     (마지막 프레임의 RTP 타임스탬프를 전송 시점까지 외삽하여 NTP 시간과 같은 시점으로 맞춤,
+ *      모든 트랙이 같은 NTPClock을 쓰므로 수신 측이 트랙 사이 립싱크를 맞출 수 있음)
  */
-void MediaStreamHandler::HandleMediaStream() {
-    unsigned int octetCount = 0;
-    unsigned int packetCount = 0;
-    uint16_t seqNum = (uint16_t)GetRanNum(16);
-
-    int ssrcNum = 0;
-
-    Protocol mediaType = RTSPServer::getInstance().getProtocol();
-
-    // RTP 헤더 생성
-    RTPHeader rtpHeader(0, 0, ssrcNum);
-    rtpHeader.set_payloadType(mediaType);
-    rtpHeader.set_seq(seqNum);
-
-    // RTP 패킷 생성
-    RTPPacket rtpPack{rtpHeader};
-
-    while (true) {
-        if(streamState == MediaStreamState::eMediaStream_Play) {
-            while (!DataCapture::getInstance().isEmptyBuffer())
-            {
-                DataCaptureFrame cur_frame = DataCapture::getInstance().popFrame();
-                const auto frame_ptr = cur_frame.dataPtr;
-                const auto frame_size = cur_frame.size;
-                const auto timestamp = cur_frame.timestamp;
-                if (frame_ptr == nullptr || frame_size <= 0)
-                {
-                    std::cout << "Not Ready\n";
-                    continue;
-                }
-
-                // split FU-A
-                rtpPack.get_header().set_timestamp(timestamp);
-                SendFragmentedRTPPackets((unsigned char *)frame_ptr, frame_size, rtpPack);
-
-                // 주기적으로 RTCP Sender Report 전송
-                packetCount++;
-                octetCount += frame_size;
-
-                if (packetCount % 100 == 0)
-                {
-                    RTCPPacket rtcpPacket(timestamp, packetCount, octetCount, mediaType);
-                    SendRTCPPacket(rtcpPacket);
-                }
+void MediaStreamHandler::HandleMediaStream(FrameRing& frames) {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    if (streamState != MediaStreamState::eMediaStream_Play) {
+        playing = false;
+        return;
+    }
+
+    const Protocol mediaType = RTSPServer::getInstance().getTrackProtocol(track);
+    const uint32_t clockRate = (mediaType == Protocol::PROTO_OPUS) ? 48000 : 90000;
+    NTPClock& clock = NTPClock::getInstance();
 
+    if (!playing) {
+        // 재생 시작: skip_lag_frames 이내의 최신 키프레임부터, 없으면 다음 키프레임부터 전송
+        // Range 이동이면 이동한 위치의 프레임이 이미 들어왔을 수 있으므로 skip_lag_frames 전부터 타임스탬프로 찾음
+        playing = true;
+        readSeq = frames.getWriteSequence();
+        readSeq = readSeq > skip_lag_frames ? readSeq - skip_lag_frames : 0;
+        uint64_t keySeq;
+        waitKeyframe = seekPending || !frames.findLatestKeyframe(readSeq, keySeq);
+        if (!waitKeyframe) readSeq = keySeq;
+    }
+
+    while (streamState == MediaStreamState::eMediaStream_Play) {
+        const uint64_t expectedSeq = readSeq;
+        const DataCaptureSharedFrame* cur_frame = frames.readFrame(readSeq);
+        if (cur_frame == nullptr) {
+            break;
+        }
+        const auto frame_ptr = cur_frame->data->data();
+        const auto frame_size = cur_frame->data->size();
+        const auto timestamp = cur_frame->timestamp;
+        const bool isKeyframe = cur_frame->keyframe || mediaType != Protocol::PROTO_H264;
+        if (frame_size <= 0)
+        {
+            std::cout << "Not Ready\n";
+            continue;
+        }
+        if (seekPending) {
+            if ((int32_t)(timestamp - seekTimestamp) < 0) {
+                continue;
             }
-        }else if(streamState == MediaStreamState::eMediaStream_Pause) {
-            std::unique_lock<std::mutex> lck(streamMutex);
-            condition.wait(lck);
+            seekPending = false;
         }
-        else if (streamState == MediaStreamState::eMediaStream_Teardown) {
-            break;
+
+        // 링에서 밀려나 프레임을 놓친 경우 참조 프레임이 없으므로 키프레임까지 건너뜀
+        if (cur_frame->sequence != expectedSeq && !waitKeyframe) {
+            std::cout << "ssrc " << ssrc << ": slow receiver, skip to next keyframe" << std::endl;
+            waitKeyframe = true;
+            RTSPServer::getInstance().requestKeyframe(track);
+        }
+
+        uint64_t keySeq;
+        if (waitKeyframe && !isKeyframe) {
+            if (frames.findLatestKeyframe(readSeq, keySeq)) readSeq = keySeq;
+            skippedFrames++;
+            continue;
+        }
+        waitKeyframe = false;
+
+        const uint64_t lag = frames.getWriteSequence() - readSeq;
+        if (lag >= skip_lag_frames && frames.findLatestKeyframe(readSeq, keySeq)) {
+            skippedFrames += keySeq - readSeq + 1;
+            readSeq = keySeq;
+            continue;
+        }
+        if (lag >= drop_lag_frames && mediaType == Protocol::PROTO_H264 && IsDisposableFrame(frame_ptr, frame_size)) {
+            skippedFrames++;
+            continue;
+        }
+
+        // split FU-A
+        rtpPacket->get_header().set_timestamp(timestamp);
+        if (!SendFragmentedRTPPackets(frame_ptr, frame_size)) {
+            // 송신 큐가 가득 참: 이 프레임의 나머지는 이미 버렸으므로 키프레임부터 다시 전송
+            waitKeyframe = true;
+            skippedFrames++;
+            RTSPServer::getInstance().requestKeyframe(track);
+            continue;
+        }
+        const uint64_t sentNs = clock.GetMonotonicNs();
+
+        // 주기적으로 RTCP Sender Report 전송
+        packetCount++;
+        octetCount += frame_size;
+
+        if (packetCount % 100 == 0)
+        {
+            const uint64_t nowNs = clock.GetMonotonicNs();
+            const uint32_t rtpNow = timestamp + (clock.ToRTPTime(nowNs, clockRate) - clock.ToRTPTime(sentNs, clockRate));
+            RTCPPacket rtcpPacket(clock.ToNTPTime(nowNs), rtpNow, packetCount, octetCount, ssrc);
+            SendRTCPPacket(rtcpPacket);
         }
     }
 }
 
+/**
+ * @details 워커의 송신 상태를 sendMutex 아래에서 바꾸므로, 다음 작업에서 워커가 재생 시작 위치를 다시 잡음
+ *          시퀀스 번호는 이어서 사용 (RTP-Info로 알리므로 클라이언트가 이동 전후 패킷을 구분함)
+ */
+uint16_t MediaStreamHandler::Restart(bool seek, uint32_t rtpTime) {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    playing = false;
+    seekPending = seek;
+    seekTimestamp = rtpTime;
+    return (uint16_t)rtpPacket->get_header().get_seq();
+}
+
 /**
  * @details
- *   - 스트림 상태를 변경하고 조건 변수를 통해 스레드 제어
- *   - 뮤텍스를 사용하여 스레드 안전성 보장
+ *   - 스트림 상태를 원자적으로 변경 (재생 중인 워커나 RTCP 수신 스레드와 잠금 없이 공유)
+ *   - 일시 정지/재개 시 스레드를 재우거나 깨우지 않음
  */
 void MediaStreamHandler::SetCmd(const std::string& cmd) {
-    std::lock_guard<std::mutex> lock(streamMutex);
     if (cmd == "PLAY") {
         streamState = MediaStreamState::eMediaStream_Play;
-        condition.notify_all();
     } else if (cmd == "PAUSE") {
         streamState = MediaStreamState::eMediaStream_Pause;
     } else if (cmd == "TEARDOWN") {
         streamState = MediaStreamState::eMediaStream_Teardown;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,188 @@
+/**
+ * @file MulticastSender.cpp
+ * @brief MulticastSender 클래스의 구현부
+ * @details MulticastSender 클래스의 멤버 함수를 구현한 소스 파일
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "MulticastSender.h"
+#include "ClientSession.h"
+#include "MediaStreamHandler.h"
+#include "UDPHandler.h"
+#include "UDPServer.h"
+#include "SenderPool.h"
+#include "RTSPServer.h"
+#include "DataCapture.h"
+
+#include <vector>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+/**
+ * @details 공유 핸들러의 소멸자가 UDPServer를 사용하므로 UDPServer와 SenderPool을 먼저 생성
+ */
+MulticastSender::MulticastSender() {
+    UDPServer::GetInstance();
+    SenderPool::GetInstance();
+}
+
+/**
+ * @details 송신 풀이 더 이상 공유 핸들러를 호출하지 않도록 제거
+ */
+MulticastSender::~MulticastSender() {
+    Reset();
+}
+
+/**
+ * @details
+ *   - 그룹 주소가 224.0.0.0/4 범위인지 확인
+ *   - RTP 포트는 짝수(RTCP = RTP + 1)이고 마지막 트랙의 포트까지 범위 안, TTL은 1~255
+ *   - 이미 핸들러를 만든 뒤에는 바꿀 수 없음
+ */
+bool MulticastSender::Configure(const std::string& _group, int _rtpPort, int _ttl) {
+    in_addr addr;
+    if (inet_pton(AF_INET, _group.c_str(), &addr) != 1 || !IN_MULTICAST(ntohl(addr.s_addr))) {
+        std::cerr << "Error: " << _group << " is not a multicast address" << std::endl;
+        return false;
+    }
+    if (_rtpPort <= 0 || _rtpPort + 2 * DataCapture::max_tracks > 65536 || (_rtpPort % 2) != 0 || _ttl < 1 || _ttl > 255) {
+        std::cerr << "Error: invalid multicast port " << _rtpPort << " or ttl " << _ttl << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(senderMutex);
+    if (!streams.empty()) {
+        return false;
+    }
+    group = _group;
+    rtpPort = _rtpPort;
+    ttl = _ttl;
+    return true;
+}
+
+/**
+ * @details
+ *   - 트랙의 그룹 주소/포트를 목적지로 하는 세션 정보와 UDPHandler 생성 (TCP 연결 없음)
+ *   - 공유 소켓에 TTL 설정 후 SenderPool에 등록 (다른 트랙을 이미 재생 중이면 이 트랙도 바로 재생)
+ */
+bool MulticastSender::Prepare(int track) {
+    std::shared_ptr<MediaStreamHandler> handler;
+    {
+        std::lock_guard<std::mutex> lock(senderMutex);
+        if (streams.count(track) != 0) {
+            return true;
+        }
+        if (!IsEnabled() || !UDPServer::GetInstance().SetMulticastTTL(ttl)) {
+            return false;
+        }
+
+        TrackStream stream;
+        stream.session = std::make_shared<ClientSession>(-1, group);
+        stream.session->SetRTPPort(GetRTPPort(track));
+        stream.session->SetRTCPPort(GetRTPPort(track) + 1);
+
+        stream.handler = std::make_shared<MediaStreamHandler>(track);
+        stream.handler->udpHandler = new UDPHandler(stream.session);
+        if (!stream.handler->udpHandler->InitTransport()) {
+            return false;
+        }
+        UDPServer::GetInstance().Register(stream.handler.get());
+        SenderPool::GetInstance().Add(stream.handler);
+        if (viewers > 0) {
+            stream.handler->SetCmd("PLAY");
+            handler = stream.handler;
+        }
+        streams[track] = std::move(stream);
+    }
+    if (handler != nullptr) {
+        RTSPServer::getInstance().requestKeyframe(track);
+        SenderPool::GetInstance().Wake(handler.get());
+    }
+    return true;
+}
+
+/**
+ * @details 준비되지 않았으면 0
+ */
+uint32_t MulticastSender::GetSSRC(int track) {
+    std::lock_guard<std::mutex> lock(senderMutex);
+    auto it = streams.find(track);
+    return it != streams.end() ? it->second.handler->GetSSRC() : 0;
+}
+
+/**
+ * @details 첫 시청자면 모든 트랙을 재생 상태로 바꾸고 송신 작업 예약,
+ *          이미 송신 중이면 새 시청자가 바로 디코딩할 수 있도록 키프레임만 요청
+ */
+void MulticastSender::Join() {
+    std::vector<std::shared_ptr<MediaStreamHandler>> started;
+    std::vector<int> tracks;
+    {
+        std::lock_guard<std::mutex> lock(senderMutex);
+        if (streams.empty()) return;
+        const bool first = (viewers++ == 0);
+        for (auto& stream : streams) {
+            tracks.push_back(stream.first);
+            if (first) {
+                stream.second.handler->SetCmd("PLAY");
+                started.push_back(stream.second.handler);
+            }
+        }
+    }
+    for (int track : tracks) {
+        RTSPServer::getInstance().requestKeyframe(track);
+    }
+    if (!started.empty()) {
+        std::cout << "multicast " << group << ":" << rtpPort << " started" << std::endl;
+    }
+    for (auto& handler : started) {
+        SenderPool::GetInstance().Wake(handler.get());
+    }
+}
+
+/**
+ * @details 마지막 시청자면 모든 트랙을 일시 정지 상태로 바꿔 송신 풀이 더 이상 프레임을 보내지 않도록 함
+ */
+void MulticastSender::Leave() {
+    std::lock_guard<std::mutex> lock(senderMutex);
+    if (streams.empty() || viewers == 0) return;
+    if (--viewers == 0) {
+        for (auto& stream : streams) {
+            stream.second.handler->SetCmd("PAUSE");
+        }
+        std::cout << "multicast " << group << ":" << rtpPort << " stopped" << std::endl;
+    }
+}
+
+/**
+ * @details 핸들러는 진행 중인 송신 작업이 끝나면 해제됨
+ */
+void MulticastSender::Reset() {
+    std::lock_guard<std::mutex> lock(senderMutex);
+    for (auto& stream : streams) {
+        stream.second.handler->SendBye();
+        stream.second.handler->SetCmd("TEARDOWN");
+        SenderPool::GetInstance().Remove(stream.second.handler.get());
+    }
+    streams.clear();
+    viewers = 0;
+}
+
+/**
+ * @details 현재 시청자 수 반환
+ */
+int MulticastSender::GetViewerCount() {
+    std::lock_guard<std::mutex> lock(senderMutex);
+    return viewers;
+}
+
+/**
+ * @details 시청자가 있으면 준비된 모든 트랙이 재생 중
+ */
+bool MulticastSender::IsStreaming(int track) {
+    std::lock_guard<std::mutex> lock(senderMutex);
+    return viewers > 0 && streams.count(track) != 0;
+}
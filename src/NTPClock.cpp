@@ -0,0 +1,57 @@
+/**
+ * @file NTPClock.cpp
+ * @brief NTPClock 클래스의 구현부
+ * @details NTPClock 클래스의 멤버 함수를 구현한 소스 파일
+ * 
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "NTPClock.h"
+
+/**
+ * @brief 나노초를 32.32 고정소수점 초로 변환하는 함수
+ * @details 소수부는 (나머지 나노초 << 32) / 10^9로 정확히 계산 (나머지 < 2^30 이므로 오버플로우 없음)
+ */
+static inline uint64_t NsToFixed32(uint64_t ns) {
+    const uint64_t sec = ns / NS_PER_SEC;
+    const uint64_t rem = ns % NS_PER_SEC;
+    return (sec << 32) + ((rem << 32) / NS_PER_SEC);
+}
+
+/**
+ * @details
+ *   - CLOCK_REALTIME 샘플을 두 번의 CLOCK_MONOTONIC 샘플 사이에서 읽음
+ *   - 두 단조 시계 값의 중간을 기준점으로 사용하여 샘플링 오차를 최소화
+ *   - Unix 시간을 NTP 기준(1900년)으로 옮겨 32.32 형식으로 저장
+ */
+NTPClock::NTPClock() {
+    struct timespec realtime;
+    const uint64_t before = GetMonotonicNs();
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    const uint64_t after = GetMonotonicNs();
+
+    anchorMonotonicNs = before + (after - before) / 2;
+    anchorNTPTime = ((uint64_t)realtime.tv_sec + NTP_UNIX_EPOCH_OFFSET) << 32;
+    anchorNTPTime += NsToFixed32((uint64_t)realtime.tv_nsec);
+}
+
+/**
+ * @details 기준점 이전의 값이 들어오면 기준점 시각을 반환
+ */
+uint64_t NTPClock::ToNTPTime(uint64_t monotonicNs) const {
+    if (monotonicNs <= anchorMonotonicNs) {
+        return anchorNTPTime;
+    }
+    return anchorNTPTime + NsToFixed32(monotonicNs - anchorMonotonicNs);
+}
+
+/**
+ * @details 초 단위와 나머지 나노초를 나누어 곱해 64비트 오버플로우를 방지
+ */
+uint32_t NTPClock::ToRTPTime(uint64_t monotonicNs, uint32_t clockRate) const {
+    const uint64_t elapsed = monotonicNs > anchorMonotonicNs ? monotonicNs - anchorMonotonicNs : 0;
+    const uint64_t ticks = (elapsed / NS_PER_SEC) * clockRate
+                         + ((elapsed % NS_PER_SEC) * clockRate) / NS_PER_SEC;
+    return (uint32_t)ticks;
+}
@@ -10,31 +10,32 @@
 #include "RTCPPacket.hpp"
 #include "Global.h"
 
+#include <cstring>
+
 /**
  * @details 
  *   - RTCP 버전 2로 설정
  *   - 패킷 타입을 200(SR)으로 설정
  *   - 패킷 길이를 6으로 설정
- *   - SSRC를 페이로드 타입으로 설정
- *   - NTP 타임스탬프 생성 및 설정
+ *   - SSRC를 RTP 스트림의 SSRC로 설정
+ *   - 전달받은 NTP 타임스탬프를 MSW/LSW로 나누어 설정
  *   - 네트워크 바이트로 변환하여 설정
- *   - RTP 타임스탬프 설정
+ *   - 같은 시점의 RTP 타임스탬프 설정 (수신 측 립싱크 기준)
  *   - 전송된 패킷 수 설정 
  *   - 전송된 바이트 수 설정 (옥텟 수)
  */
 
-RTCPPacket::RTCPPacket(const unsigned int timestamp, unsigned int packetCount, unsigned int octetCount, Protocol payloadType)
+RTCPPacket::RTCPPacket(uint64_t ntpTime, const unsigned int timestamp, unsigned int packetCount, unsigned int octetCount, uint32_t ssrc)
 {
     version = 2;
     p = 0;
     rc = 0;
     pt = 200;
     length = htons(6);
-    ssrc = htonl(payloadType);
+    senderSsrc = htonl(ssrc);
 
-    auto time = GetTime();
-    ntpTimestampMsw = htonl((uint32_t)(time >> 32));
-    ntpTimestampLsw = htonl((uint32_t)(time & 0xFFFFFFFF));
+    ntpTimestampMsw = htonl((uint32_t)(ntpTime >> 32));
+    ntpTimestampLsw = htonl((uint32_t)(ntpTime & 0xFFFFFFFF));
     rtpTimestamp = htonl(timestamp);
     senderPacketCount = htonl(packetCount);
     senderOctetCount = htonl(octetCount);
@@ -48,3 +49,95 @@ int64_t RTCPPacket::rtcp_sendto(int sockfd, int64_t _bufferLen, int flags, const
     auto sentBytes = sendto(sockfd, this, _bufferLen, flags, to, sizeof(sockaddr));
     return sentBytes;
 }
+
+/**
+ * @details compound RTCP 패킷을 공통 헤더의 length 필드(32비트 워드 수 - 1)를 따라 순회하며 검사
+ *   - PT 206(PSFB)의 FMT 1(PLI), FMT 4(FIR)
+ *   - PT 192(RFC 2032 FIR)
+ *   - 버전이 2가 아니거나 길이가 범위를 벗어나면 검사 중단
+ */
+bool RTCPPacket::HasKeyframeRequest(const uint8_t *data, int64_t dataLen)
+{
+    while (dataLen >= RTCP_HEADER_SIZE) {
+        if ((data[0] >> 6) != 2) {
+            break;
+        }
+        const uint8_t fmt = data[0] & 0x1F;
+        const uint8_t packetType = data[1];
+        const int64_t packetLen = (((int64_t)data[2] << 8 | data[3]) + 1) * 4;
+        if (packetLen > dataLen) {
+            break;
+        }
+
+        if (packetType == RTCP_PT_FIR_LEGACY) {
+            return true;
+        }
+        if (packetType == RTCP_PT_PSFB && (fmt == RTCP_FMT_PLI || fmt == RTCP_FMT_FIR)) {
+            return true;
+        }
+
+        data += packetLen;
+        dataLen -= packetLen;
+    }
+    return false;
+}
+
+/**
+ * @details compound RTCP 패킷에서 서버가 보낸 스트림을 가리키는 첫 SSRC를 반환
+ *   - SR: 송신자 정보(28바이트) 다음 리포트 블록의 SSRC
+ *   - RR: 송신자 SSRC(8바이트) 다음 리포트 블록의 SSRC
+ *   - RTPFB/PSFB: 미디어 소스 SSRC (오프셋 8)
+ */
+bool RTCPPacket::GetMediaSSRC(const uint8_t *data, int64_t dataLen, uint32_t &ssrc)
+{
+    while (dataLen >= RTCP_HEADER_SIZE) {
+        if ((data[0] >> 6) != 2) {
+            break;
+        }
+        const uint8_t count = data[0] & 0x1F;
+        const uint8_t packetType = data[1];
+        const int64_t packetLen = (((int64_t)data[2] << 8 | data[3]) + 1) * 4;
+        if (packetLen > dataLen) {
+            break;
+        }
+
+        int64_t offset = -1;
+        if (packetType == RTCP_PT_SR && count > 0) {
+            offset = 28;
+        } else if (packetType == RTCP_PT_RR && count > 0) {
+            offset = 8;
+        } else if (packetType == RTCP_PT_RTPFB || packetType == RTCP_PT_PSFB) {
+            offset = 8;
+        }
+        if (offset >= 0 && offset + 4 <= packetLen) {
+            ssrc = (uint32_t)data[offset] << 24 | (uint32_t)data[offset + 1] << 16
+                 | (uint32_t)data[offset + 2] << 8 | (uint32_t)data[offset + 3];
+            return true;
+        }
+
+        data += packetLen;
+        dataLen -= packetLen;
+    }
+    return false;
+}
+
+/**
+ * @details 빈 RR(헤더 + SSRC, length 1)과 SSRC 하나인 BYE(SC 1, length 1)를 차례로 기록
+ */
+int64_t RTCPPacket::WriteBye(uint32_t ssrc, uint8_t *out)
+{
+    const uint32_t ssrcNet = htonl(ssrc);
+
+    out[0] = 0x80;
+    out[1] = RTCP_PT_RR;
+    out[2] = 0;
+    out[3] = 1;
+    memcpy(out + 4, &ssrcNet, sizeof(ssrcNet));
+
+    out[8] = 0x81;
+    out[9] = RTCP_PT_BYE;
+    out[10] = 0;
+    out[11] = 1;
+    memcpy(out + 12, &ssrcNet, sizeof(ssrcNet));
+    return RTCP_BYE_COMPOUND_SIZE;
+}
@@ -8,19 +8,51 @@
 */
 
 #include <RTPPacket.hpp>
+#include "NTPClock.h"
 
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 /**
 * @details 
 *   멤버 초기화 리스트를 사용하여 RTP 헤더를 초기화하고,
 *   RTP_Payload는 0으로 초기화된다 (클래스 선언에서 {0}으로 초기화)
+*   헤더 확장은 기본으로 켜고, 값이 바뀌지 않는 부분(프로파일, 길이, 요소 ID)을 미리 기록
+*     | 0xBE | 0xDE | length=2       |
+*     | ID=1 L=2 | abs-send-time (24bit) |
+*     | ID=2 L=1 | transport seq (16bit) | padding |
 */
-RTPPacket::RTPPacket(const RTPHeader &rtpHeader) : header(rtpHeader) {}
+RTPPacket::RTPPacket(const RTPHeader &rtpHeader) : header(rtpHeader)
+{
+    RTP_Extension[0] = RTP_EXT_ONE_BYTE_PROFILE >> 8;
+    RTP_Extension[1] = RTP_EXT_ONE_BYTE_PROFILE & 0xFF;
+    RTP_Extension[2] = 0;
+    RTP_Extension[3] = (RTP_EXTENSION_SIZE - 4) / 4;
+    RTP_Extension[4] = (RTP_EXT_ID_ABS_SEND_TIME << 4) | (RTP_EXT_ABS_SEND_TIME_SIZE - 1);
+    RTP_Extension[8] = (RTP_EXT_ID_TRANSPORT_SEQ << 4) | (RTP_EXT_TRANSPORT_SEQ_SIZE - 1);
+    header.set_extension(true);
+}
+
+/**
+* @details
+*   - abs-send-time: 32.32 NTP 시간에서 정수부 하위 6비트와 소수부 상위 18비트를 취함 (약 3.8us 단위, 64초 주기)
+*   - transport-wide 시퀀스 번호: 네트워크 바이트 순서로 기록 후 증가
+*/
+void RTPPacket::stamp_extension()
+{
+    const uint32_t absSendTime = (uint32_t)(NTPClock::getInstance().GetNTPTime() >> 14) & 0x00FFFFFF;
+    RTP_Extension[5] = (absSendTime >> 16) & 0xFF;
+    RTP_Extension[6] = (absSendTime >> 8) & 0xFF;
+    RTP_Extension[7] = absSendTime & 0xFF;
+    RTP_Extension[9] = (transportSeq >> 8) & 0xFF;
+    RTP_Extension[10] = transportSeq & 0xFF;
+    transportSeq++;
+}
 
 /**
 * @details 
@@ -35,13 +67,50 @@ void RTPPacket::load_data(const uint8_t *data, const int64_t dataSize, const int
 
 /**
 * @details 
-*   - sendto() 함수를 사용하여 UDP로 패킷 전송
+*   - sendmsg() 함수를 사용하여 UDP로 패킷 전송
+*     (고정 헤더, 헤더 확장, 페이로드를 iovec으로 묶어 페이로드 복사 없이 하나의 데이터그램으로 전송)
 *   - 전송 후 시퀀스 번호 자동 증가
 *   - sockaddr 구조체는 수신자의 IP 주소와 포트 정보를 포함
 */
 int64_t RTPPacket::rtp_sendto(int sockfd, const int64_t _bufferLen, const int flags, const sockaddr *to)
 {
-    auto sentBytes = sendto(sockfd, this, _bufferLen, flags, to, sizeof(sockaddr));
+    struct iovec iov[3];
+    int iovCount = 0;
+    iov[iovCount].iov_base = header.get_header();
+    iov[iovCount++].iov_len = RTP_HEADER_SIZE;
+    if (header.has_extension()) {
+        stamp_extension();
+        iov[iovCount].iov_base = RTP_Extension;
+        iov[iovCount++].iov_len = RTP_EXTENSION_SIZE;
+    }
+    iov[iovCount].iov_base = RTP_Payload;
+    iov[iovCount++].iov_len = _bufferLen - RTP_HEADER_SIZE;
+
+    struct msghdr msg{};
+    msg.msg_name = (void *)to;
+    msg.msg_namelen = sizeof(sockaddr);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovCount;
+
+    auto sentBytes = sendmsg(sockfd, &msg, flags);
     header.set_seq(header.get_seq() + 1);
     return sentBytes;
 }
+
+/**
+* @details
+*   - 고정 헤더를 복사하고, 헤더 확장이 켜져 있으면 전송 시점 값을 기록하여 이어 붙임
+*   - 기록 후 시퀀스 번호 자동 증가
+*/
+int64_t RTPPacket::write_header(uint8_t *out)
+{
+    memcpy(out, header.get_header(), RTP_HEADER_SIZE);
+    int64_t headerLen = RTP_HEADER_SIZE;
+    if (header.has_extension()) {
+        stamp_extension();
+        memcpy(out + headerLen, RTP_Extension, RTP_EXTENSION_SIZE);
+        headerLen += RTP_EXTENSION_SIZE;
+    }
+    header.set_seq(header.get_seq() + 1);
+    return headerLen;
+}
@@ -0,0 +1,365 @@
+/**
+ * @file RTSPRequest.cpp
+ * @brief RTSPRequest 클래스의 구현부
+ * @details 요청 줄/헤더 분리와 CSeq, Transport, Session, Range, Scale, Speed 헤더 해석 구현 (할당 없음)
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "RTSPRequest.h"
+
+#include <charconv>
+
+/**
+ * @brief ASCII 문자를 소문자로 바꾸는 함수 (로캘과 무관)
+ */
+static inline char ToLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+/**
+ * @brief 앞뒤 공백(SP, HT, CR, LF)을 뺀 범위를 반환하는 함수
+ */
+static std::string_view Trim(std::string_view text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t' || text[begin] == '\r' || text[begin] == '\n')) begin++;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r' || text[end - 1] == '\n')) end--;
+    return text.substr(begin, end - begin);
+}
+
+/**
+ * @brief 구분자 앞까지를 잘라 반환하고 text를 구분자 다음으로 옮기는 함수
+ */
+static std::string_view NextToken(std::string_view& text, char delimiter) {
+    size_t pos = text.find(delimiter);
+    std::string_view token = text.substr(0, pos);
+    text = (pos == std::string_view::npos) ? std::string_view() : text.substr(pos + 1);
+    return token;
+}
+
+/**
+ * @brief 10진수 정수 전체를 파싱하는 함수
+ * @return bool 문자열 전체가 0 이상의 정수인지 여부
+ */
+static bool ParseInt(std::string_view text, int& value) {
+    text = Trim(text);
+    if (text.empty()) return false;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() && value >= 0;
+}
+
+/**
+ * @brief 10진수 실수 전체를 파싱하는 함수 (Scale/Speed 헤더용, 부호 허용)
+ * @return bool 문자열 전체가 0이 아닌 유한한 실수인지 여부
+ */
+static bool ParseDecimal(std::string_view text, double& value) {
+    text = Trim(text);
+    if (!text.empty() && text[0] == '+') text.remove_prefix(1);
+    if (text.empty()) return false;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value, std::chars_format::fixed);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() && value != 0.0 && value == value;
+}
+
+/**
+ * @brief "a-b" 또는 "a" 형식의 정수 쌍을 파싱하는 함수
+ * @return int 읽은 정수 개수 (0: 형식 오류)
+ */
+static int ParseIntPair(std::string_view text, int& first, int& second) {
+    size_t dash = text.find('-');
+    if (!ParseInt(text.substr(0, dash), first)) return 0;
+    if (dash == std::string_view::npos) return 1;
+    return ParseInt(text.substr(dash + 1), second) ? 2 : 1;
+}
+
+/**
+ * @brief npt 시각 하나를 초로 파싱하는 함수 (npt-sec "12.5" 또는 npt-hhmmss "1:02:03.5")
+ */
+static bool ParseNptTime(std::string_view text, double& seconds) {
+    text = Trim(text);
+    if (text.empty()) return false;
+    double total = 0.0;
+    double field = 0.0;
+    double scale = 0.0;  // 소수부 자릿값 (0: 정수부)
+    int colons = 0;
+    bool digits = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            if (scale == 0.0) {
+                field = field * 10.0 + (c - '0');
+            } else {
+                field += (c - '0') * scale;
+                scale /= 10.0;
+            }
+            digits = true;
+        } else if (c == '.' && scale == 0.0) {
+            scale = 0.1;
+        } else if (c == ':' && scale == 0.0 && digits && colons < 2) {
+            total = (total + field) * 60.0;
+            field = 0.0;
+            digits = false;
+            colons++;
+        } else {
+            return false;
+        }
+    }
+    if (!digits) return false;
+    seconds = total + field;
+    return true;
+}
+
+/**
+ * @brief 헤더 끝(빈 줄)을 찾는 함수
+ * @return size_t 빈 줄 다음 위치 (없으면 npos)
+ */
+static size_t FindHeaderEnd(std::string_view input) {
+    size_t pos = input.find('\n');
+    while (pos != std::string_view::npos) {
+        size_t next = pos + 1;
+        if (next < input.size() && input[next] == '\n') return next + 1;
+        if (next + 1 < input.size() && input[next] == '\r' && input[next + 1] == '\n') return next + 2;
+        pos = input.find('\n', next);
+    }
+    return std::string_view::npos;
+}
+
+/**
+ * @details 헤더 끝을 찾은 뒤 각 헤더 줄에서 Content-Length만 대소문자 구분 없이 확인
+ *          헤더만으로 maxSize를 넘었거나 본문까지 maxSize를 넘으면 잘못된 메시지로 처리
+ */
+long RTSPRequest::FindMessageLength(std::string_view input, size_t maxSize) {
+    size_t headerEnd = FindHeaderEnd(input);
+    if (headerEnd == std::string_view::npos) {
+        return (input.size() > maxSize) ? -1 : 0;
+    }
+
+    size_t contentLength = 0;
+    std::string_view headerText = input.substr(0, headerEnd);
+    NextToken(headerText, '\n');  // 요청 줄
+    while (!headerText.empty()) {
+        std::string_view line = NextToken(headerText, '\n');
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos || !EqualsIgnoreCase(Trim(line.substr(0, colon)), "Content-Length")) continue;
+        int length = 0;
+        if (!ParseInt(line.substr(colon + 1), length)) return -1;
+        contentLength = (size_t)length;
+        break;
+    }
+
+    if (headerEnd + contentLength > maxSize) return -1;
+    if (input.size() < headerEnd + contentLength) return 0;
+    return (long)(headerEnd + contentLength);
+}
+
+bool RTSPRequest::EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (ToLower(a[i]) != ToLower(b[i])) return false;
+    }
+    return true;
+}
+
+/**
+ * @details 한 번 훑으면서:
+ *   - 첫 줄을 공백 기준으로 메서드/URI/버전으로 나눔
+ *   - 이후 줄을 "이름: 값"으로 나눠 헤더 테이블에 넣고, 공백으로 시작하는 줄은 앞 헤더 값에 이어 붙임
+ *     (값은 연속된 범위이므로 범위 끝만 늘림)
+ *   - 헤더 하나가 끝날 때마다 CSeq/Transport/Session/Range면 바로 해석
+ *   - 빈 줄에서 멈추고 나머지를 본문으로 둠
+ */
+bool RTSPRequest::Parse(std::string_view text) {
+    method = uri = version = body = std::string_view();
+    headerCount = 0;
+    cseq = -1;
+    transport = RTSPTransport();
+    session = RTSPSessionHeader();
+    range = RTSPRange();
+    scale = speed = 0.0;
+
+    size_t lineEnd = text.find('\n');
+    std::string_view requestLine = Trim(text.substr(0, lineEnd));
+    text = (lineEnd == std::string_view::npos) ? std::string_view() : text.substr(lineEnd + 1);
+
+    method = NextToken(requestLine, ' ');
+    requestLine = Trim(requestLine);
+    uri = NextToken(requestLine, ' ');
+    version = Trim(requestLine);
+
+    Header current;
+    bool pending = false;
+    while (!text.empty()) {
+        lineEnd = text.find('\n');
+        std::string_view line = text.substr(0, lineEnd);
+        text = (lineEnd == std::string_view::npos) ? std::string_view() : text.substr(lineEnd + 1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) {
+            body = text;
+            break;
+        }
+
+        if ((line[0] == ' ' || line[0] == '\t') && pending) {
+            std::string_view folded = Trim(line);
+            if (current.value.empty()) {
+                current.value = folded;
+            } else if (!folded.empty()) {
+                current.value = std::string_view(current.value.data(), folded.data() + folded.size() - current.value.data());
+            }
+            continue;
+        }
+
+        if (pending) {
+            if (headerCount < max_headers) headers[headerCount++] = current;
+            ParseTypedHeader(current);
+            pending = false;
+        }
+
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        current.name = Trim(line.substr(0, colon));
+        current.value = Trim(line.substr(colon + 1));
+        pending = !current.name.empty();
+    }
+    if (pending) {
+        if (headerCount < max_headers) headers[headerCount++] = current;
+        ParseTypedHeader(current);
+    }
+
+    return !method.empty() && !uri.empty() && !version.empty();
+}
+
+std::string_view RTSPRequest::GetHeader(std::string_view name) const {
+    for (size_t i = 0; i < headerCount; i++) {
+        if (EqualsIgnoreCase(headers[i].name, name)) return headers[i].value;
+    }
+    return std::string_view();
+}
+
+bool RTSPRequest::HasHeader(std::string_view name) const {
+    for (size_t i = 0; i < headerCount; i++) {
+        if (EqualsIgnoreCase(headers[i].name, name)) return true;
+    }
+    return false;
+}
+
+/**
+ * @details 쉼표로 나눈 각 미디어 범위에서 파라미터(';q=' 등)를 빼고 비교
+ *          모든 타입 와일드카드와 "application/"처럼 주 타입만 맞춘 와일드카드도 수락으로 처리
+ */
+bool RTSPRequest::Accepts(std::string_view mediaType) const {
+    std::string_view accept = GetHeader("Accept");
+    std::string_view type = mediaType.substr(0, mediaType.find('/'));
+    while (!accept.empty()) {
+        std::string_view range = Trim(NextToken(accept, ','));
+        range = Trim(range.substr(0, range.find(';')));
+        if (EqualsIgnoreCase(range, mediaType) || range == "*/*") return true;
+        if (range.size() == type.size() + 2 && EqualsIgnoreCase(range.substr(0, type.size()), type)
+            && range.substr(type.size()) == "/*") return true;
+    }
+    return false;
+}
+
+/**
+ * @details 같은 헤더가 여러 번 오면 처음 것만 해석
+ */
+void RTSPRequest::ParseTypedHeader(const Header& header) {
+    if (EqualsIgnoreCase(header.name, "CSeq")) {
+        if (cseq == -1 && !ParseInt(header.value, cseq)) cseq = -1;
+    } else if (EqualsIgnoreCase(header.name, "Transport")) {
+        if (!transport.present) ParseTransport(header.value, transport);
+    } else if (EqualsIgnoreCase(header.name, "Session")) {
+        if (!session.present) ParseSession(header.value, session);
+    } else if (EqualsIgnoreCase(header.name, "Range")) {
+        if (!range.present) ParseRange(header.value, range);
+    } else if (EqualsIgnoreCase(header.name, "Scale")) {
+        if (scale == 0.0 && !ParseDecimal(header.value, scale)) scale = 0.0;
+    } else if (EqualsIgnoreCase(header.name, "Speed")) {
+        if (speed == 0.0 && (!ParseDecimal(header.value, speed) || speed < 0.0)) speed = 0.0;
+    }
+}
+
+/**
+ * @details 쉼표로 나열된 전송 방식 중 첫 번째만 해석:
+ *          "RTP/AVP[/UDP|/TCP];unicast|multicast;client_port=a-b;interleaved=a-b;RTCP-mux"
+ *          프로토콜과 파라미터 이름은 대소문자 구분 없음
+ */
+void RTSPRequest::ParseTransport(std::string_view value, RTSPTransport& out) {
+    out.present = true;
+    std::string_view spec = NextToken(value, ',');
+    std::string_view protocol = Trim(NextToken(spec, ';'));
+    out.tcp = EqualsIgnoreCase(protocol, "RTP/AVP/TCP");
+
+    while (!spec.empty()) {
+        std::string_view parameter = Trim(NextToken(spec, ';'));
+        size_t eq = parameter.find('=');
+        std::string_view name = Trim(parameter.substr(0, eq));
+        std::string_view argument = (eq == std::string_view::npos) ? std::string_view() : Trim(parameter.substr(eq + 1));
+
+        if (EqualsIgnoreCase(name, "multicast")) {
+            out.multicast = true;
+        } else if (EqualsIgnoreCase(name, "RTCP-mux")) {
+            out.rtcpMux = true;
+        } else if (EqualsIgnoreCase(name, "client_port")) {
+            int rtp = -1, rtcp = -1;
+            int count = ParseIntPair(argument, rtp, rtcp);
+            if (count > 0) {
+                out.clientRTPPort = rtp;
+                out.clientRTCPPort = (count == 2) ? rtcp : rtp;
+            }
+        } else if (EqualsIgnoreCase(name, "interleaved")) {
+            int rtp = -1, rtcp = -1;
+            int count = ParseIntPair(argument, rtp, rtcp);
+            if (count == 0 || rtp > 255) {
+                out.invalidChannel = true;
+                continue;
+            }
+            out.rtpChannel = rtp;
+            out.rtcpChannel = (count == 2 && rtcp <= 255) ? rtcp : ((rtp + 1) & 0xFF);
+        }
+    }
+}
+
+/**
+ * @details "id[;timeout=N]" 형식
+ */
+void RTSPRequest::ParseSession(std::string_view value, RTSPSessionHeader& out) {
+    out.present = true;
+    out.id = Trim(NextToken(value, ';'));
+    while (!value.empty()) {
+        std::string_view parameter = Trim(NextToken(value, ';'));
+        size_t eq = parameter.find('=');
+        if (eq != std::string_view::npos && EqualsIgnoreCase(Trim(parameter.substr(0, eq)), "timeout")) {
+            int timeout = -1;
+            if (ParseInt(parameter.substr(eq + 1), timeout)) out.timeout = timeout;
+        }
+    }
+}
+
+/**
+ * @details "npt=시작-[끝]" 또는 "npt=-끝" 형식 (시작은 "now" 가능)
+ *          ";time=" 파라미터는 무시하며, npt가 아닌 단위는 present만 설정
+ */
+void RTSPRequest::ParseRange(std::string_view value, RTSPRange& out) {
+    out.present = true;
+    std::string_view spec = Trim(NextToken(value, ';'));
+    size_t eq = spec.find('=');
+    if (eq == std::string_view::npos || !EqualsIgnoreCase(Trim(spec.substr(0, eq)), "npt")) return;
+    spec = Trim(spec.substr(eq + 1));
+
+    size_t dash = spec.find('-');
+    if (dash == std::string_view::npos) return;
+    std::string_view start = Trim(spec.substr(0, dash));
+    std::string_view end = Trim(spec.substr(dash + 1));
+
+    if (EqualsIgnoreCase(start, "now")) {
+        out.now = true;
+    } else if (!start.empty()) {
+        if (!ParseNptTime(start, out.start)) return;
+        out.hasStart = true;
+    }
+    if (!end.empty()) {
+        if (!ParseNptTime(end, out.end)) return;
+        out.hasEnd = true;
+    }
+    out.valid = out.now || out.hasStart || out.hasEnd;
+}
@@ -12,8 +12,17 @@
 #include "ClientSession.h"
 #include "TCPHandler.h"
 #include "UDPHandler.h"
+#include "UDPServer.h"
 #include "RequestHandler.h"
 #include "MediaStreamHandler.h"
+#include "DataCapture.h"
+#include "EventLoop.h"
+#include "SenderPool.h"
+#include "MulticastSender.h"
+#include "SessionTable.h"
+#include "AdmissionControl.h"
+#include "ThreadRegistry.h"
+#include "SDPCache.h"
 
 #include <string>
 #include <thread>
@@ -23,14 +32,35 @@
 #include <fstream>
 #include <iomanip>
 #include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/epoll.h>
 using namespace std;
 
+/**
+ * @details 함수 내 정적 지역 변수로 생성되는 단일 인스턴스를 반환
+ */
+RTSPServer& RTSPServer::getInstance()
+{
+    static RTSPServer instance;
+    return instance;
+}
+
 /**
  * @details 서버 인스턴스 초기화
+ *          세션 핸들러와 서버 소멸자가 사용하는 싱글톤들이 서버보다 늦게 소멸되도록 먼저 생성
  */
 RTSPServer::RTSPServer()
 {
-    
+    ThreadRegistry::GetInstance();
+    TCPHandler::GetInstance();
+    UDPServer::GetInstance();
+    SenderPool::GetInstance();
+    MulticastSender::GetInstance();
+    SessionTable::GetInstance();
+    AdmissionControl::GetInstance();
+    SDPCache::GetInstance();
 }
 
 /**
@@ -38,46 +68,310 @@ RTSPServer::RTSPServer()
  */
 RTSPServer::~RTSPServer()
 {
-    std::cout << "Interrupt signal (" << signal << ") received. Shutting down..." << std::endl;
-    TCPHandler::GetInstance().CloseClientConnection();
+    stop();
 }
 
 /**
  * @details 서버 스레드 시작 프로세스:
  *          1. 권한 검사 (privileged port 사용 시)
- *          2. 클라이언트 연결 수신 대기
- *          3. 새 클라이언트 연결 시 세션 생성
- *          4. 요청 처리 스레드 시작
+ *          2. 스레드 역할별 배치 정책과 지연 측정 설정 (환경 변수 우선)
+ *          3. 모든 세션이 공유하는 RTP/RTCP 포트 바인딩, RTP I/O 백엔드 선택, 미디어 송신 스레드 풀과 유휴 세션 정리 스레드 시작
+ *          4. 리스닝 소켓 수만큼 SO_REUSEPORT 리스닝 소켓을 만들고, 소켓마다 이벤트 루프를 시작하여 등록
+ *             (두 번째 이후 소켓 생성에 실패하면 만들어진 소켓 수로 계속)
+ *          5. 새 클라이언트 연결은 해당 이벤트 루프 스레드에서 수락하고 세션 생성 (acceptConnections)
+ *          이미 실행 중이면 아무것도 하지 않으며, 실패하면 시작한 것들을 stop()으로 정리
  */
 int RTSPServer::startServerThread()
 {
+    if (running) {
+        return 0;
+    }
     if(isPrivilegedPort(g_serverRtpPort) && !isRunningAsRoot()) {
         std::cerr << "Error: Program must be run as root to bind to privileged ports.\n";
         return 1;
     };
 
-    std::cout << "Start RTSP server " << std::endl;
+    running = true;
+    const char* threadPolicyEnv = getenv("RTSP_THREAD_POLICY");
+    if (threadPolicyEnv != nullptr) {
+        ThreadRegistry::GetInstance().Configure(threadPolicyEnv);
+    }
+    const char* probeEnv = getenv("RTSP_LATENCY_PROBE_US");
+    if (probeEnv != nullptr) {
+        latencyProbeUs = atoi(probeEnv);
+    }
+    ThreadRegistry::GetInstance().StartProbes(latencyProbeUs);
 
-    std::thread ([]()->void{
-        while(true){
-            std::string newIp;
-            int newClient = TCPHandler::GetInstance().AcceptClientConnection(newIp);
-            if(newClient == -1){
-                break;
-            }else {
-                std::cout << "Client Ip:" << newIp << " connected." << std::endl;
-            }
-            ClientSession* clientSession = new ClientSession(newClient, newIp);
+    const char* maxSessionsEnv = getenv("RTSP_MAX_SESSIONS");
+    if (maxSessionsEnv != nullptr) {
+        AdmissionControl::GetInstance().SetMaxSessions(atoi(maxSessionsEnv));
+    }
+    const char* maxEgressEnv = getenv("RTSP_MAX_EGRESS_KBPS");
+    if (maxEgressEnv != nullptr) {
+        AdmissionControl::GetInstance().SetMaxEgressBitrate(atoi(maxEgressEnv));
+    }
+    const char* maxCpuEnv = getenv("RTSP_MAX_SENDER_CPU");
+    if (maxCpuEnv != nullptr) {
+        AdmissionControl::GetInstance().SetMaxSenderCpu(atoi(maxCpuEnv));
+    }
 
-            RequestHandler requestHandler(clientSession);
-            requestHandler.StartThread();
+    if (!UDPServer::GetInstance().Open(g_serverMediaRtpPort, g_serverMediaRtcpPort)) {
+        stop();
+        return 1;
+    }
+    const char* backendEnv = getenv("RTSP_IO_BACKEND");
+    if (backendEnv != nullptr) {
+        ioBackend = (std::string(backendEnv) == "io_uring") ? eIOBackend_IoUring : eIOBackend_Socket;
+    }
+    IOBackend::GetInstance().Init(ioBackend);
+    SenderPool::GetInstance().Start();
+    SessionTable::GetInstance().Start();
+
+    int count = listenerCount > 0 ? listenerCount : (int)std::thread::hardware_concurrency();
+    if (count <= 0) {
+        count = 1;
+    }
+    for (int i = 0; i < count; i++) {
+        int listenSocket = TCPHandler::GetInstance().CreateTCPSocket(listenBacklog);
+        if (listenSocket == -1) {
+            break;
+        }
+        auto loop = std::make_unique<EventLoop>();
+        EventLoop* loopPtr = loop.get();
+        if (!loop->Start() || !loop->Add(listenSocket, EPOLLIN,
+                [this, loopPtr, listenSocket](uint32_t) { acceptConnections(loopPtr, listenSocket); })) {
+            break;
         }
-        std::cout << "Stop RTSP server" << std::endl;
-    }).detach();
- 
+        eventLoops.push_back(std::move(loop));
+    }
+    if (eventLoops.empty()) {
+        stop();
+        return 1;
+    }
+
+    std::cout << "Start RTSP server with " << eventLoops.size() << " listeners" << std::endl;
     return 0;
 }
 
+/**
+ * @details
+ *   - 리스닝 소켓에서 대기 중인 연결이 없을 때까지 accept
+ *   - 연결마다 ClientSession과 RequestHandler를 만들고, 요청 처리 콜백을 같은 이벤트 루프에 등록
+ *   - 응답이나 interleaved 데이터가 출력 버퍼에 남아 있는 동안만 EPOLLOUT을 감시하여 이어서 전송
+ *   - RequestHandler는 콜백이 소유하므로 연결을 루프에서 제거하면 함께 해제됨
+ *   - 연결 종료(TEARDOWN, 클라이언트 종료, 잘못된 요청) 시 루프에서 제거하고 세션을 정리한 뒤 소켓을 닫음
+ */
+void RTSPServer::acceptConnections(EventLoop* loop, int listenSocket)
+{
+    while (true) {
+        std::string newIp;
+        int newClient = TCPHandler::GetInstance().AcceptClientConnection(listenSocket, newIp);
+        if (newClient == -1) {
+            break;
+        }
+        std::cout << "Client Ip:" << newIp << " connected." << std::endl;
+
+        ClientSession* session = new ClientSession(newClient, newIp);
+        session->SetWriteInterestCallback([loop, newClient](bool enable) {
+            loop->Modify(newClient, EPOLLIN | EPOLLRDHUP | (enable ? (uint32_t)EPOLLOUT : 0u));
+        });
+        auto requestHandler = std::make_shared<RequestHandler>(session);
+        bool added = loop->Add(newClient, EPOLLIN | EPOLLRDHUP, [loop, newClient, requestHandler](uint32_t events) {
+            bool connected = !(events & EPOLLOUT) || requestHandler->OnWritable();
+            if (connected && (events & ~EPOLLOUT)) {
+                connected = requestHandler->OnReadable();
+            }
+            if (!connected || (events & (EPOLLHUP | EPOLLERR))) {
+                std::cout << "Client " << newClient << " disconnected." << std::endl;
+                loop->Remove(newClient);
+                requestHandler->Close();
+            }
+        });
+        if (!added) {
+            close(newClient);
+        }
+    }
+}
+
+/**
+ * @details 종료 순서 (스레드마다 깨우기 신호가 있어 기다림은 실행 중인 콜백/작업 하나로 제한됨):
+ *          1. 이벤트 루프 종료 (새 요청과 연결 수락 중단)
+ *          2. 리스닝 소켓을 루프에서 빼고, 남은 연결을 모두 끊음 (세션마다 RTCP BYE, 송신 풀/세션 테이블에서 제거)
+ *          3. 멀티캐스트 송신자 해제 (그룹에 RTCP BYE)
+ *          4. 송신 스레드 풀, 유휴 세션 정리 스레드, RTCP 수신 스레드 종료 및 공유 UDP 소켓 닫기
+ *          5. 리스닝 소켓 닫기, 이벤트 루프 해제
+ *          6. onStopEvent로 소스 스레드 종료를 알리고, 다음 시작에서 onInitEvent가 다시 호출되도록 초기화
+ *          7. 지연 측정 스레드 종료, 역할별 스케줄링 지연 출력 후 초기화
+ */
+void RTSPServer::stop()
+{
+    if (!running.exchange(false)) {
+        return;
+    }
+    const auto startTime = std::chrono::steady_clock::now();
+
+    for (auto& loop : eventLoops) {
+        loop->Stop();
+    }
+    for (auto& loop : eventLoops) {
+        for (int listenSocket : TCPHandler::GetInstance().GetTCPSockets()) {
+            loop->Remove(listenSocket);
+        }
+        loop->HangUpAll();
+    }
+
+    MulticastSender::GetInstance().Reset();
+    SenderPool::GetInstance().Stop();
+    SessionTable::GetInstance().Stop();
+    UDPServer::GetInstance().Close();
+    TCPHandler::GetInstance().CloseClientConnection();
+    eventLoops.clear();
+
+    if (onStopEvent) {
+        onStopEvent();
+    }
+    initEventFired = false;
+
+    ThreadRegistry::GetInstance().StopProbes();
+    ThreadRegistry::GetInstance().PrintReport();
+    ThreadRegistry::GetInstance().ResetLatencyStats();
+
+    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "RTSP server stopped in " << elapsedMs << " ms" << std::endl;
+}
+
+/**
+ * @details 설정은 MulticastSender가 보관
+ */
+bool RTSPServer::setMulticast(const std::string& group, int port, int ttl)
+{
+    return MulticastSender::GetInstance().Configure(group, port, ttl);
+}
+
+/**
+ * @details 여러 세션이 동시에 SETUP 해도 한 번만 호출되도록 원자적으로 확인
+ */
+void RTSPServer::fireInitEvent()
+{
+    if (!initEventFired.exchange(true) && onInitEvent) {
+        onInitEvent();
+    }
+}
+
+/**
+ * @details 설정은 SessionTable이 보관
+ */
+void RTSPServer::setSessionTimeout(int sec)
+{
+    SessionTable::GetInstance().SetTimeout(sec);
+}
+
+/**
+ * @details 예산은 AdmissionControl이 보관
+ */
+void RTSPServer::setMaxSessions(int count)
+{
+    AdmissionControl::GetInstance().SetMaxSessions(count);
+}
+
+void RTSPServer::setMaxEgressBitrate(int kbps)
+{
+    AdmissionControl::GetInstance().SetMaxEgressBitrate(kbps);
+}
+
+void RTSPServer::setMaxSenderCpu(int percent)
+{
+    AdmissionControl::GetInstance().SetMaxSenderCpu(percent);
+}
+
+AdmissionStats RTSPServer::getAdmissionStats()
+{
+    return AdmissionControl::GetInstance().GetStats();
+}
+
+/**
+ * @details 정책은 ThreadRegistry가 보관하고 등록된 스레드에 바로 적용
+ */
+bool RTSPServer::setThreadPolicy(const std::string& spec)
+{
+    return ThreadRegistry::GetInstance().Configure(spec);
+}
+
+/**
+ * @details 트랙 번호는 DataCapture 인스턴스 번호와 같으므로 DataCapture::max_tracks개까지만 추가
+ */
+int RTSPServer::addTrack(Protocol _protocol)
+{
+    if ((int)tracks.size() >= DataCapture::max_tracks) {
+        std::cerr << "Error: too many tracks (max " << DataCapture::max_tracks << ")" << std::endl;
+        return -1;
+    }
+    tracks.push_back(_protocol);
+    return (int)tracks.size() - 1;
+}
+
+Protocol RTSPServer::getTrackProtocol(int track) const
+{
+    if (track < 0 || track >= (int)tracks.size()) {
+        return Protocol::PROTO_H264;
+    }
+    return tracks[track];
+}
+
+/**
+ * @details 오디오 트랙은 모든 프레임이 디코딩 시작점이므로 요청하지 않음
+ *          트랙의 DataCapture에 대기 중인 키프레임 요청이 없을 때만 소스에 요청을 전달하여,
+ *          여러 클라이언트의 동시 요청이 하나의 IDR로 처리되도록 병합
+ */
+void RTSPServer::requestKeyframe(int track)
+{
+    if (getTrackProtocol(track) != Protocol::PROTO_H264) {
+        return;
+    }
+    if (!DataCapture::getInstance(track).markKeyframePending()) {
+        return;
+    }
+    if (onKeyframeEvent) {
+        onKeyframeEvent();
+    }
+}
+
+void RTSPServer::setH264ParameterSets(const std::string& sps, const std::string& pps, int track)
+{
+    SDPCache::GetInstance().SetH264ParameterSets(sps, pps, track);
+}
+
+void RTSPServer::setBitrate(int kbps, int track)
+{
+    SDPCache::GetInstance().SetBitrate(kbps, track);
+}
+
+void RTSPServer::setDuration(double seconds)
+{
+    duration = seconds;
+    SDPCache::GetInstance().SetDuration(seconds);
+}
+
+/**
+ * @details 이동한 소스가 다음에 키프레임을 보내므로 대기 중인 키프레임 요청은 그대로 두어도 병합됨
+ */
+bool RTSPServer::seek(double& npt, uint32_t& rtpTime)
+{
+    if (!onSeekEvent) {
+        return false;
+    }
+    return onSeekEvent(npt, rtpTime);
+}
+
+bool RTSPServer::changeRate(double& scale, double& speed, double& npt, uint32_t& rtpTime)
+{
+    if (!onRateEvent) {
+        return false;
+    }
+    return onRateEvent(scale, speed, npt, rtpTime);
+}
+
 /**
  * @details 1024 이하의 포트는 privileged port로 간주
  */
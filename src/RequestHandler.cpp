@@ -12,267 +12,852 @@
 #include "ClientSession.h"
 #include "MediaStreamHandler.h"
 #include "UDPHandler.h"
-#include "Global.h"
+#include "UDPServer.h"
+#include "SenderPool.h"
+#include "MulticastSender.h"
+#include "SessionTable.h"
+#include "AdmissionControl.h"
 #include "RTSPServer.h"
+#include "RTSPRequest.h"
+#include "SDPCache.h"
 
 #include <iostream>
 #include <string>
-#include <sstream>
-#include <thread>
+#include <vector>
+#include <cstdio>
+#include <charconv>
 
-RequestHandler::RequestHandler(ClientSession* session) : session(session){};
+/**
+ * @details 응답 버퍼는 연결이 살아 있는 동안 재사용하므로 일반적인 응답 크기만큼 미리 확보
+ *          SETUP 전에도 요청 없이 머무는 연결이 끊기도록 유휴 타임아웃 감시를 시작
+ */
+RequestHandler::RequestHandler(ClientSession* session) : session(session) {
+    responseBuffer.reserve(response_buffer_reserve);
+    SessionTable::GetInstance().Watch(this->session);
+}
 
 /**
- * @details 새로운 스레드를 생성하고 detach하여 백그라운드에서 요청을 처리
+ * @brief 32비트 값을 8자리 16진수 문자열로 변환하는 함수 (Transport 헤더의 ssrc 파라미터용)
  */
-void RequestHandler::StartThread() {
-    std::thread handlerThread(*this);
-    handlerThread.detach();
-};
+static std::string ToHex(uint32_t value) {
+    char buffer[9];
+    snprintf(buffer, sizeof(buffer), "%08X", value);
+    return buffer;
+}
 
 /**
- * @details RTSP 요청 처리 메인 루프:
- *          1. 요청 수신
- *          2. CSeq 및 메서드 파싱
- *          3. 메서드별 적절한 핸들러 호출
+ * @brief 세션 ID를 16자리 16진수로 문자열 끝에 덧붙이는 함수 (Session 헤더용, RFC 2326 3.4의 8자 이상)
  */
-void RequestHandler::HandleRequest() {
-    while (true) {
-        std::cout << "recv wait id :" << session->GetTCPSocket() << std::endl;
-        
-        std::string request = TCPHandler::GetInstance().ReceiveRTSPRequest(session->GetTCPSocket());
-        if (request.empty()) {
-            std::cerr << "Invalid RTSP request received." << std::endl;
-            return;
+static void AppendSessionID(std::string& out, uint64_t id) {
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llX", (unsigned long long)id);
+    out.append(buffer, 16);
+}
+
+/**
+ * @brief Session 헤더의 세션 ID를 해석하는 함수
+ * @return uint64_t 세션 ID (16진수 1~16자리가 아니면 0, 0은 발급하지 않는 ID)
+ */
+static uint64_t ParseSessionID(std::string_view text) {
+    uint64_t id = 0;
+    if (text.empty() || text.size() > 16) {
+        return 0;
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), id, 16);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+        return 0;
+    }
+    return id;
+}
+
+/**
+ * @brief 정수를 문자열 끝에 10진수로 덧붙이는 함수 (임시 문자열을 만들지 않음)
+ */
+static void AppendNumber(std::string& out, long value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr - buffer);
+}
+
+/**
+ * @brief 실수를 소수점 세 자리로 문자열 끝에 덧붙이는 함수 (Range의 npt 시각, Scale, Speed 헤더용)
+ */
+static void AppendDecimal(std::string& out, double value) {
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%.3f", value);
+    out.append(buffer, length);
+}
+
+/**
+ * @brief 요청 URI에서 트랙 번호를 찾는 함수 (SDP의 a=control:trackID=N)
+ * @return int 트랙 번호 (트랙 URL이 아니면 -1, 번호가 잘못되었으면 -2)
+ */
+static int FindTrackID(std::string_view uri) {
+    static const std::string_view key = "trackID=";
+    const size_t pos = uri.rfind(key);
+    if (pos == std::string_view::npos) {
+        return -1;
+    }
+    const char* begin = uri.data() + pos + key.size();
+    const char* end = uri.data() + uri.size();
+    int track = -1;
+    auto result = std::from_chars(begin, end, track);
+    if (result.ec != std::errc() || result.ptr != end || track < 0) {
+        return -2;
+    }
+    return track;
+}
+
+/**
+ * @brief 요청 URI가 멀티캐스트 프레젠테이션(SDPCache::multicast_path)을 가리키는지 확인하는 함수
+ * @details rtsp://주소:포트/multicast, /multicast/trackID=N 처럼 경로의 첫 부분이 multicast_path인 경우
+ */
+static bool IsMulticastURI(std::string_view uri) {
+    const size_t scheme = uri.find("://");
+    const size_t path = uri.find('/', scheme == std::string_view::npos ? 0 : scheme + 3);
+    if (path == std::string_view::npos) {
+        return false;
+    }
+    const std::string_view rest = uri.substr(path + 1);
+    const std::string_view name = SDPCache::multicast_path;
+    return rest.substr(0, name.size()) == name && (rest.size() == name.size() || rest[name.size()] == '/');
+}
+
+/**
+ * @details
+ *   - 논블로킹 소켓에서 최대 max_request_size만큼 입력 버퍼에 덧붙임 (남은 데이터는 다음 읽기 이벤트에서 읽음)
+ *   - '$'로 시작하는 interleaved 패킷(RTCP 수신 보고, 피드백)은 길이만큼 잘라 RTCP 채널이 같은 트랙의 RTCP 처리로 전달
+ *   - 요청 사이의 빈 줄(keepalive로 보내는 CRLF)은 건너뜀
+ *   - 빈 줄로 끝나는 헤더와 Content-Length만큼의 본문을 요청 하나로 잘라 순서대로 처리
+ *     (한 번에 여러 요청이 와도 처리하며, 본문이 아직 덜 왔으면 다음 읽기까지 기다림)
+ *   - 처리한 부분은 마지막에 한 번만 버퍼에서 지움
+ *   - 요청이 max_request_size를 넘거나 Content-Length가 잘못되거나, 처리하지 못한 입력이 max_input_size를 넘으면
+ *     잘못된 클라이언트로 보고 연결 종료
+ */
+bool RequestHandler::OnReadable() {
+    bool connected = TCPHandler::GetInstance().ReceiveRTSPRequest(session->GetTCPSocket(), inputBuffer, max_request_size);
+
+    size_t offset = 0;
+    bool keep = true;
+    while (keep && offset < inputBuffer.size()) {
+        std::string_view input(inputBuffer.data() + offset, inputBuffer.size() - offset);
+        if (input[0] == '$') {
+            if (input.size() < 4) break;
+            const int channel = (uint8_t)input[1];
+            const size_t length = ((uint8_t)input[2] << 8) | (uint8_t)input[3];
+            if (input.size() < 4 + length) break;
+            for (auto& stream : streams) {
+                const std::shared_ptr<MediaStreamHandler>& handler = stream.second.handler;
+                if (handler != nullptr && handler->udpHandler == nullptr && channel == handler->GetRTCPChannel()) {
+                    handler->OnRTCPPacket((const uint8_t*)input.data() + 4, length);
+                    break;
+                }
+            }
+            offset += 4 + length;
+            continue;
+        }
+        if (input[0] == '\r' || input[0] == '\n') {
+            offset++;
+            continue;
         }
 
-        int cseq = ParseCSeq(request);
-        if (cseq == -1) {
-            std::cerr << "CSeq parsing failed." << std::endl;
-            return;
+        long length = RTSPRequest::FindMessageLength(input, max_request_size);
+        if (length < 0) {
+            std::cerr << "RTSP request too large or invalid Content-Length." << std::endl;
+            return false;
         }
+        if (length == 0) break;
+        keep = HandleRequest(input.substr(0, length));
+        offset += length;
+    }
 
-        std::string method = ParseMethod(request);
-        if (method == "OPTIONS") {
-            HandleOptionsRequest(cseq);
-        } else if (method == "DESCRIBE") {
-            HandleDescribeRequest(request, cseq);
-        } else if (method == "SETUP") {
-            HandleSetupRequest(request, cseq);
-        } else if (method == "PLAY") {
-            HandlePlayRequest(cseq);
-        } else if (method == "PAUSE") {
-            HandlePauseRequest(cseq);
-        } else if (method == "TEARDOWN") {
-            HandleTeardownRequest(cseq);
-            break;
-        } else {
-            std::cerr << "Unsupported RTSP method: " << method << std::endl;
+    inputBuffer.erase(0, offset);
+    if (inputBuffer.size() > max_input_size) {
+        std::cerr << "RTSP input buffer exceeds " << max_input_size << " bytes." << std::endl;
+        return false;
+    }
+    return keep && connected;
+}
+
+/**
+ * @details RTSP 요청 처리:
+ *          1. 세션 활동 기록 (세션 타임아웃 연장)
+ *          2. 요청 줄과 헤더를 한 번에 파싱 (CSeq가 없거나 요청 줄이 잘못되면 연결 종료)
+ *          3. Session 헤더 검증 (이 연결의 세션이 아니면 454)
+ *          4. 메서드별 적절한 핸들러 호출 (지원하지 않는 메서드는 501)
+ */
+bool RequestHandler::HandleRequest(std::string_view text) {
+    session->Touch();
+
+    RTSPRequest request;
+    if (!request.Parse(text)) {
+        std::cerr << "RTSP request line parsing failed." << std::endl;
+        return false;
+    }
+    const int cseq = request.GetCSeq();
+    if (cseq == -1) {
+        std::cerr << "CSeq parsing failed." << std::endl;
+        return false;
+    }
+
+    std::string_view method = request.GetMethod();
+    if (RejectSession(request, cseq)) {
+        return true;
+    }
+    if (method == "OPTIONS") {
+        HandleOptionsRequest(cseq);
+    } else if (method == "DESCRIBE") {
+        HandleDescribeRequest(request, cseq);
+    } else if (method == "SETUP") {
+        HandleSetupRequest(request, cseq);
+    } else if (method == "PLAY") {
+        HandlePlayRequest(request, cseq);
+    } else if (method == "PAUSE") {
+        HandlePauseRequest(request, cseq);
+    } else if (method == "TEARDOWN") {
+        if (HandleTeardownRequest(request, cseq)) {
+            return false;
         }
+    } else if (method == "GET_PARAMETER" || method == "SET_PARAMETER") {
+        HandleParameterRequest(cseq);
+    } else {
+        std::cerr << "Unsupported RTSP method: " << method << std::endl;
+        BeginResponse("501 Not Implemented", cseq);
+        SendResponse();
     }
+    return true;
 }
 
 /**
- * @details RTSP 요청의 첫 줄에서 메서드 이름을 추출
+ * @details 출력 버퍼는 ClientSession이 관리
  */
-std::string RequestHandler::ParseMethod(const std::string& request) {
-    std::istringstream requestStream(request);
-    std::string method;
-    requestStream >> method;
-    return method;
+bool RequestHandler::OnWritable() {
+    return session->OnWritable();
 }
 
 /**
- * @details 요청 헤더에서 "CSeq" 필드를 찾아 값을 파싱
+ * @details TEARDOWN 없이 연결이 끊기거나 타임아웃되어도 송신을 멈추고 세션 테이블과 송신 풀에서 제거
  */
-int RequestHandler::ParseCSeq(const std::string& request) {
-    std::istringstream requestStream(request);
-    std::string line;
-    while (getline(requestStream, line)) {
-        if (line.find("CSeq") != std::string::npos) {
-            std::istringstream lineStream(line);
-            std::string label;
-            int cseq;
-            lineStream >> label >> cseq;
-            return cseq;
-        }
+void RequestHandler::Close() {
+    SessionTable::GetInstance().Remove(session->GetID());
+    ReleaseMediaStream();
+    session->CloseConnection();
+}
+
+/**
+ * @details 멀티캐스트 시청을 멈추고 모든 트랙 해제
+ *          소스를 1배가 아닌 배율로 바꿔 둔 세션이면 배율을 1배로 되돌리고 소스를 놓음
+ *          (배율을 바꾼 세션이 소스를 잡고 있는 동안 다른 세션은 합류하지 못하므로 이때 재생 중인 세션은 없음)
+ */
+void RequestHandler::ReleaseMediaStream() {
+    LeaveMulticast();
+    multicast = false;
+    while (!streams.empty()) {
+        ReleaseTrack(streams.begin()->first);
+    }
+    if (rateChanged) {
+        double scale = 1.0;
+        double speed = 1.0;
+        double npt = 0.0;
+        uint32_t rtpTime = 0;
+        RTSPServer::getInstance().changeRate(scale, speed, npt, rtpTime);
+        rateChanged = false;
     }
-    return -1; // CSeq not found
+    AdmissionControl::GetInstance().ReleaseSource(this, false);
 }
 
 /**
- * @details Transport 헤더에서 "client_port" 필드를 파싱하여 RTP/RTCP 포트 쌍 추출
+ * @details 트랙에 세션 핸들러가 있으면 RTCP BYE를 보내고 송신을 멈춘 뒤 송신 풀에서 제거
+ *          핸들러(UDPHandler 포함)는 진행 중인 송신 작업이 끝나면 해제됨
  */
-std::pair<int, int> RequestHandler::ParsePorts(const std::string& request) {
-    std::istringstream requestStream(request);
-    std::string line;
-    while (getline(requestStream, line)) {
-        if (line.find("client_port=") != std::string::npos) {
-            std::istringstream lineStream(line);
-            std::string label;
+void RequestHandler::ReleaseTrack(int track) {
+    auto it = streams.find(track);
+    if (it == streams.end()) {
+        return;
+    }
+    if (it->second.playing) {
+        AdmissionControl::GetInstance().StopStream(track);
+    }
+    const std::shared_ptr<MediaStreamHandler>& handler = it->second.handler;
+    if (handler != nullptr) {
+        handler->SendBye();
+        handler->SetCmd("TEARDOWN");
+        SenderPool::GetInstance().Remove(handler.get());
+    }
+    streams.erase(it);
+}
 
-            while (getline(lineStream, label, '/')) {
-                std::string portRange;
-                getline(lineStream, portRange);
-                size_t eqPos = portRange.find('=') + 1;
-                size_t dashPos = portRange.find('-');
+void RequestHandler::PrepareTrackSetup(int track, bool multicastSetup) {
+    if (multicastSetup != multicast) {
+        ReleaseMediaStream();
+    } else {
+        ReleaseTrack(track);
+    }
+}
 
-                if (dashPos != std::string::npos) {
-                    
-                    int rtpPort = stoi(portRange.substr(eqPos, dashPos - eqPos));
-                    int rtcpPort = stoi(portRange.substr(dashPos + 1));
-		            return {rtpPort, rtcpPort};
-                }
-            }
-        }
+/**
+ * @details 처음 SETUP 할 때 세션 테이블에 등록하고 (수락 제어에 예약한 자리를 새 세션으로 기록) 타임아웃을 포함한 Session 헤더를 응답 버퍼에 추가
+ *          다른 활성 세션과 ID가 겹치면 새 ID로 다시 등록 (max_session_id_retries번 모두 겹치면 실패)
+ */
+bool RequestHandler::AppendSetupSessionHeader() {
+    SessionTable& table = SessionTable::GetInstance();
+    const bool created = table.Find(session->GetID()) != session;
+    bool added = table.Add(session);
+    for (int retry = 0; retry < max_session_id_retries && !added; retry++) {
+        session->RegenerateID();
+        added = table.Add(session);
     }
-    return {-1, -1};
+    if (!added) {
+        std::cerr << "SETUP: no free session ID after " << max_session_id_retries << " retries" << std::endl;
+        return false;
+    }
+    if (created) {
+        AdmissionControl::GetInstance().AdmitSession();
+    }
+    responseBuffer.append("Session: ");
+    AppendSessionID(responseBuffer, session->GetID());
+    responseBuffer.append(";timeout=");
+    AppendNumber(responseBuffer, table.GetTimeout());
+    responseBuffer.append("\r\n");
+    return true;
 }
 
 /**
- * @details Accept 헤더에서 "application/sdp" 지원 여부 확인
+ * @details 만들던 트랙 핸들러를 해제하고 응답 버퍼를 503으로 바꿈 (예약한 세션 자리는 HandleSetupRequest가 돌려줌)
  */
-bool RequestHandler::ParseAccept(const std::string& request) {
-    std::istringstream requestStream(request);
-    std::string line;
-    while (getline(requestStream, line))
-        if (line.find("application/sdp") != std::string::npos)
-            return true;
-    return false;
+void RequestHandler::RejectSessionSetup(int cseq) {
+    ReleaseMediaStream();
+    RejectAdmission(eAdmission_Busy, cseq, false);
+}
+
+/**
+ * @details 이전 응답의 내용을 지우지만 버퍼 용량은 유지하므로 대부분의 응답은 할당 없이 만들어짐
+ */
+void RequestHandler::BeginResponse(const char* status, int cseq) {
+    responseBuffer.assign("RTSP/1.0 ");
+    responseBuffer.append(status);
+    responseBuffer.append("\r\nCSeq: ");
+    AppendNumber(responseBuffer, cseq);
+    responseBuffer.append("\r\n");
+}
+
+void RequestHandler::AppendSessionHeader() {
+    responseBuffer.append("Session: ");
+    AppendSessionID(responseBuffer, session->GetID());
+    responseBuffer.append("\r\n");
+}
+
+/**
+ * @details 헤더 끝(빈 줄)과 본문을 붙여 전송
+ */
+void RequestHandler::SendResponse(std::string_view body) {
+    responseBuffer.append("\r\n");
+    responseBuffer.append(body);
+    session->SendRTSPResponse(responseBuffer);
 }
 
 /**
  * @details 지원하는 RTSP 메서드 목록을 포함한 응답 생성
  */
 void RequestHandler::HandleOptionsRequest(const int cseq) {
-    std::string response = "RTSP/1.0 200 OK\r\n"
-                           "CSeq: " + std::to_string(cseq) + "\r\n"
-                           "Public: DESCRIBE, SETUP, TEARDOWN, PLAY, PAUSE\r\n"
-                           "\r\n";
-    TCPHandler::GetInstance().SendRTSPResponse(session->GetTCPSocket(), response);
+    BeginResponse("200 OK", cseq);
+    responseBuffer.append("Public: DESCRIBE, SETUP, TEARDOWN, PLAY, PAUSE, GET_PARAMETER, SET_PARAMETER\r\n");
+    SendResponse();
 }
 
 /**
  * @details 미디어 스트림 정보를 포함한 SDP 응답 생성:
- *          - 비디오(H264)나 오디오(Opus) 스트림 정보
- *          - 세션 ID, 버전, IP 주소 등의 정보 포함
- */
-void RequestHandler::HandleDescribeRequest(const std::string& request, const int cseq) {
-    std::string ip = GetServerIP();
-    std::string sdp = "";
-    std::string response = "";
-
-    if (ParseAccept(request)) {
-        response = "RTSP/1.0 200 OK\r\n";
-        if(RTSPServer::getInstance().getProtocol() == Protocol::PROTO_OPUS) {
-            sdp = "v=0\r\n"
-                "o=- " + std::to_string(session->GetID()) + " " + std::to_string(session->GetVersion()) + " IN IP4 " + ip + "\r\n"
-                "s=Opus Stream\r\n"
-                "c=IN IP4 " + ip + "\r\n"
-                "t=0 0\r\n"
-                "m=audio " + std::to_string(session->GetRTPPort()) + " RTP/AVP 111\r\n"  // Payload type for Opus
-                "a=rtpmap:111 opus/48000/2\r\n";  // Opus codec details
-        }else if(RTSPServer::getInstance().getProtocol() == Protocol::PROTO_H264) {
-            sdp = "v=0\r\n"
-                "o=- 0 0 IN IP4 " + ip + "\r\n"
-                "s=H264 Video Stream\r\n"
-                "c=IN IP4 " + ip + "\r\n"
-                "t=0 0\r\n"
-                "a=tool:libavformat LIBAVFORMAT_VERSION\r\n"
-                "m=video " + std::to_string(session->GetRTPPort()) + " RTP/AVP 96\r\n"
-                "b=AS:40\r\n"
-                "a=rtpmap:96 H264/90000\r\n"
-                "a=fmtp:96 packetization-mode=1\r\n";
+ *          - SDP는 클라이언트가 접속한 서버 주소(getsockname)별로 SDPCache에 만들어 둔 것을 사용
+ *          - 스트림 설정이 바뀌었을 때만 SDP를 다시 만들며, 호스트 이름 조회(DNS)는 하지 않음
+ *          - 멀티캐스트 프레젠테이션 URL이면 그룹 주소/포트를 알리는 SDP (멀티캐스트가 설정되지 않았으면 404)
+ */
+void RequestHandler::HandleDescribeRequest(const RTSPRequest& request, const int cseq) {
+    const bool multicastURI = IsMulticastURI(request.GetURI());
+    if (multicastURI && !MulticastSender::GetInstance().IsEnabled()) {
+        BeginResponse("404 Not Found", cseq);
+        SendResponse();
+        return;
+    }
+    std::shared_ptr<const SDPDescription> description = SDPCache::GetInstance().Get(session->GetLocalIP(), multicastURI);
+    std::string_view sdp;
+    if (request.Accepts("application/sdp")) {
+        BeginResponse("200 OK", cseq);
+        sdp = description->sdp;
+    } else {
+        BeginResponse("406 Not Acceptable", cseq);
+    }
+
+    responseBuffer.append("Content-Base: ");
+    responseBuffer.append(description->contentBase);
+    responseBuffer.append("\r\nContent-Type: application/sdp\r\nContent-Length: ");
+    AppendNumber(responseBuffer, (long)sdp.size());
+    responseBuffer.append("\r\n");
+    SendResponse(sdp);
+}
+
+/**
+ * @details 스트리밍을 위한 초기 설정 처리:
+ *          1. 요청 URI의 trackID로 트랙 선택 (트랙 URL이 아니면 0번 트랙, 없는 트랙이면 404)
+ *          2. Transport 검사 (interleaved 채널이 범위를 벗어났거나 UDP 유니캐스트에 client_port가 없으면 461)
+ *          3. 수락 제어 (새 세션이면 세션 수/CPU 예산, 새 트랙이면 송신 비트레이트 예산, 넘으면 503 또는 453)
+ *             새 세션은 세션 자리를 예약하고, 세션 테이블에 등록하지 못하면(ID가 계속 겹침) 503으로 응답하고 자리를 돌려줌
+ *          4. RTP/RTCP 포트 및 rtcp-mux 설정 (RTP/AVP/TCP 요청이면 interleaved 채널, multicast 요청이면 그룹 설정)
+ *          5. 공유 UDP 소켓으로 보낼 목적지 설정 및 RTCP 수신 등록 (interleaved 세션은 RTSP 연결 사용)
+ *          6. 트랙의 미디어 스트림 핸들러 초기화 (같은 트랙을 다시 SETUP 하면 이전 핸들러 교체, 다른 트랙은 세션에 추가)
+ *          7. 송신 스레드 풀에 등록 (세션별 스레드는 만들지 않음)
+ */
+void RequestHandler::HandleSetupRequest(const RTSPRequest& request, const int cseq) {
+    int track = FindTrackID(request.GetURI());
+    if (track == -1) {
+        track = 0;
+    }
+    if (track < 0 || track >= RTSPServer::getInstance().getTrackCount()) {
+        BeginResponse("404 Not Found", cseq);
+        SendResponse();
+        return;
+    }
+
+    const RTSPTransport& requested = request.GetTransport();
+    const bool registered = SessionTable::GetInstance().Find(session->GetID()) == session;
+    if ((requested.tcp && requested.invalidChannel)
+        || (!requested.tcp && !requested.multicast && (requested.clientRTPPort < 0 || requested.clientRTCPPort < 0))) {
+        std::cerr << "unsupported Transport in SETUP" << std::endl;
+        BeginResponse("461 Unsupported Transport", cseq);
+        if (registered) {
+            AppendSessionHeader();
         }
+        SendResponse();
+        return;
+    }
+
+    AdmissionControl& admission = AdmissionControl::GetInstance();
+    AdmissionResult result = registered ? eAdmission_Accepted : admission.CheckSession();
+    const bool reserved = !registered && result == eAdmission_Accepted;
+    if (result == eAdmission_Accepted && streams.count(track) == 0) {
+        if (requested.multicast && !requested.tcp) {
+            result = admission.CheckStreams({}, {track});
+        } else {
+            result = admission.CheckStreams({track});
+        }
+    }
+    if (result != eAdmission_Accepted) {
+        if (reserved) {
+            admission.ReleaseSession();
+        }
+        RejectAdmission(result, cseq, registered);
+        return;
+    }
+
+    if (requested.tcp) {
+        // 채널을 보내지 않으면 트랙 번호로 정함 (0번 트랙 0-1, 1번 트랙 2-3)
+        if (requested.rtpChannel < 0) {
+            HandleInterleavedSetup(track, {2 * track, 2 * track + 1}, cseq);
+        } else {
+            HandleInterleavedSetup(track, {requested.rtpChannel, requested.rtcpChannel}, cseq);
+        }
+    } else if (requested.multicast) {
+        HandleMulticastSetup(track, cseq);
     } else {
-        response = "RTSP/1.0 406 Not Acceptable\r\n";
+        session->SetRTPPort(requested.clientRTPPort);
+        session->SetRTCPPort(requested.clientRTCPPort);
+        session->SetRTCPMux(requested.rtcpMux || requested.clientRTPPort == requested.clientRTCPPort);
+
+        PrepareTrackSetup(track, false);
+        auto handler = std::make_shared<MediaStreamHandler>(track);
+        handler->clientSession = session;
+        handler->udpHandler = new UDPHandler(session);
+        handler->udpHandler->InitTransport();
+        UDPServer::GetInstance().Register(handler.get());
+        streams[track].handler = handler;
+
+        BeginResponse("200 OK", cseq);
+        responseBuffer.append("Transport: RTP/AVP;unicast;client_port=");
+        AppendNumber(responseBuffer, session->GetRTPPort());
+        if (!session->IsRTCPMux()) {
+            responseBuffer.append("-");
+            AppendNumber(responseBuffer, session->GetRTCPPort());
+        }
+        responseBuffer.append(";server_port=");
+        AppendNumber(responseBuffer, handler->udpHandler->GetServerRTPPort());
+        if (session->IsRTCPMux()) {
+            responseBuffer.append(";RTCP-mux");
+        } else {
+            responseBuffer.append("-");
+            AppendNumber(responseBuffer, handler->udpHandler->GetServerRTCPPort());
+        }
+        responseBuffer.append(";ssrc=");
+        responseBuffer.append(ToHex(handler->GetSSRC()));
+        responseBuffer.append("\r\n");
+        if (AppendSetupSessionHeader()) {
+            SendResponse();
+            RTSPServer::getInstance().fireInitEvent();
+            SenderPool::GetInstance().Add(handler);
+        } else {
+            RejectSessionSetup(cseq);
+        }
     }
 
-    response += "CSeq: " + std::to_string(cseq) + "\r\n"
-                "Content-Base: rtsp://" + ip + ":" + std::to_string(g_serverRtpPort) +"/\r\n"
-                "Content-Type: application/sdp\r\n"
-                "Content-Length: " + std::to_string(sdp.size()) + "\r\n"
-                "\r\n" + sdp;
+    // 실패한 SETUP(461, 세션 등록 실패)이면 예약한 세션 자리를 돌려줌
+    if (reserved && SessionTable::GetInstance().Find(session->GetID()) != session) {
+        admission.ReleaseSession();
+    }
+    auto it = streams.find(track);
+    if (it != streams.end()) {
+        it->second.uri.assign(request.GetURI());
+    }
+}
+
+/**
+ * @details RTP/AVP/TCP 설정 처리:
+ *          UDP 소켓을 할당하지 않고 트랙의 미디어 핸들러가 RTSP 세션의 TCP 연결로 트랙 채널 번호를 붙여 '$' 프레이밍하여 전송하도록 설정
+ */
+void RequestHandler::HandleInterleavedSetup(int track, const std::pair<int, int>& channels, const int cseq) {
+    PrepareTrackSetup(track, false);
+    session->SetInterleaved(true);
+    auto handler = std::make_shared<MediaStreamHandler>(track);
+    handler->clientSession = session;
+    handler->SetInterleavedChannels(channels.first, channels.second);
+    streams[track].handler = handler;
 
-    TCPHandler::GetInstance().SendRTSPResponse(session->GetTCPSocket(), response);
+    BeginResponse("200 OK", cseq);
+    responseBuffer.append("Transport: RTP/AVP/TCP;unicast;interleaved=");
+    AppendNumber(responseBuffer, channels.first);
+    responseBuffer.append("-");
+    AppendNumber(responseBuffer, channels.second);
+    responseBuffer.append(";ssrc=");
+    responseBuffer.append(ToHex(handler->GetSSRC()));
+    responseBuffer.append("\r\n");
+    if (!AppendSetupSessionHeader()) {
+        RejectSessionSetup(cseq);
+        return;
+    }
+    SendResponse();
+
+    RTSPServer::getInstance().fireInitEvent();
+
+    SenderPool::GetInstance().Add(handler);
 }
 
 /**
- * @details 스트리밍을 위한 초기 설정 처리:
- *          1. RTP/RTCP 포트 설정
- *          2. UDP 소켓 생성
- *          3. 미디어 스트림 핸들러 초기화
- *          4. 스트리밍 스레드 시작
- */
-void RequestHandler::HandleSetupRequest(const std::string& request, const int cseq) {
-    auto ports = ParsePorts(request);
-    if (ports.first < 0 || ports.second < 0) {
-        std::cerr << "not found IP or Port in SETUP" << std::endl;
+ * @details 멀티캐스트 설정 처리:
+ *          세션별 핸들러를 만들지 않고 MulticastSender의 트랙 공유 핸들러를 사용하며,
+ *          응답에 그룹 주소/트랙 포트/TTL과 공유 스트림의 SSRC를 알림
+ *          시청자의 RTCP는 공유 핸들러로 들어와 세션 활동이 되지 않으므로, 시청자는 Session 헤더의
+ *          timeout= 안에 RTSP keepalive(GET_PARAMETER, OPTIONS)를 보내야 세션이 유지됨
+ */
+void RequestHandler::HandleMulticastSetup(int track, const int cseq) {
+    MulticastSender& multicastSender = MulticastSender::GetInstance();
+    if (!multicastSender.Prepare(track)) {
+        BeginResponse("461 Unsupported Transport", cseq);
+        SendResponse();
         return;
     }
-    session->SetRTPPort(ports.first);
-    session->SetRTCPPort(ports.second);
+    PrepareTrackSetup(track, true);
+    multicast = true;
+    streams[track].handler = nullptr;
 
-    std::string response = "RTSP/1.0 200 OK\r\n"
-                           "CSeq: " + std::to_string(cseq) + "\r\n"
-                           "Transport: RTP/AVP;unicast;client_port="
-                           + std::to_string(session->GetRTPPort()) + "-"
-                           + std::to_string(session->GetRTCPPort()) + "\r\n"
-                           "Session: " + std::to_string(session->GetID())
-                           + "\r\n"
-                             "\r\n";
-    TCPHandler::GetInstance().SendRTSPResponse(session->GetTCPSocket(), response);
+    const int port = multicastSender.GetRTPPort(track);
+    BeginResponse("200 OK", cseq);
+    responseBuffer.append("Transport: RTP/AVP;multicast;destination=");
+    responseBuffer.append(multicastSender.GetGroup());
+    responseBuffer.append(";port=");
+    AppendNumber(responseBuffer, port);
+    responseBuffer.append("-");
+    AppendNumber(responseBuffer, port + 1);
+    responseBuffer.append(";ttl=");
+    AppendNumber(responseBuffer, multicastSender.GetTTL());
+    responseBuffer.append(";ssrc=");
+    responseBuffer.append(ToHex(multicastSender.GetSSRC(track)));
+    responseBuffer.append("\r\n");
+    if (!AppendSetupSessionHeader()) {
+        RejectSessionSetup(cseq);
+        return;
+    }
+    SendResponse();
 
-    RTSPServer::getInstance().onInitEvent();  //TODO : play function when occur init event
+    RTSPServer::getInstance().fireInitEvent();
+}
 
-    mediaStreamHandler = new MediaStreamHandler();
-    mediaStreamHandler->udpHandler = new UDPHandler(session);
-    mediaStreamHandler->udpHandler->CreateUDPSocket();
-    std::thread mediaStreamThread(&MediaStreamHandler::HandleMediaStream, mediaStreamHandler);
+/**
+ * @details 재생 중인 시청자였을 때만 참조 카운트 감소
+ */
+void RequestHandler::LeaveMulticast() {
+    if (multicastJoined) {
+        multicastJoined = false;
+        AdmissionControl::GetInstance().StopMulticast();
+        MulticastSender::GetInstance().Leave();
+    }
+}
 
-    mediaStreamThread.detach();
+/**
+ * @details keepalive 처리
+ *          요청을 받은 것만으로 세션 활동이 기록되므로 빈 200 OK로 응답 (지원하는 파라미터 없음)
+ */
+void RequestHandler::HandleParameterRequest(int cseq) {
+    BeginResponse("200 OK", cseq);
+    AppendSessionHeader();
+    SendResponse();
 }
 
 /**
- * @details 미디어 스트림 재생 명령 처리
+ * @details
+ *   - Session 헤더가 있으면 세션 테이블에서 ID로 찾아 이 연결이 SETUP 한 세션인지 확인
+ *     (다른 연결의 세션 ID, 만료되었거나 발급하지 않은 ID, 형식이 잘못된 ID 모두 454)
+ *   - 세션 상태를 바꾸는 PLAY/PAUSE/TEARDOWN은 Session 헤더가 반드시 있어야 함 (RFC 2326 12.37)
+ *   - SETUP은 첫 SETUP에 Session 헤더가 없으므로 헤더가 있을 때만 확인
  */
-void RequestHandler::HandlePlayRequest(int cseq) {
-    std::string response = "RTSP/1.0 200 OK\r\n"
-                           "CSeq: " + std::to_string(cseq) + "\r\n"
-                           "Session: " + std::to_string(session->GetID())
-                           + "\r\n"
-                             "\r\n";
-    TCPHandler::GetInstance().SendRTSPResponse(session->GetTCPSocket(), response);
+bool RequestHandler::RejectSession(const RTSPRequest& request, int cseq) {
+    const RTSPSessionHeader& header = request.GetSession();
+    if (header.present) {
+        const uint64_t id = ParseSessionID(header.id);
+        if (id != 0 && id == session->GetID() && SessionTable::GetInstance().Find(id) == session) {
+            return false;
+        }
+    } else {
+        std::string_view method = request.GetMethod();
+        if (method != "PLAY" && method != "PAUSE" && method != "TEARDOWN") {
+            return false;
+        }
+    }
+    BeginResponse("454 Session Not Found", cseq);
+    SendResponse();
+    return true;
+}
 
-    mediaStreamHandler->SetCmd("PLAY");
+/**
+ * @details 송신 비트레이트 초과는 453, 공유 소스의 위치/배율 변경은 455, 세션 수/CPU 초과는 잠시 뒤 다시 시도하도록 503과 Retry-After
+ */
+void RequestHandler::RejectAdmission(AdmissionResult result, int cseq, bool withSession) {
+    if (result == eAdmission_NoBandwidth) {
+        BeginResponse("453 Not Enough Bandwidth", cseq);
+    } else if (result == eAdmission_SourceShared) {
+        BeginResponse("455 Method Not Valid in This State", cseq);
+    } else {
+        BeginResponse("503 Service Unavailable", cseq);
+        responseBuffer.append("Retry-After: ");
+        AppendNumber(responseBuffer, AdmissionControl::retry_after_sec);
+        responseBuffer.append("\r\n");
+    }
+    if (withSession) {
+        AppendSessionHeader();
+    }
+    SendResponse();
+}
+
+/**
+ * @details 세션이 트랙 하나뿐이면 트랙 URL로 보낸 요청도 세션 전체에 적용
+ */
+bool RequestHandler::RejectTrackOperation(const RTSPRequest& request, int cseq) {
+    if (streams.size() <= 1 || FindTrackID(request.GetURI()) < 0) {
+        return false;
+    }
+    BeginResponse("460 Only Aggregate Operation Allowed", cseq);
+    AppendSessionHeader();
+    SendResponse();
+    return true;
 }
 
 /**
- * @details 미디어 스트림 일시 정지 명령 처리
+ * @details 미디어 스트림 재생 명령 처리 (SETUP 한 모든 트랙을 한 번에 재생, 여러 트랙이면 트랙 URL로는 460)
+ *          - Range에 시작 시각이 있고 소스가 위치를 옮길 수 있으면(onSeekEvent) 그 이전의 가장 가까운 IDR로 이동
+ *            (이동에 실패하면 배율을 바꾸기 전에 457로 응답하여 소스 상태를 그대로 둠)
+ *          - Scale/Speed가 있고 소스가 배율을 바꿀 수 있으면(onRateEvent) 지원 범위로 맞춰 적용하고 현재 위치의 IDR부터 다시 시작
+ *            (이전 PLAY에서 배율을 바꿨으면 Scale/Speed가 없는 PLAY는 1배로 되돌림)
+ *          - 이동했으면 응답의 Range에 실제 시작 시각을, RTP-Info에 첫 패킷의 시퀀스 번호와 RTP 타임스탬프를 알림
+ *            (소스가 알려주는 RTP 타임스탬프는 0번 트랙 기준이므로 다른 트랙은 현재 위치부터 이어서 전송)
+ *          - RTP-Info는 트랙마다 url;seq[;rtptime]을 ','로 이어서 알림
+ *          - 라이브 소스이거나 Range가 없으면 현재 위치부터 재생 (Range: npt=now-, 요청한 Scale/Speed에는 1로 응답)
+ *            재생을 시작한 클라이언트가 다음 주기적 IDR을 기다리지 않도록 키프레임을 요청하고,
+ *            버퍼에 남은 키프레임부터 바로 보내도록 송신 작업을 예약
+ *          - 새로 재생을 시작하는 트랙은 수락 제어로 송신 비트레이트/CPU 예산을 검사 (넘으면 453 또는 503, 재생하지 않음)
+ *          - npt 형식이 아니거나 재생 시간을 벗어난 Range는 457 Invalid Range (끝 시각은 무시)
+ *          - 멀티캐스트 세션은 공유 송신자의 시청자로 추가 (공유 스트림이므로 이동하거나 배율을 바꾸지 않음)
+ *          - 소스는 모든 세션이 공유하므로 다른 세션이 재생 중이면 위치와 배율을 옮기지 않음
+ *            (재생 중인 세션의 Range, 1이 아닌 Scale/Speed, 1배로 되돌리는 PLAY는 455,
+ *             재생을 시작하는 세션의 Range는 무시하고 현재 위치에 합류)
+ *          - 다른 세션이 소스를 1배가 아닌 배율로 재생 중이면 합류하는 PLAY도 455 (요청하지 않은 배율을 받지 않도록)
  */
-void RequestHandler::HandlePauseRequest(int cseq) {
-    std::string response = "RTSP/1.0 200 OK\r\n"
-                           "CSeq: " + std::to_string(cseq) + "\r\n"
-                           "Session: " + std::to_string(session->GetID())
-                           + "\r\n"
-                             "\r\n";
+void RequestHandler::HandlePlayRequest(const RTSPRequest& request, int cseq) {
+    if (RejectTrackOperation(request, cseq)) {
+        return;
+    }
+    const RTSPRange& range = request.GetRange();
+    RTSPServer& server = RTSPServer::getInstance();
+    const bool controllable = !multicast && !streams.empty();
+    double npt = 0.0;
+    uint32_t rtpTime = 0;
+    double scale = 1.0;
+    double speed = 1.0;
+    bool seek = false;
+    if (range.present && !range.valid) {
+        BeginResponse("457 Invalid Range", cseq);
+        AppendSessionHeader();
+        SendResponse();
+        return;
+    }
+
+    bool seekRequested = range.hasStart && controllable && server.onSeekEvent;
+    const bool rateRequested = (request.GetScale() != 0.0 && request.GetScale() != 1.0)
+                            || (request.GetSpeed() != 0.0 && request.GetSpeed() != 1.0);
+
+    std::vector<int> startTracks;
+    std::vector<int> multicastTracks;
+    int playingStreams = 0;
+    for (auto& stream : streams) {
+        if (multicast && !multicastJoined) {
+            multicastTracks.push_back(stream.first);
+        } else if (!multicast && !stream.second.playing) {
+            startTracks.push_back(stream.first);
+        }
+        playingStreams += stream.second.playing ? 1 : 0;
+    }
+    // 소스 공유 확인과 재생 기록을 한 번에 해야 그 사이에 재생을 시작한 세션을 놓치지 않음
+    AdmissionControl& admissionControl = AdmissionControl::GetInstance();
+    // 이전 PLAY에서 바꾼 배율을 1배로 되돌리는 것도 소스를 옮기는 것이므로 같은 검사를 받음
+    const bool rateReset = rateChanged && server.onRateEvent;
+    bool exclusive = controllable && (seekRequested || rateRequested || rateReset);
+    AdmissionResult admission = admissionControl.StartStreams(startTracks, multicastTracks,
+                                                              exclusive ? this : nullptr, playingStreams);
+    if (admission == eAdmission_SourceShared && !rateRequested && !rateReset && playingStreams == 0) {
+        // 재생을 시작하는 세션의 Range는 무시하고 현재 위치에 합류
+        seekRequested = false;
+        exclusive = false;
+        admission = admissionControl.StartStreams(startTracks, multicastTracks);
+    }
+    if (admission != eAdmission_Accepted) {
+        RejectAdmission(admission, cseq, true);
+        return;
+    }
+    for (int track : startTracks) {
+        streams[track].playing = true;
+    }
+    // 이동에 실패하면 457로 응답하므로 배율을 바꾸기 전에 먼저 이동 (배율은 이동한 IDR에서 다시 시작)
+    if (seekRequested) {
+        npt = range.start;
+        seek = server.seek(npt, rtpTime);
+        if (!seek) {
+            for (int track : startTracks) {
+                streams[track].playing = false;
+                admissionControl.StopStream(track);
+            }
+            admissionControl.ReleaseSource(this, rateChanged);
+            BeginResponse("457 Invalid Range", cseq);
+            AppendSessionHeader();
+            SendResponse();
+            return;
+        }
+    }
+    if (exclusive && server.onRateEvent && (rateRequested || rateReset)) {
+        scale = (request.GetScale() != 0.0) ? request.GetScale() : 1.0;
+        speed = (request.GetSpeed() != 0.0) ? request.GetSpeed() : 1.0;
+        const bool restarted = server.changeRate(scale, speed, npt, rtpTime);
+        rateChanged = restarted && (scale != 1.0 || speed != 1.0);
+        seek = seek || restarted;
+    }
+    if (exclusive) {
+        admissionControl.ReleaseSource(this, rateChanged);
+    }
 
-    TCPHandler::GetInstance().SendRTSPResponse(session->GetTCPSocket(), response);
+    BeginResponse("200 OK", cseq);
+    AppendSessionHeader();
+    if (seek) {
+        responseBuffer.append("Range: npt=");
+        AppendDecimal(responseBuffer, npt);
+        responseBuffer.append("-");
+        if (server.getDuration() > 0 && scale > 0) {
+            AppendDecimal(responseBuffer, server.getDuration());
+        }
+        responseBuffer.append("\r\n");
+    } else {
+        responseBuffer.append("Range: npt=now-\r\n");
+    }
+    if (request.GetScale() != 0.0) {
+        responseBuffer.append("Scale: ");
+        AppendDecimal(responseBuffer, scale);
+        responseBuffer.append("\r\n");
+    }
+    if (request.GetSpeed() != 0.0) {
+        responseBuffer.append("Speed: ");
+        AppendDecimal(responseBuffer, speed);
+        responseBuffer.append("\r\n");
+    }
+    if (controllable) {
+        responseBuffer.append("RTP-Info: ");
+        for (auto it = streams.begin(); it != streams.end(); ++it) {
+            const bool trackSeek = seek && it->first == 0;
+            const uint16_t seq = it->second.handler->Restart(trackSeek, rtpTime);
+            if (it != streams.begin()) {
+                responseBuffer.append(",");
+            }
+            responseBuffer.append("url=");
+            responseBuffer.append(it->second.uri);
+            responseBuffer.append(";seq=");
+            AppendNumber(responseBuffer, seq);
+            if (trackSeek) {
+                responseBuffer.append(";rtptime=");
+                AppendNumber(responseBuffer, rtpTime);
+            }
+        }
+        responseBuffer.append("\r\n");
+    }
+    SendResponse();
 
-    mediaStreamHandler->SetCmd("PAUSE");
+    if (multicast) {
+        // 이미 재생 중이면 참조 카운트를 늘리지 않음
+        if (!multicastJoined) {
+            multicastJoined = true;
+            MulticastSender::GetInstance().Join();
+        }
+        return;
+    }
+    for (auto& stream : streams) {
+        stream.second.handler->SetCmd("PLAY");
+        if (!seek || stream.first != 0) {
+            server.requestKeyframe(stream.first);
+        }
+        SenderPool::GetInstance().Wake(stream.second.handler.get());
+    }
 }
 
 /**
- * @details 세션 종료 및 리소스 정리 처리
+ * @details 미디어 스트림 일시 정지 명령 처리 (모든 트랙, 멀티캐스트 세션은 시청자에서 제외)
  */
-void RequestHandler::HandleTeardownRequest(int cseq) {
-    std::string response = "RTSP/1.0 200 OK\r\n"
-                           "CSeq: " + std::to_string(cseq) + "\r\n"
-                           "Session: " + std::to_string(session->GetID())
-                           + "\r\n"
-                             "\r\n";
+void RequestHandler::HandlePauseRequest(const RTSPRequest& request, int cseq) {
+    if (RejectTrackOperation(request, cseq)) {
+        return;
+    }
+    BeginResponse("200 OK", cseq);
+    AppendSessionHeader();
+    SendResponse();
+
+    LeaveMulticast();
+    for (auto& stream : streams) {
+        if (stream.second.playing) {
+            stream.second.playing = false;
+            AdmissionControl::GetInstance().StopStream(stream.first);
+        }
+        if (stream.second.handler != nullptr) {
+            stream.second.handler->SetCmd("PAUSE");
+        }
+    }
+}
 
-    TCPHandler::GetInstance().SendRTSPResponse(session->GetTCPSocket(), response);
+/**
+ * @details 세션 종료 및 리소스 정리 처리 (수신자에게 트랙마다 RTCP BYE 전송)
+ *          여러 트랙을 SETUP 한 세션에 트랙 URL로 보내면 그 트랙만 해제하고 세션과 연결은 유지
+ *          송신 풀에서 제거하며, 핸들러는 남은 송신 작업이 끝나면 해제됨
+ *          멀티캐스트 세션은 시청자에서 제외 (마지막 시청자면 멀티캐스트 송신 정지)
+ */
+bool RequestHandler::HandleTeardownRequest(const RTSPRequest& request, int cseq) {
+    const int track = FindTrackID(request.GetURI());
+    BeginResponse("200 OK", cseq);
+    AppendSessionHeader();
+    SendResponse();
 
-    mediaStreamHandler->SetCmd("TEARDOWN");
+    if (track >= 0 && streams.size() > 1 && streams.count(track) != 0) {
+        ReleaseTrack(track);
+        return false;
+    }
+    ReleaseMediaStream();
+    return true;
 }
@@ -0,0 +1,209 @@
+/**
+ * @file SDPCache.cpp
+ * @brief SDPCache 클래스의 구현부
+ * @details 스트림 설정 비교와 서버 주소별 SDP 생성 구현
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "SDPCache.h"
+#include "Global.h"
+#include "RTSPServer.h"
+#include "MulticastSender.h"
+#include "RTPHeader.hpp"
+
+#include <cstdio>
+
+/**
+ * @brief RTP 헤더 확장을 알리는 SDP extmap 속성을 반환하는 함수 (RFC 8285)
+ * @details ID는 RTPPacket이 기록하는 확장 ID와 같아야 함
+ */
+static std::string RTPExtensionSDP() {
+    return "a=extmap:" + std::to_string(RTP_EXT_ID_ABS_SEND_TIME)
+         + " http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+           "a=extmap:" + std::to_string(RTP_EXT_ID_TRANSPORT_SEQ)
+         + " http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n";
+}
+
+/**
+ * @brief 바이너리 데이터를 Base64 문자열로 변환하는 함수 (RFC 4648, 패딩 포함)
+ */
+static std::string Base64Encode(const std::string& data) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        const uint32_t v = ((uint8_t)data[i] << 16) | ((uint8_t)data[i + 1] << 8) | (uint8_t)data[i + 2];
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += table[(v >> 6) & 0x3F];
+        out += table[v & 0x3F];
+    }
+    if (i < data.size()) {
+        uint32_t v = (uint8_t)data[i] << 16;
+        if (i + 1 < data.size()) v |= (uint8_t)data[i + 1] << 8;
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += (i + 1 < data.size()) ? table[(v >> 6) & 0x3F] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+/**
+ * @brief H264 fmtp 파라미터를 만드는 함수 (RFC 6184 8.1)
+ * @details SPS의 profile_idc, constraint 플래그, level_idc 3바이트가 profile-level-id
+ *          SPS/PPS를 모르면 packetization-mode만 알림
+ */
+static std::string H264FormatParameters(const std::string& sps, const std::string& pps) {
+    std::string fmtp = "packetization-mode=1";
+    if (sps.size() >= 4 && !pps.empty()) {
+        char profileLevelId[7];
+        snprintf(profileLevelId, sizeof(profileLevelId), "%02X%02X%02X", (uint8_t)sps[1], (uint8_t)sps[2], (uint8_t)sps[3]);
+        fmtp += ";profile-level-id=";
+        fmtp += profileLevelId;
+        fmtp += ";sprop-parameter-sets=" + Base64Encode(sps) + "," + Base64Encode(pps);
+    }
+    return fmtp;
+}
+
+/**
+ * @details SDP 세션 ID는 서버가 살아 있는 동안 유지 (버전만 증가)
+ *          Get()이 읽는 MulticastSender를 먼저 생성
+ *          (RTSPServer는 생성자에서 이 캐시를 만들고, 소멸자에서 요청 처리를 모두 멈추므로 여기서 만들지 않음)
+ */
+SDPCache::SDPCache() : sessionID(GetRanNum(32)) {
+    MulticastSender::GetInstance();
+}
+
+/**
+ * @details 요청마다 설정값 몇 개만 비교하고, 같으면 만들어 둔 SDP를 공유 포인터로 반환
+ */
+std::shared_ptr<const SDPDescription> SDPCache::Get(const std::string& serverIP, bool multicast) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    StreamParams params = CurrentParams();
+    Entry& entry = entries[{serverIP, multicast}];
+    if (entry.description == nullptr || !(entry.params == params)) {
+        entry.params = params;
+        entry.description = Build(serverIP, multicast, params);
+    }
+    return entry.description;
+}
+
+void SDPCache::SetH264ParameterSets(const std::string& sps, const std::string& pps, int track) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    TrackParams& params = trackParams[track];
+    if (sps == params.h264SPS && pps == params.h264PPS) return;
+    params.h264SPS = sps;
+    params.h264PPS = pps;
+    generation++;
+}
+
+void SDPCache::SetBitrate(int kbps, int track) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    TrackParams& params = trackParams[track];
+    if (kbps == params.bitrateKbps) return;
+    params.bitrateKbps = kbps;
+    generation++;
+}
+
+int SDPCache::GetBitrate(int track) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = trackParams.find(track);
+    return it != trackParams.end() ? it->second.bitrateKbps : 0;
+}
+
+void SDPCache::SetDuration(double seconds) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (seconds == durationSec) return;
+    durationSec = seconds;
+    generation++;
+}
+
+void SDPCache::Invalidate() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    generation++;
+}
+
+SDPCache::StreamParams SDPCache::CurrentParams() {
+    StreamParams params;
+    RTSPServer& server = RTSPServer::getInstance();
+    for (int track = 0; track < server.getTrackCount(); track++) {
+        params.tracks.push_back(server.getTrackProtocol(track));
+    }
+    MulticastSender& multicastSender = MulticastSender::GetInstance();
+    if (multicastSender.IsEnabled()) {
+        params.multicastGroup = multicastSender.GetGroup();
+        params.multicastPort = multicastSender.GetRTPPort();
+        params.multicastTTL = multicastSender.GetTTL();
+    }
+    params.generation = generation;
+    return params;
+}
+
+/**
+ * @details 미디어 스트림 정보를 포함한 SDP 생성:
+ *          - 세션 수준 a=control:*와 트랙마다 비디오(H264)나 오디오(Opus) m= 줄, a=control:trackID=N
+ *            (클라이언트는 트랙 URL로 SETUP 하고, 세션 URL(Content-Base)로 한 번에 PLAY/PAUSE/TEARDOWN)
+ *          - 멀티캐스트 프레젠테이션이면 그룹 주소/TTL과 트랙별 그룹 포트, Content-Base는 multicast_path
+ *          - 유니캐스트 프레젠테이션은 멀티캐스트 설정과 관계없이 서버 주소와 포트 0
+ *            (유니캐스트 포트는 SETUP의 Transport 헤더로 정함)
+ *          - 비트레이트를 알면 b=AS, H264는 SPS/PPS를 알면 profile-level-id와 sprop-parameter-sets
+ *          - 파일처럼 재생 시간이 있으면 세션 수준 a=range:npt=0-재생시간
+ */
+std::shared_ptr<const SDPDescription> SDPCache::Build(const std::string& serverIP, bool multicast, const StreamParams& params) {
+    auto description = std::make_shared<SDPDescription>();
+    sessionVersion++;
+
+    multicast = multicast && !params.multicastGroup.empty();
+    std::string connection = serverIP;
+    if (multicast) {
+        connection = params.multicastGroup + "/" + std::to_string(params.multicastTTL);
+    }
+    std::string range;
+    if (durationSec > 0) {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "a=range:npt=0-%.3f\r\n", durationSec);
+        range = buffer;
+    }
+    std::string name = "Media Presentation";
+    if (params.tracks.size() == 1) {
+        name = (params.tracks[0] == Protocol::PROTO_OPUS) ? "Opus Stream" : "H264 Video Stream";
+    }
+
+    description->sdp = "v=0\r\n"
+        "o=- " + std::to_string(sessionID) + " " + std::to_string(sessionVersion) + " IN IP4 " + serverIP + "\r\n"
+        "s=" + name + "\r\n"
+        "c=IN IP4 " + connection + "\r\n"
+        "t=0 0\r\n"
+        + range +
+        "a=control:*\r\n";
+
+    for (size_t track = 0; track < params.tracks.size(); track++) {
+        const TrackParams& codec = trackParams[(int)track];
+        const int mediaPort = multicast ? params.multicastPort + 2 * (int)track : 0;
+        const std::string bandwidth = codec.bitrateKbps > 0 ? "b=AS:" + std::to_string(codec.bitrateKbps) + "\r\n" : "";
+
+        if (params.tracks[track] == Protocol::PROTO_OPUS) {
+            description->sdp +=
+                "m=audio " + std::to_string(mediaPort) + " RTP/AVP 111\r\n"  // Payload type for Opus
+                + bandwidth +
+                "a=rtpmap:111 opus/48000/2\r\n";  // Opus codec details
+        } else if (params.tracks[track] == Protocol::PROTO_H264) {
+            description->sdp +=
+                "m=video " + std::to_string(mediaPort) + " RTP/AVP 96\r\n"
+                + bandwidth +
+                "a=rtpmap:96 H264/90000\r\n"
+                "a=fmtp:96 " + H264FormatParameters(codec.h264SPS, codec.h264PPS) + "\r\n";
+        }
+        description->sdp += RTPExtensionSDP() + "a=control:trackID=" + std::to_string(track) + "\r\n";
+    }
+    description->contentBase = "rtsp://" + serverIP + ":" + std::to_string(g_serverRtpPort) + "/";
+    if (multicast) {
+        description->contentBase.append(multicast_path);
+        description->contentBase += '/';
+    }
+    return description;
+}
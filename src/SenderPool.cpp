@@ -0,0 +1,306 @@
+/**
+ * @file SenderPool.cpp
+ * @brief SenderPool 클래스의 구현부
+ * @details SenderPool 클래스의 멤버 함수를 구현한 소스 파일
+ * 
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "SenderPool.h"
+#include "MediaStreamHandler.h"
+#include "DataCapture.h"
+#include "ThreadRegistry.h"
+
+#include <iostream>
+#include <functional>
+#include <ctime>
+
+/**
+ * @details DataCapture 트랙 인스턴스들을 먼저 생성하여 소멸 순서 보장
+ */
+SenderPool::SenderPool() {
+    DataCapture::getInstance();
+    ThreadRegistry::GetInstance();
+}
+
+/**
+ * @details 남아 있는 워커 스레드 종료
+ */
+SenderPool::~SenderPool() {
+    Stop();
+}
+
+/**
+ * @details
+ *   - 워커 수를 정하고 워커마다 수신함, 프레임 링, 스레드 생성 (다 만든 뒤 잠금 아래에서 한 번에 공개)
+ *   - 트랙별 DataCapture에 프레임이 기록될 때마다 트랙 번호와 함께 OnFrame이 호출되도록 등록
+ */
+bool SenderPool::Start(size_t workerCount) {
+    if (running.exchange(true)) {
+        return true;
+    }
+
+    if (workerCount == 0) {
+        workerCount = ThreadRegistry::GetInstance().GetCPUCount(eThreadRole_Sender);
+    }
+    if (workerCount == 0) {
+        workerCount = std::thread::hardware_concurrency();
+    }
+    if (workerCount == 0) {
+        workerCount = 1;
+    }
+
+    std::vector<std::unique_ptr<Shard>> started;
+    for (size_t i = 0; i < workerCount; i++) {
+        started.push_back(std::make_unique<Shard>());
+        started[i]->thread = std::thread(&SenderPool::WorkerLoop, this, std::ref(*started[i]), i);
+    }
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        shards = std::move(started);
+    }
+
+    for (int track = 0; track < DataCapture::max_tracks; track++) {
+        DataCapture::getInstance(track).setFrameEvent([this, track](const DataCaptureSharedFrame& frame) { OnFrame(track, frame); });
+    }
+    std::cout << "Start sender pool with " << workerCount << " workers" << std::endl;
+    return true;
+}
+
+/**
+ * @details
+ *   - 새 프레임 이벤트 연결을 끊음 (setFrameEvent는 진행 중인 OnFrame이 끝날 때까지 기다리므로 이후 생산자는 shards에 접근하지 않음)
+ *   - 워커 목록을 잠금 아래에서 떼어 내어 이후 Add/Remove/Wake/GetStats가 빈 목록을 보게 함
+ *     (워커가 송신 중에 Wake를 불러도 막히지 않도록 스레드를 기다리는 동안은 잠금을 잡지 않음)
+ *   - 모든 워커를 깨워 종료를 기다린 뒤 워커 상태(세션 참조, 프레임 링) 해제
+ */
+void SenderPool::Stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    for (int track = 0; track < DataCapture::max_tracks; track++) {
+        DataCapture::getInstance(track).setFrameEvent(nullptr);
+    }
+    std::vector<std::unique_ptr<Shard>> stopped;
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        stopped.swap(shards);
+    }
+    for (auto& shard : stopped) {
+        std::lock_guard<std::mutex> lock(shard->sleepMutex);
+        shard->sleepCondition.notify_all();
+    }
+
+    for (auto& shard : stopped) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    for (auto& shard : stopped) {
+        for (auto& session : shard->sessions) {
+            session.handler->SetSenderShard(-1);
+        }
+    }
+}
+
+/**
+ * @details 배정된 세션이 가장 적은 워커를 골라 등록 메시지를 보냄
+ */
+void SenderPool::Add(const std::shared_ptr<MediaStreamHandler>& handler) {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    if (!running || shards.empty()) {
+        return;
+    }
+
+    size_t home = 0;
+    for (size_t i = 1; i < shards.size(); i++) {
+        if (shards[i]->assigned < shards[home]->assigned) {
+            home = i;
+        }
+    }
+    shards[home]->assigned++;
+    handler->SetSenderShard((int)home);
+
+    Message message;
+    message.type = eMessage_Add;
+    message.handler = handler;
+    Post(*shards[home], std::move(message));
+}
+
+/**
+ * @details 소유 워커에만 알림 (워커는 진행 중인 송신을 마친 뒤 참조를 놓음)
+ */
+void SenderPool::Remove(MediaStreamHandler* handler) {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    const int home = handler->GetSenderShard();
+    if (!running || home < 0 || (size_t)home >= shards.size()) {
+        return;
+    }
+    handler->SetSenderShard(-1);
+    shards[home]->assigned--;
+
+    Message message;
+    message.type = eMessage_Remove;
+    message.target = handler;
+    Post(*shards[home], std::move(message));
+}
+
+/**
+ * @details 소유 워커에 송신 요청
+ */
+void SenderPool::Wake(MediaStreamHandler* handler) {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    const int home = handler->GetSenderShard();
+    if (!running || home < 0 || (size_t)home >= shards.size()) {
+        return;
+    }
+
+    Message message;
+    message.type = eMessage_Wake;
+    message.target = handler;
+    Post(*shards[home], std::move(message));
+}
+
+/**
+ * @details 워커마다 프레임 참조를 하나씩 전달 (세션 수와 무관하게 워커 수만큼만 일함)
+ */
+void SenderPool::OnFrame(int track, const DataCaptureSharedFrame& frame) {
+    if (!running) {
+        return;
+    }
+    for (auto& shard : shards) {
+        Message message;
+        message.type = eMessage_Frame;
+        message.frame = frame;
+        message.track = track;
+        Post(*shard, std::move(message));
+    }
+}
+
+/**
+ * @details
+ *   - 수신함에 넣은 뒤 워커가 잠들어 있을 때만 뮤텍스를 잡고 깨움
+ *   - 워커는 잠들기 전에 sleeping을 세우고 수신함을 다시 확인하므로, 양쪽의 메모리 장벽으로
+ *     "워커가 메시지를 보거나, 생산자가 sleeping을 보는" 둘 중 하나가 보장됨
+ */
+void SenderPool::Post(Shard& shard, Message message) {
+    message.queuedNs = ThreadRegistry::NowNs();
+    shard.inbox.Push(std::move(message));
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (shard.sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(shard.sleepMutex);
+        shard.sleepCondition.notify_one();
+    }
+}
+
+/**
+ * @details
+ *   - 등록/제거는 소유 세션 목록에 바로 반영
+ *   - 새 프레임은 트랙의 프레임 링에 넣고, 깨우기는 해당 세션만 송신 대상으로 표시
+ *   - 수신함에 들어간 뒤 꺼낼 때까지의 시간을 sender 역할의 스케줄링 지연으로 기록
+ */
+uint32_t SenderPool::DrainInbox(Shard& shard) {
+    ThreadRegistry& registry = ThreadRegistry::GetInstance();
+    uint32_t frameTracks = 0;
+    uint64_t signals = 0;
+    Message message;
+    while (shard.inbox.Pop(message)) {
+        switch (message.type) {
+            case eMessage_Frame:
+                shard.frames[message.track].pushFrame(message.frame);
+                frameTracks |= 1u << message.track;
+                signals++;
+                shard.frameEvents.store(shard.frameEvents.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                registry.RecordLatency(eThreadRole_Sender, ThreadRegistry::NowNs() - message.queuedNs);
+                break;
+            case eMessage_Add:
+                shard.sessions.push_back({std::move(message.handler), false});
+                break;
+            case eMessage_Remove:
+                for (auto it = shard.sessions.begin(); it != shard.sessions.end(); ++it) {
+                    if (it->handler.get() == message.target) {
+                        shard.sessions.erase(it);
+                        break;
+                    }
+                }
+                break;
+            case eMessage_Wake:
+                for (auto& session : shard.sessions) {
+                    if (session.handler.get() == message.target) {
+                        session.runnable = true;
+                    }
+                }
+                signals++;
+                registry.RecordLatency(eThreadRole_Sender, ThreadRegistry::NowNs() - message.queuedNs);
+                break;
+        }
+        message = Message();
+    }
+
+    if (signals > 1) {
+        shard.coalescedTasks.store(shard.coalescedTasks.load(std::memory_order_relaxed) + signals - 1,
+                                   std::memory_order_relaxed);
+    }
+    shard.sessionCount.store(shard.sessions.size(), std::memory_order_relaxed);
+    return frameTracks;
+}
+
+/**
+ * @details
+ *   - sender 역할로 등록하고 워커 번호에 해당하는 코어에 고정
+ *   - 수신함을 비운 뒤 새 프레임이 있었으면 그 트랙을 재생 중인 소유 세션을, 깨우기 요청이 있었으면 그 세션을 송신
+ *   - 세션의 보낼 수 있는 프레임을 모두 전송 (블로킹하지 않음)
+ *   - 잠들기 전에 스레드 CPU 시간을 기록 (자는 동안에는 늘지 않으므로 수락 제어가 언제 읽어도 정확)
+ *   - 수신함이 비어 있으면 잠듦 (잠들기 전 수신함을 다시 확인하여 알림을 놓치지 않음)
+ */
+void SenderPool::WorkerLoop(Shard& shard, size_t index) {
+    ThreadRegistry::GetInstance().Enter(eThreadRole_Sender, "rtsp-sender", (int)index);
+
+    while (running) {
+        const uint32_t frameTracks = DrainInbox(shard);
+        for (auto& session : shard.sessions) {
+            const int track = session.handler->GetTrack();
+            if ((frameTracks & (1u << track)) && session.handler->GetState() == MediaStreamState::eMediaStream_Play) {
+                session.runnable = true;
+            }
+            if (!session.runnable) {
+                continue;
+            }
+            session.runnable = false;
+            session.handler->HandleMediaStream(shard.frames[track]);
+            shard.executedTasks.store(shard.executedTasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        struct timespec cpuTime;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime) == 0) {
+            shard.cpuNs.store((int64_t)cpuTime.tv_sec * 1000000000 + cpuTime.tv_nsec, std::memory_order_relaxed);
+        }
+
+        std::unique_lock<std::mutex> lock(shard.sleepMutex);
+        shard.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        shard.sleepCondition.wait(lock, [this, &shard]() { return !running || !shard.inbox.Empty(); });
+        shard.sleeping.store(false, std::memory_order_relaxed);
+    }
+    ThreadRegistry::GetInstance().Leave();
+}
+
+/**
+ * @details 워커 목록만 잠그고 워커별 통계는 느슨하게 읽어 합산 (워커의 송신을 막지 않음)
+ */
+SenderPoolStats SenderPool::GetStats() {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    SenderPoolStats stats;
+    stats.workers = shards.size();
+    for (auto& shard : shards) {
+        const size_t sessions = shard->sessionCount.load(std::memory_order_relaxed);
+        stats.sessions += sessions;
+        stats.sessionsPerWorker.push_back(sessions);
+        stats.frameEvents += shard->frameEvents.load(std::memory_order_relaxed);
+        stats.executedTasks += shard->executedTasks.load(std::memory_order_relaxed);
+        stats.coalescedTasks += shard->coalescedTasks.load(std::memory_order_relaxed);
+        stats.cpuNs += shard->cpuNs.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file SessionTable.cpp
+ * @brief SessionTable 클래스의 구현부
+ * @details SessionTable 클래스의 멤버 함수를 구현한 소스 파일
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "SessionTable.h"
+#include "ClientSession.h"
+#include "ThreadRegistry.h"
+
+#include <chrono>
+#include <iostream>
+
+const int SessionTable::tick_ms;
+
+/**
+ * @details 정리 스레드 종료
+ */
+SessionTable::~SessionTable() {
+    Stop();
+}
+
+/**
+ * @details 정리 스레드를 하나만 시작
+ */
+bool SessionTable::Start() {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    if (running) {
+        return true;
+    }
+    running = true;
+    reaperThread = std::thread(&SessionTable::Run, this);
+    return true;
+}
+
+/**
+ * @details 대기 중인 정리 스레드를 깨워 종료를 기다림
+ */
+void SessionTable::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    stopCondition.notify_all();
+    if (reaperThread.joinable()) {
+        reaperThread.join();
+    }
+}
+
+/**
+ * @details 타임아웃 뒤의 슬롯에 배치
+ */
+void SessionTable::Watch(const std::shared_ptr<ClientSession>& session) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    Schedule(session, (int64_t)timeoutSec * 1000);
+}
+
+/**
+ * @details 세션 ID로 색인에 등록 (휠 배치는 Watch에서 이미 함)
+ */
+bool SessionTable::Add(const std::shared_ptr<ClientSession>& session) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    auto it = sessions.find(session->GetID());
+    if (it != sessions.end()) {
+        auto existing = it->second.lock();
+        if (existing == session) {
+            return true;
+        }
+        if (existing != nullptr) {
+            return false;
+        }
+    }
+    sessions[session->GetID()] = session;
+    return true;
+}
+
+/**
+ * @details 연결은 끊길 때까지 휠에서 계속 감시됨
+ */
+void SessionTable::Remove(uint64_t id) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    sessions.erase(id);
+}
+
+/**
+ * @details 해제된 세션이면 nullptr
+ */
+std::shared_ptr<ClientSession> SessionTable::Find(uint64_t id) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    auto it = sessions.find(id);
+    return it != sessions.end() ? it->second.lock() : nullptr;
+}
+
+/**
+ * @details 등록된 세션 수 반환
+ */
+size_t SessionTable::GetCount() {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    return sessions.size();
+}
+
+/**
+ * @details 이미 배치된 세션은 다음 검사 때 새 타임아웃이 적용됨
+ */
+void SessionTable::SetTimeout(int sec) {
+    timeoutSec = sec > 0 ? sec : default_timeout_sec;
+}
+
+/**
+ * @details 최소 한 틱 뒤, 최대 휠 한 바퀴 직전 슬롯에 배치
+ */
+void SessionTable::Schedule(const std::weak_ptr<ClientSession>& session, int64_t delayMs) {
+    int64_t ticks = (delayMs + tick_ms - 1) / tick_ms;
+    if (ticks < 1) ticks = 1;
+    if (ticks > wheel_slots - 1) ticks = wheel_slots - 1;
+    wheel[(currentTick + ticks) % wheel_slots].push_back(session);
+}
+
+/**
+ * @details
+ *   - control 역할로 등록하고, 틱 시각보다 늦게 깨어난 시간을 스케줄링 지연으로 기록
+ *   - 틱마다 현재 슬롯의 연결만 검사 (연결 수와 관계없이 틱당 비용은 해당 슬롯 크기)
+ *   - 해제된 연결은 버림
+ *   - 마지막 활동 후 타임아웃이 지났으면 연결을 끊고, 아니면 남은 시간 뒤 슬롯에 다시 배치
+ *   - 연결을 끊은 세션도 다시 배치하여 이벤트 루프가 정리하지 못했으면 다음에 재시도
+ */
+void SessionTable::Run() {
+    ThreadRegistry::GetInstance().Enter(eThreadRole_Control, "rtsp-reaper");
+    std::unique_lock<std::mutex> lock(tableMutex);
+    while (running) {
+        const int64_t tickNs = ThreadRegistry::NowNs() + (int64_t)tick_ms * 1000000;
+        if (stopCondition.wait_for(lock, std::chrono::milliseconds(tick_ms)) == std::cv_status::timeout) {
+            ThreadRegistry::GetInstance().RecordLatency(eThreadRole_Control, ThreadRegistry::NowNs() - tickNs);
+        }
+        if (!running) {
+            break;
+        }
+
+        currentTick++;
+        std::vector<std::weak_ptr<ClientSession>> slot;
+        slot.swap(wheel[currentTick % wheel_slots]);
+
+        const int64_t timeoutMs = (int64_t)timeoutSec * 1000;
+        std::vector<std::shared_ptr<ClientSession>> expired;
+        for (auto& entry : slot) {
+            auto session = entry.lock();
+            if (session == nullptr) {
+                continue;
+            }
+
+            const int64_t idleMs = session->GetIdleMs();
+            if (idleMs >= timeoutMs) {
+                expired.push_back(session);
+                Schedule(entry, timeoutMs);
+            } else {
+                Schedule(entry, timeoutMs - idleMs);
+            }
+        }
+
+        lock.unlock();
+        for (auto& session : expired) {
+            std::cout << "Connection of session " << std::hex << session->GetID() << std::dec << " timed out." << std::endl;
+            session->Expire();
+            expiredCount++;
+        }
+        expired.clear();
+        lock.lock();
+    }
+    lock.unlock();
+    ThreadRegistry::GetInstance().Leave();
+}
@@ -11,17 +11,23 @@
 #include "Global.h"
 
 #include <string>
+#include <cerrno>
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <netinet/tcp.h>
 
 /**
- * @details TCP 포트를 설정하고 TCP 소켓을 생성
+ * @details TCP 포트를 설정 (리스닝 소켓은 서버 시작 시 CreateTCPSocket으로 생성)
  */
 TCPHandler::TCPHandler(): tcpPort(g_serverRtpPort) {
-    CreateTCPSocket();
+    memset(&tcpAddr, 0, sizeof(tcpAddr));
+    tcpAddr.sin_family = AF_INET;
+    tcpAddr.sin_addr.s_addr = INADDR_ANY;
+    tcpAddr.sin_port = htons(tcpPort);
 }
 
 /**
@@ -31,95 +37,113 @@ TCPHandler::~TCPHandler() {}
 
 /**
  * @details 
- *   - TCP 소켓 생성
- *   - SO_REUSEADDR 옵션 설정
+ *   - TCP 소켓 생성 (논블로킹)
+ *   - SO_REUSEADDR, SO_REUSEPORT 옵션 설정 (같은 포트에 리스닝 소켓 여러 개를 바인딩하여 커널이 연결을 분산)
+ *   - TCP_DEFER_ACCEPT 설정 (첫 요청 데이터가 도착한 연결만 accept 대상으로 깨움)
  *   - 주소 바인딩
- *   - 리스닝 상태로 전환
- * @throw std::runtime_error 소켓 생성, 바인딩 또는 리스닝 실패 시
+ *   - 주어진 backlog로 리스닝 상태로 전환
  */
-void TCPHandler::CreateTCPSocket() {
-    tcpSocket = socket(AF_INET, SOCK_STREAM, 0);
-    int option = 1;          // SO_REUSEADDR 의 옵션 값을 TRUE 로
-    setsockopt( tcpSocket, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option) );
+int TCPHandler::CreateTCPSocket(int backlog) {
+    int tcpSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (tcpSocket == -1) {
         std::cerr << "Error: fail to create TCP socket" << std::endl;
-        exit(1);
+        return -1;
     }
 
-    memset(&tcpAddr, 0, sizeof(tcpAddr));
-    tcpAddr.sin_family = AF_INET;
-    tcpAddr.sin_addr.s_addr = INADDR_ANY;
-    tcpAddr.sin_port = htons(tcpPort);
+    int option = 1;          // SO_REUSEADDR, SO_REUSEPORT 의 옵션 값을 TRUE 로
+    setsockopt(tcpSocket, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option));
+    if (setsockopt(tcpSocket, SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option)) == -1 && !tcpSockets.empty()) {
+        std::cerr << "Error: SO_REUSEPORT is not supported" << std::endl;
+        close(tcpSocket);
+        return -1;
+    }
+    int deferSec = defer_accept_sec;
+    setsockopt(tcpSocket, IPPROTO_TCP, TCP_DEFER_ACCEPT, &deferSec, sizeof(deferSec));
 
     if (bind(tcpSocket, (struct sockaddr*)&tcpAddr, sizeof(tcpAddr)) == -1) {
         std::cerr << "Error: fail to bind TCP socket" << std::endl;
-        exit(1);
+        close(tcpSocket);
+        return -1;
     }
 
-    if (listen(tcpSocket, 10) == -1) {
+    if (listen(tcpSocket, backlog > 0 ? backlog : SOMAXCONN) == -1) {
         std::cerr << "Error: fail to listen TCP socket" << std::endl;
-        exit(1);
+        close(tcpSocket);
+        return -1;
     }
+
+    tcpSockets.push_back(tcpSocket);
+    return tcpSocket;
 }
 
 /**
  * @details 클라이언트의 연결 요청을 수락하고 IP 주소를 획득
+ *          accept4로 클라이언트 소켓을 바로 논블로킹으로 생성하며,
+ *          대기 중인 연결이 없으면(EAGAIN) 에러 출력 없이 -1 반환
  */
-int TCPHandler::AcceptClientConnection(std::string &_clientIp) {
-    socklen_t clientAddrLen = sizeof(tcpAddr);
-    int clientSocket = accept(tcpSocket, (sockaddr*)&tcpAddr, &clientAddrLen);
+int TCPHandler::AcceptClientConnection(int listenSocket, std::string &_clientIp) {
+    sockaddr_in clientAddr;
+    socklen_t clientAddrLen = sizeof(clientAddr);
+    int clientSocket = accept4(listenSocket, (sockaddr*)&clientAddr, &clientAddrLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
 
     if (clientSocket == -1) {
-        std::cerr << "Error: fail to connect client" << std::endl;
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            std::cerr << "Error: fail to connect client" << std::endl;
+        }
         return -1;
     }
 
     char clientIP[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &tcpAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
+    inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
     
     _clientIp = clientIP;
     return clientSocket;
 }
 
 /**
- * @details TCP 소켓을 닫고 연결을 종료
+ * @details 모든 리스닝 소켓을 닫고 연결 수락을 종료
  */
 void TCPHandler::CloseClientConnection() {
-    close(tcpSocket);
-}
-
-/**
- * @details 클라이언트로부터 RTSP 요청 메시지를 수신
- */
-std::string TCPHandler::ReceiveRTSPRequest(int clientSocket) {
-    char buffer[1024] = {0,};
-    memset(buffer, 0, sizeof(buffer));
-
-    int receivedBytes = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-
-    if (receivedBytes <= 0) {
-        std::cerr << "Error: fail to recv RTSP request" << std::endl;
-        return nullptr;
+    for (int tcpSocket : tcpSockets) {
+        close(tcpSocket);
     }
-
-    std::cout << "rtsp 요청:\n" << buffer << std::endl;
-    return {buffer};
+    tcpSockets.clear();
 }
 
 /**
- * @details 클라이언트에게 RTSP 응답 메시지를 전송
+ * @details 논블로킹 소켓에서 EAGAIN이 나거나 maxBytes만큼 읽을 때까지 버퍼 뒤에 덧붙임
+ *          계속 보내는 클라이언트가 이벤트 루프 스레드를 붙잡지 않도록 한 번에 읽는 양을 제한
  */
-void TCPHandler::SendRTSPResponse(int clientSocket, std::string& response) {
-    int sentBytes = send(clientSocket, response.c_str(), response.size(), 0);
-    if (sentBytes == -1) {
-        std::cerr << "Error: fail to send RTSP response" << std::endl;
+bool TCPHandler::ReceiveRTSPRequest(int clientSocket, std::string& buffer, size_t maxBytes) {
+    char chunk[4096];
+    size_t total = 0;
+
+    while (total < maxBytes) {
+        ssize_t receivedBytes = recv(clientSocket, chunk, std::min(sizeof(chunk), maxBytes - total), 0);
+        if (receivedBytes > 0) {
+            buffer.append(chunk, receivedBytes);
+            total += receivedBytes;
+            continue;
+        }
+        if (receivedBytes == 0) {
+            return false;   // 클라이언트가 연결을 닫음
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;
+        }
+        std::cerr << "Error: fail to recv RTSP request" << std::endl;
+        return false;
     }
+    return true;
 }
 
 /**
- * @details TCP 소켓을 반환
+ * @details 리스닝 소켓 목록을 반환
  */
-int& TCPHandler::GetTCPSocket() { return tcpSocket; }
+const std::vector<int>& TCPHandler::GetTCPSockets() { return tcpSockets; }
 
 /**
  * @details TCP 주소 구조체를 반환
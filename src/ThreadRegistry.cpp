@@ -0,0 +1,513 @@
+/**
+ * @file ThreadRegistry.cpp
+ * @brief ThreadRegistry 클래스의 구현부
+ * @details ThreadRegistry 클래스의 멤버 함수를 구현한 소스 파일
+ *
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "ThreadRegistry.h"
+
+#include <ctime>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace {
+thread_local ThreadRole currentRole = eThreadRole_Count; ///< 현재 스레드의 등록 역할 (eThreadRole_Count: 미등록)
+
+/**
+ * @brief 현재 스레드 ID를 반환하는 함수
+ */
+pid_t CurrentTid() {
+    return (pid_t)syscall(SYS_gettid);
+}
+
+/**
+ * @brief 정책 이름을 반환하는 함수
+ */
+const char* PolicyName(int policy) {
+    switch (policy) {
+        case SCHED_FIFO: return "fifo";
+        case SCHED_RR: return "rr";
+        default: return "other";
+    }
+}
+
+/**
+ * @brief CPU 마스크를 "0,2,3" 형식 문자열로 바꾸는 함수
+ */
+std::string FormatCPUs(uint64_t mask) {
+    if (mask == 0) {
+        return "*";
+    }
+    std::string result;
+    for (int cpu = 0; cpu < 64; cpu++) {
+        if (mask & (1ULL << cpu)) {
+            if (!result.empty()) result += ",";
+            result += std::to_string(cpu);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief "0,2" 또는 "1-3" 형식의 CPU 목록을 마스크로 바꾸는 함수
+ * @return bool 문법이 올바른지 여부
+ */
+bool ParseCPUs(const std::string& text, uint64_t& mask) {
+    mask = 0;
+    if (text.empty() || text == "*") {
+        return true;
+    }
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int first = -1, last = -1;
+        char* end = nullptr;
+        first = (int)strtol(item.c_str(), &end, 10);
+        if (end == item.c_str()) return false;
+        last = first;
+        if (*end == '-') {
+            const char* rangeStart = end + 1;
+            last = (int)strtol(rangeStart, &end, 10);
+            if (end == rangeStart) return false;
+        }
+        if (*end != '\0' || first < 0 || last < first || last >= 64) return false;
+        for (int cpu = first; cpu <= last; cpu++) {
+            mask |= 1ULL << cpu;
+        }
+    }
+    return true;
+}
+}
+
+/**
+ * @details
+ *   - 고정하지 않은 역할이 돌아갈 CPU 집합으로 프로세스의 CPU 집합 저장 (taskset 등으로 제한된 경우 유지)
+ *   - 환경 변수 RTSP_THREAD_POLICY가 있으면 적용
+ */
+ThreadRegistry::ThreadRegistry() {
+    CPU_ZERO(&defaultCPUs);
+    if (sched_getaffinity(getpid(), sizeof(defaultCPUs), &defaultCPUs) != 0) {
+        for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency() && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, &defaultCPUs);
+        }
+    }
+
+    const char* spec = getenv("RTSP_THREAD_POLICY");
+    if (spec != nullptr) {
+        Configure(spec);
+    }
+}
+
+/**
+ * @details 측정 스레드 종료
+ */
+ThreadRegistry::~ThreadRegistry() {
+    StopProbes();
+}
+
+/**
+ * @details 로그/설정 문자열에 쓰는 역할 이름
+ */
+const char* ThreadRegistry::GetRoleName(ThreadRole role) {
+    switch (role) {
+        case eThreadRole_Capture: return "capture";
+        case eThreadRole_Encode: return "encode";
+        case eThreadRole_Sender: return "sender";
+        case eThreadRole_Control: return "control";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @details 정책을 바꾸고 같은 역할로 등록된 스레드에 다시 적용, 이미 끝난 스레드는 목록에서 제거
+ */
+bool ThreadRegistry::SetPolicy(ThreadRole role, const ThreadPolicy& policy) {
+    if (role < 0 || role >= eThreadRole_Count) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    roles[role].policy = policy;
+    roles[role].warned = false;
+
+    bool applied = true;
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->role != role) {
+            ++it;
+            continue;
+        }
+        int error = Apply(it->tid, role, policy, it->cpuSlot);
+        if (error == ESRCH) {
+            it = entries.erase(it);
+            continue;
+        }
+        applied = applied && error == 0;
+        ++it;
+    }
+    return applied;
+}
+
+/**
+ * @details 역할의 현재 정책 반환
+ */
+ThreadPolicy ThreadRegistry::GetPolicy(ThreadRole role) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return (role >= 0 && role < eThreadRole_Count) ? roles[role].policy : ThreadPolicy();
+}
+
+/**
+ * @details
+ *   - ';'로 나눈 항목마다 "역할=CPU목록[:정책[:우선순위]]" 해석
+ *   - 실시간 정책에 우선순위가 없으면 최소 우선순위 사용
+ *   - 잘못된 항목은 경고를 출력하고 건너뜀
+ */
+bool ThreadRegistry::Configure(const std::string& spec) {
+    bool valid = true;
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ';')) {
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        if (item.empty()) continue;
+
+        const size_t equals = item.find('=');
+        ThreadRole role = eThreadRole_Count;
+        for (int i = 0; i < eThreadRole_Count; i++) {
+            if (item.compare(0, equals, GetRoleName((ThreadRole)i)) == 0) {
+                role = (ThreadRole)i;
+            }
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream fieldStream(equals == std::string::npos ? "" : item.substr(equals + 1));
+        std::string field;
+        while (std::getline(fieldStream, field, ':')) {
+            fields.push_back(field);
+        }
+
+        ThreadPolicy policy;
+        bool ok = role != eThreadRole_Count && !fields.empty() && fields.size() <= 3 &&
+                  ParseCPUs(fields[0], policy.cpuMask);
+        if (ok && fields.size() >= 2) {
+            if (fields[1] == "fifo") policy.schedPolicy = SCHED_FIFO;
+            else if (fields[1] == "rr") policy.schedPolicy = SCHED_RR;
+            else ok = fields[1] == "other";
+        }
+        if (ok && policy.schedPolicy != SCHED_OTHER) {
+            policy.priority = sched_get_priority_min(policy.schedPolicy);
+            if (fields.size() == 3) {
+                policy.priority = atoi(fields[2].c_str());
+                ok = policy.priority >= sched_get_priority_min(policy.schedPolicy) &&
+                     policy.priority <= sched_get_priority_max(policy.schedPolicy);
+            }
+        }
+
+        if (!ok) {
+            std::cerr << "Warning: invalid thread policy \"" << item << "\"" << std::endl;
+            valid = false;
+            continue;
+        }
+        SetPolicy(role, policy);
+    }
+    return valid;
+}
+
+/**
+ * @details 마스크의 비트 수
+ */
+size_t ThreadRegistry::GetCPUCount(ThreadRole role) {
+    return (size_t)__builtin_popcountll(GetPolicy(role).cpuMask);
+}
+
+/**
+ * @details
+ *   - 스레드 이름을 설정하고 역할의 정책을 적용
+ *   - 다른 역할로 등록되어 있었으면 역할만 바꿈
+ */
+void ThreadRegistry::Enter(ThreadRole role, const char* name, int cpuSlot) {
+    if (currentRole == role || role < 0 || role >= eThreadRole_Count) {
+        return;
+    }
+
+    char shortName[16] = {0};
+    strncpy(shortName, name, sizeof(shortName) - 1);
+    pthread_setname_np(pthread_self(), shortName);
+
+    const pid_t tid = CurrentTid();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = std::find_if(entries.begin(), entries.end(), [tid](const Entry& entry) { return entry.tid == tid; });
+    if (it != entries.end()) {
+        it->role = role;
+        it->cpuSlot = cpuSlot;
+    } else {
+        entries.push_back({tid, role, cpuSlot});
+    }
+    currentRole = role;
+    Apply(tid, role, roles[role].policy, cpuSlot);
+}
+
+/**
+ * @details 목록에서 제거 (정책은 스레드와 함께 사라지므로 되돌리지 않음)
+ */
+void ThreadRegistry::Leave() {
+    if (currentRole == eThreadRole_Count) {
+        return;
+    }
+    const pid_t tid = CurrentTid();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [tid](const Entry& entry) { return entry.tid == tid; }),
+                  entries.end());
+    currentRole = eThreadRole_Count;
+}
+
+/**
+ * @details 실행 전에 없던 스레드 ID를 역할로 등록하고 정책 적용
+ *          (pthread는 만든 스레드의 CPU 집합/정책을 물려주지만, 역할 정책을 명시적으로 적용하고 이후 변경도 반영되도록 등록)
+ */
+size_t ThreadRegistry::Adopt(ThreadRole role, const std::function<void()>& create) {
+    std::vector<pid_t> before = ListThreads();
+    create();
+    std::vector<pid_t> after = ListThreads();
+    if (role < 0 || role >= eThreadRole_Count) {
+        return 0;
+    }
+
+    size_t adopted = 0;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (pid_t tid : after) {
+        if (std::find(before.begin(), before.end(), tid) != before.end()) continue;
+        entries.push_back({tid, role, -1});
+        Apply(tid, role, roles[role].policy, -1);
+        adopted++;
+    }
+    return adopted;
+}
+
+/**
+ * @details
+ *   - 마이크로초 단위로 합계/최대값 갱신
+ *   - 구간 i에는 [2^(i-1), 2^i) 마이크로초 지연이 들어감 (구간 0: 1마이크로초 미만)
+ */
+void ThreadRegistry::RecordLatency(ThreadRole role, int64_t latencyNs) {
+    if (role < 0 || role >= eThreadRole_Count) {
+        return;
+    }
+    const uint64_t us = latencyNs > 0 ? (uint64_t)latencyNs / 1000 : 0;
+    int bucket = us == 0 ? 0 : 64 - __builtin_clzll(us);
+    if (bucket >= latency_buckets) bucket = latency_buckets - 1;
+
+    RoleState& state = roles[role];
+    state.samples++;
+    state.totalUs += us;
+    state.buckets[bucket]++;
+    uint64_t max = state.maxUs.load(std::memory_order_relaxed);
+    while (us > max && !state.maxUs.compare_exchange_weak(max, us)) {}
+}
+
+/**
+ * @details 99번째 백분위는 히스토그램에서 누적 99%에 도달한 구간의 상한으로 계산
+ */
+ThreadLatencyStats ThreadRegistry::GetLatencyStats(ThreadRole role) {
+    ThreadLatencyStats stats;
+    if (role < 0 || role >= eThreadRole_Count) {
+        return stats;
+    }
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        stats.threads = std::count_if(entries.begin(), entries.end(),
+                                      [role](const Entry& entry) { return entry.role == role; });
+    }
+
+    RoleState& state = roles[role];
+    stats.samples = state.samples;
+    stats.maxUs = state.maxUs;
+    if (stats.samples == 0) {
+        return stats;
+    }
+    stats.meanUs = state.totalUs / stats.samples;
+
+    const uint64_t target = (stats.samples * 99 + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < latency_buckets; i++) {
+        seen += state.buckets[i];
+        if (seen >= target) {
+            stats.p99Us = std::min<uint64_t>(1ULL << i, stats.maxUs);
+            break;
+        }
+    }
+    return stats;
+}
+
+/**
+ * @details 모든 역할의 측정값을 0으로
+ */
+void ThreadRegistry::ResetLatencyStats() {
+    for (auto& state : roles) {
+        state.samples = 0;
+        state.totalUs = 0;
+        state.maxUs = 0;
+        for (auto& bucket : state.buckets) {
+            bucket = 0;
+        }
+    }
+}
+
+/**
+ * @details 스레드나 측정값이 있는 역할만 한 줄씩 출력
+ */
+void ThreadRegistry::PrintReport() {
+    for (int i = 0; i < eThreadRole_Count; i++) {
+        const ThreadRole role = (ThreadRole)i;
+        const ThreadPolicy policy = GetPolicy(role);
+        const ThreadLatencyStats stats = GetLatencyStats(role);
+        if (stats.threads == 0 && stats.samples == 0) continue;
+
+        std::cout << "thread role " << GetRoleName(role)
+                  << ": cpus=" << FormatCPUs(policy.cpuMask)
+                  << " policy=" << PolicyName(policy.schedPolicy);
+        if (policy.schedPolicy != SCHED_OTHER) {
+            std::cout << ":" << policy.priority;
+        }
+        std::cout << " threads=" << stats.threads
+                  << " latency samples=" << stats.samples
+                  << " mean=" << stats.meanUs << "us"
+                  << " p99<=" << stats.p99Us << "us"
+                  << " max=" << stats.maxUs << "us" << std::endl;
+    }
+}
+
+/**
+ * @details 역할마다 측정 스레드 하나 (1초보다 긴 주기는 종료가 늦어지므로 1초로 제한)
+ */
+void ThreadRegistry::StartProbes(int intervalUs) {
+    if (intervalUs <= 0 || probing.exchange(true)) {
+        return;
+    }
+    intervalUs = std::min(intervalUs, 1000000);
+    for (int i = 0; i < eThreadRole_Count; i++) {
+        probes.emplace_back(&ThreadRegistry::ProbeLoop, this, (ThreadRole)i, intervalUs);
+    }
+}
+
+/**
+ * @details 측정 스레드는 다음 주기에 깨어나 종료하므로 최대 한 주기를 기다림
+ */
+void ThreadRegistry::StopProbes() {
+    if (!probing.exchange(false)) {
+        return;
+    }
+    for (auto& probe : probes) {
+        if (probe.joinable()) {
+            probe.join();
+        }
+    }
+    probes.clear();
+}
+
+/**
+ * @details CLOCK_MONOTONIC 기준 나노초
+ */
+int64_t ThreadRegistry::NowNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @details
+ *   - 역할의 CPU 집합(고정하지 않았으면 프로세스의 CPU 집합)에서 cpuSlot번째 CPU 하나를 고르거나 집합 전체를 사용
+ *   - 실패 시 errno, 실패 경고는 역할마다 한 번만 출력
+ */
+int ThreadRegistry::Apply(pid_t tid, ThreadRole role, const ThreadPolicy& policy, int cpuSlot) {
+    cpu_set_t cpus;
+    if (policy.cpuMask != 0) {
+        CPU_ZERO(&cpus);
+        for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++) {
+            if (policy.cpuMask & (1ULL << cpu)) CPU_SET(cpu, &cpus);
+        }
+    } else {
+        cpus = defaultCPUs;
+    }
+
+    const int cpuCount = CPU_COUNT(&cpus);
+    if (cpuSlot >= 0 && cpuCount > 0) {
+        int target = cpuSlot % cpuCount;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &cpus)) continue;
+            if (target-- == 0) {
+                CPU_ZERO(&cpus);
+                CPU_SET(cpu, &cpus);
+                break;
+            }
+        }
+    }
+
+    int error = 0;
+    if (sched_setaffinity(tid, sizeof(cpus), &cpus) != 0) {
+        error = errno;
+    }
+    if (error != ESRCH) {
+        sched_param param{};
+        param.sched_priority = policy.schedPolicy == SCHED_OTHER ? 0 : policy.priority;
+        if (sched_setscheduler(tid, policy.schedPolicy, &param) != 0 && error == 0) {
+            error = errno;
+        }
+    }
+
+    if (error != 0 && error != ESRCH && !roles[role].warned.exchange(true)) {
+        std::cerr << "Warning: failed to apply " << GetRoleName(role) << " thread policy: "
+                  << strerror(error) << std::endl;
+    }
+    return error;
+}
+
+/**
+ * @details /proc/self/task 디렉터리의 항목이 스레드 ID
+ */
+std::vector<pid_t> ThreadRegistry::ListThreads() {
+    std::vector<pid_t> threads;
+    DIR* dir = opendir("/proc/self/task");
+    if (dir == nullptr) {
+        return threads;
+    }
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        threads.push_back((pid_t)atoi(entry->d_name));
+    }
+    closedir(dir);
+    return threads;
+}
+
+/**
+ * @details
+ *   - 역할로 등록하여 같은 CPU/우선순위에서 실행
+ *   - 절대 시각으로 잠들고 예정 시각보다 늦게 깨어난 시간을 기록
+ *   - 한 주기 이상 밀렸으면 밀린 주기를 건너뜀
+ */
+void ThreadRegistry::ProbeLoop(ThreadRole role, int intervalUs) {
+    Enter(role, (std::string("probe-") + GetRoleName(role)).c_str());
+
+    int64_t next = NowNs();
+    while (probing) {
+        next += (int64_t)intervalUs * 1000;
+        timespec deadline = {(time_t)(next / 1000000000LL), (long)(next % 1000000000LL)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+
+        const int64_t now = NowNs();
+        RecordLatency(role, now - next);
+        if (now - next > (int64_t)intervalUs * 1000) {
+            next = now;
+        }
+    }
+    Leave();
+}
@@ -8,6 +8,7 @@
  */
 
 #include "UDPHandler.h"
+#include "UDPServer.h"
 #include "ClientSession.h"
 #include <string>
 #include <cstring>
@@ -17,39 +18,24 @@
 #include <sys/socket.h>
 
 /**
- * @details 소켓 디스크립터를 초기값 -1로 초기화하여 유효하지 않은 소켓임을 표시
+ * @details rtcp-mux 여부는 InitTransport에서 세션 정보로 결정
  */
 UDPHandler::UDPHandler(std::shared_ptr<ClientSession> client)
-    : client(client), rtpSocket(-1), rtcpSocket(-1) {}
+    : client(client), rtcpMux(false) {}
 
 /**
- * @details 열려있는 소켓이 있다면(디스크립터가 -1이 아닌 경우) 소켓을 닫고 리소스 해제
- */
-UDPHandler::~UDPHandler() {
-    if (rtpSocket != -1) close(rtpSocket);
-    if (rtcpSocket != -1) close(rtcpSocket);
-}
-
-/**
- * @details UDP 소켓 생성 과정:
- *          1. RTP와 RTCP 소켓 각각 생성
- *          2. 주소 구조체 초기화 및 설정
- *             - AF_INET: IPv4 프로토콜
- *             - SOCK_DGRAM: UDP 소켓 타입
+ * @details 목적지 설정 과정:
+ *          1. UDPServer의 공유 소켓이 열려 있는지 확인
+ *          2. 주소 구조체 초기화 및 설정 (AF_INET: IPv4 프로토콜)
  *          3. 클라이언트의 IP 주소와 포트 번호로 주소 구조체 설정
+ *          4. rtcp-mux 세션은 RTCP 주소를 RTP 주소와 같게 설정
  */
-bool UDPHandler::CreateUDPSocket() {
-    rtpSocket = socket(AF_INET, SOCK_DGRAM, 0);
-    if (rtpSocket == -1) {
-        std::cerr << "rtp 소켓 생성 실패" << std::endl;
-        return false;
-    }
-
-    rtcpSocket = socket(AF_INET, SOCK_DGRAM, 0);
-    if (rtcpSocket == -1) {
-        std::cerr << "rtcp 소켓 생성 실패" << std::endl;
+bool UDPHandler::InitTransport() {
+    if (UDPServer::GetInstance().GetRTPSocket() == -1) {
+        std::cerr << "공유 rtp/rtcp 소켓이 열려있지 않음" << std::endl;
         return false;
     }
+    rtcpMux = client->IsRTCPMux();
 
     memset(&rtpAddr, 0, sizeof(rtpAddr));
     rtpAddr.sin_family = AF_INET;
@@ -58,14 +44,21 @@ bool UDPHandler::CreateUDPSocket() {
 
     memset(&rtcpAddr, 0, sizeof(rtcpAddr));
     rtcpAddr.sin_family = AF_INET;
-    rtcpAddr.sin_port = htons(client->GetRTCPPort());
+    rtcpAddr.sin_port = htons(rtcpMux ? client->GetRTPPort() : client->GetRTCPPort());
     inet_pton(AF_INET, client->GetIP().c_str(), &rtcpAddr.sin_addr);
 
     return true;
 }
 
-int& UDPHandler::GetRTPSocket() { return rtpSocket; }
-int& UDPHandler::GetRTCPSocket() { return rtcpSocket; }
+int UDPHandler::GetServerRTPPort() { return UDPServer::GetInstance().GetRTPPort(); }
+int UDPHandler::GetServerRTCPPort() {
+    return rtcpMux ? UDPServer::GetInstance().GetRTPPort() : UDPServer::GetInstance().GetRTCPPort();
+}
+
+int UDPHandler::GetRTPSocket() { return UDPServer::GetInstance().GetRTPSocket(); }
+int UDPHandler::GetRTCPSocket() {
+    return rtcpMux ? UDPServer::GetInstance().GetRTPSocket() : UDPServer::GetInstance().GetRTCPSocket();
+}
 
 sockaddr_in& UDPHandler::GetRTPAddr() { return rtpAddr; }
 sockaddr_in& UDPHandler::GetRTCPAddr() { return rtcpAddr; }
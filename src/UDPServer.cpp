@@ -0,0 +1,269 @@
+/**
+ * @file UDPServer.cpp
+ * @brief UDPServer 클래스의 구현부
+ * @details UDPServer 클래스의 멤버 함수를 구현한 소스 파일
+ * 
+ * Copyright (c) 2024 rtspMediaStream
+ * This project is licensed under the MIT License - see the LICENSE file for details
+ */
+
+#include "UDPServer.h"
+#include "UDPHandler.h"
+#include "RTCPPacket.hpp"
+#include "MediaStreamHandler.h"
+#include "DataCapture.h"
+#include "ThreadRegistry.h"
+
+#include <thread>
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+
+/**
+ * @brief UDP 소켓을 생성하여 지정한 서버 포트에 바인딩하는 함수
+ * @param port 바인딩할 포트 번호
+ * @return int 소켓 디스크립터 (-1: 실패)
+ */
+static int CreateBoundSocket(int port) {
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd == -1) {
+        return -1;
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(sockfd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+        close(sockfd);
+        return -1;
+    }
+    return sockfd;
+}
+
+/**
+ * @details 수신 스레드를 종료하고 열려있는 공유 소켓을 닫음
+ */
+UDPServer::~UDPServer() {
+    Close();
+}
+
+/**
+ * @details
+ *   - RTP/RTCP 포트에 각각 소켓을 바인딩
+ *   - 두 소켓과 종료 요청용 eventfd를 감시하는 RTCP 수신 스레드를 하나만 시작
+ *   - eventfd를 만들지 못하면 소켓을 닫고 실패 (종료할 때 수신 스레드를 깨울 수 없으므로)
+ */
+bool UDPServer::Open(int _rtpPort, int _rtcpPort) {
+    if (rtpSocket != -1) {
+        return true;
+    }
+
+    rtpSocket = CreateBoundSocket(_rtpPort);
+    rtcpSocket = CreateBoundSocket(_rtcpPort);
+    if (rtpSocket == -1 || rtcpSocket == -1) {
+        std::cerr << "Error: fail to bind RTP/RTCP port " << _rtpPort << "-" << _rtcpPort << std::endl;
+        if (rtpSocket != -1) close(rtpSocket);
+        if (rtcpSocket != -1) close(rtcpSocket);
+        rtpSocket = rtcpSocket = -1;
+        return false;
+    }
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd == -1) {
+        // 종료 요청을 보낼 수 없으면 Close가 수신 스레드를 기다리다 멈추므로 스레드를 시작하지 않음
+        std::cerr << "Error: fail to create RTCP receiver eventfd: " << strerror(errno) << std::endl;
+        close(rtpSocket);
+        close(rtcpSocket);
+        rtpSocket = rtcpSocket = -1;
+        return false;
+    }
+    rtpPort = _rtpPort;
+    rtcpPort = _rtcpPort;
+    receiveThread = std::thread(&UDPServer::ReceiveLoop, this);
+    return true;
+}
+
+/**
+ * @details eventfd로 poll을 깨워 수신 스레드 종료를 기다린 뒤 소켓을 닫음
+ */
+void UDPServer::Close() {
+    if (rtpSocket == -1) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(wakeupFd, &one, sizeof(one)) < 0) {
+        std::cerr << "Error: fail to wake up RTCP receiver" << std::endl;
+    }
+    if (receiveThread.joinable()) {
+        receiveThread.join();
+    }
+    close(wakeupFd);
+    close(rtpSocket);
+    close(rtcpSocket);
+    wakeupFd = rtpSocket = rtcpSocket = -1;
+    rtpPort = rtcpPort = -1;
+}
+
+/**
+ * @details RTP 소켓과 RTCP 소켓(Sender Report 전송) 모두에 IP_MULTICAST_TTL 설정
+ */
+bool UDPServer::SetMulticastTTL(int ttl) {
+    if (rtpSocket == -1) {
+        return false;
+    }
+    unsigned char value = (unsigned char)ttl;
+    if (setsockopt(rtpSocket, IPPROTO_IP, IP_MULTICAST_TTL, &value, sizeof(value)) == -1 ||
+        setsockopt(rtcpSocket, IPPROTO_IP, IP_MULTICAST_TTL, &value, sizeof(value)) == -1) {
+        std::cerr << "Error: fail to set multicast TTL " << ttl << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @details
+ *   - 다른 핸들러가 같은 SSRC로 등록되어 있으면 겹치지 않을 때까지 핸들러의 SSRC를 새로 만듦
+ *   - 핸들러의 SSRC와 클라이언트 RTCP 주소(rtcp-mux 시 RTP 주소) 두 가지로 색인
+ */
+void UDPServer::Register(MediaStreamHandler* handler) {
+    const sockaddr_in& addr = handler->udpHandler->GetRTCPAddr();
+    const Address address{addr.sin_addr.s_addr, addr.sin_port};
+    std::lock_guard<std::mutex> lock(tableMutex);
+    for (auto it = ssrcTable.find(handler->GetSSRC()); it != ssrcTable.end() && it->second.handler != handler;
+         it = ssrcTable.find(handler->GetSSRC())) {
+        std::cerr << "SSRC collision " << handler->GetSSRC() << ", regenerate" << std::endl;
+        handler->RegenerateSSRC();
+    }
+    ssrcTable[handler->GetSSRC()] = {handler, address};
+    addressTable[address] = handler;
+    ResizeSendBuffer();
+}
+
+/**
+ * @details 두 테이블에서 해당 핸들러를 가리키는 항목을 모두 제거
+ */
+void UDPServer::Unregister(MediaStreamHandler* handler) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    auto ssrcIt = ssrcTable.find(handler->GetSSRC());
+    if (ssrcIt != ssrcTable.end() && ssrcIt->second.handler == handler) {
+        ssrcTable.erase(ssrcIt);
+    }
+    for (auto it = addressTable.begin(); it != addressTable.end();) {
+        it = (it->second == handler) ? addressTable.erase(it) : std::next(it);
+    }
+    ResizeSendBuffer();
+}
+
+/**
+ * @details
+ *   - 크기 = 비트레이트 / 8 * send_buffer_latency_ms * 등록된 스트림 수, 최소/최대 크기로 제한
+ *     (스트림은 트랙마다 하나이므로 비트레이트는 프레임이 들어오는 트랙들의 평균)
+ *   - 권한이 있으면 SO_SNDBUFFORCE로 net.core.wmem_max 제한을 넘어 설정, 없으면 SO_SNDBUF 사용
+ */
+void UDPServer::ResizeSendBuffer() {
+    if (rtpSocket == -1) {
+        return;
+    }
+    uint64_t bitrate = 0;
+    int tracks = 0;
+    for (int track = 0; track < DataCapture::max_tracks; track++) {
+        const uint64_t trackBitrate = DataCapture::getInstance(track).getBitrate();
+        if (trackBitrate > 0) {
+            bitrate += trackBitrate;
+            tracks++;
+        }
+    }
+    if (tracks > 0) {
+        bitrate /= tracks;
+    }
+    if (bitrate == 0) {
+        bitrate = default_stream_bitrate;
+    }
+    const uint64_t sessions = ssrcTable.empty() ? 1 : ssrcTable.size();
+    uint64_t size = bitrate / 8 * send_buffer_latency_ms / 1000 * sessions;
+    if (size < (uint64_t)min_send_buffer_size) size = min_send_buffer_size;
+    if (size > (uint64_t)max_send_buffer_size) size = max_send_buffer_size;
+
+    int bufferSize = (int)size;
+    if (setsockopt(rtpSocket, SOL_SOCKET, SO_SNDBUFFORCE, &bufferSize, sizeof(bufferSize)) == -1) {
+        setsockopt(rtpSocket, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    }
+}
+
+/**
+ * @details
+ *   - control 역할로 등록하여 설정된 CPU/우선순위에서 실행
+ *   - RTCP 포트로 들어온 패킷은 모두 RTCP로 처리
+ *   - RTP 포트로 들어온 패킷은 rtcp-mux RTCP만 처리 (RFC 5761 4절: 두 번째 바이트가 192~223)
+ */
+void UDPServer::ReceiveLoop() {
+    uint8_t buffer[1500];
+    pollfd fds[3] = {{rtpSocket, POLLIN, 0}, {rtcpSocket, POLLIN, 0}, {wakeupFd, POLLIN, 0}};
+    ThreadRegistry::GetInstance().Enter(eThreadRole_Control, "rtsp-rtcp");
+
+    while (true) {
+        if (poll(fds, 3, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[2].revents & POLLIN) {
+            break;
+        }
+        for (int i = 0; i < 2; i++) {
+            if (!(fds[i].revents & POLLIN)) {
+                continue;
+            }
+            sockaddr_in from;
+            socklen_t fromLen = sizeof(from);
+            ssize_t receivedBytes = recvfrom(fds[i].fd, buffer, sizeof(buffer), MSG_DONTWAIT, (struct sockaddr*)&from, &fromLen);
+            if (receivedBytes < RTCP_HEADER_SIZE) {
+                continue;
+            }
+            if (fds[i].fd == rtpSocket && (buffer[1] < 192 || buffer[1] > 223)) {
+                continue;
+            }
+            Dispatch(buffer, receivedBytes, from);
+        }
+    }
+    ThreadRegistry::GetInstance().Leave();
+}
+
+/**
+ * @details
+ *   - 패킷 안의 미디어 SSRC로 먼저 찾고, 없으면 송신 주소로 찾음
+ *   - SSRC로 찾았더라도 송신 주소가 SETUP에서 등록한 클라이언트 RTCP 주소가 아니면 버림
+ *     (다른 호스트가 SSRC만 알고 세션을 유지하거나 키프레임을 요청하지 못하도록)
+ *   - 테이블 잠금 안에서 shared_ptr로 핸들러 수명을 잡은 뒤 잠금을 풀고 전달
+ *     (소멸 중인 핸들러는 weak_from_this가 비어 있으므로 건너뜀, 키프레임 콜백이 잠금 밖에서 실행됨)
+ */
+void UDPServer::Dispatch(const uint8_t* data, int64_t dataLen, const sockaddr_in& from) {
+    const Address address{from.sin_addr.s_addr, from.sin_port};
+    std::shared_ptr<MediaStreamHandler> target;
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        MediaStreamHandler* handler = nullptr;
+
+        uint32_t ssrc = 0;
+        if (RTCPPacket::GetMediaSSRC(data, dataLen, ssrc)) {
+            auto it = ssrcTable.find(ssrc);
+            if (it != ssrcTable.end() && it->second.address == address) handler = it->second.handler;
+        }
+        if (!handler) {
+            auto it = addressTable.find(address);
+            if (it != addressTable.end()) handler = it->second;
+        }
+        if (handler) {
+            target = handler->weak_from_this().lock();
+        }
+    }
+    if (target) {
+        target->OnRTCPPacket(data, dataLen);
+    }
+}